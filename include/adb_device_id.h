@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+
+// ─── ADB Device Identity (Register 3) ──────────────────────────────────────
+// Address, handler ID and the enumeration rules around them, shared by the
+// keyboard and the mouse. A real device may sit at the same default
+// address (a trackball on the mouse's chain, a keyboard's pass-through
+// port), so the host resolves clashes the way the ADB spec lays out:
+//
+//   1. Talk R3 to the shared address. Each device answers with a RANDOM
+//      address in its address field, so two replies differ somewhere and
+//      the device that releases a bit the other holds low sees a collision
+//      and aborts (adb_protocol::send_data).
+//   2. Listen R3 with handler 0xFE and a new address: only the device that
+//      did NOT collide on the last Talk R3 moves.
+//   3. Repeat until the old address falls silent.
+//
+// Listen R3 handler field:
+//   0x00        — change address unconditionally
+//   0xFD        — change address if the activator is pressed (we have none:
+//                 never moves)
+//   0xFE        — change address unless the last Talk R3 collided
+//   0xFF        — self-test request (ignored)
+//   otherwise   — change handler ID, address untouched
+//
+// Header-only; the random address nibble is passed in by the caller.
+// Single writer: the ADB task.
+
+class AdbDeviceId {
+public:
+    /// What a Listen R3 did.
+    enum class ListenResult : uint8_t { NONE, MOVED, HELD, HANDLER };
+
+    void reset(uint8_t address, uint8_t handler) {
+        m_address  = address & 0x0F;
+        m_handler  = handler;
+        m_collided = false;
+    }
+
+    /// Talk R3 reply: exceptional event clear (bit 14 = 1), SRQ enabled
+    /// (bit 13), `random` in the address field, handler ID in the low byte.
+    /// Clears the collision flag; reply_collided() sets it again.
+    uint16_t talk_r3(uint8_t random) {
+        m_collided = false;
+        uint8_t byte0 = 0x60 | (random & 0x0F);
+        return ((uint16_t)byte0 << 8) | m_handler;
+    }
+
+    /// Our last Talk R3 reply was cut short by another device.
+    void reply_collided() { m_collided = true; }
+
+    ListenResult listen_r3(uint16_t data) {
+        uint8_t new_addr    = (data >> 8) & 0x0F;
+        uint8_t new_handler = data & 0xFF;
+
+        switch (new_handler) {
+            case 0x00:
+                m_address = new_addr;
+                return ListenResult::MOVED;
+            case 0xFE:
+                if (m_collided) return ListenResult::HELD;
+                m_address = new_addr;
+                return ListenResult::MOVED;
+            case 0xFD:
+            case 0xFF:
+                return ListenResult::NONE;
+            default:
+                m_handler = new_handler;
+                return ListenResult::HANDLER;
+        }
+    }
+
+    uint8_t address() const { return m_address; }
+    uint8_t handler() const { return m_handler; }
+
+private:
+    uint8_t m_address  = 0;
+    uint8_t m_handler  = 0;
+    bool    m_collided = false;   // last Talk R3 reply collided
+};
@@ -5,38 +5,62 @@
 // ─── ADB Keyboard Device Emulation (Address 2) ─────────────────────────────
 // Emulates a standard Apple ADB keyboard. Responds to Talk/Listen/Flush/Reset
 // commands from the Mac host. Key events arrive via FreeRTOS queue from BLE.
+// One keyboard per ADB bus (`bus` < ADB_BUS_COUNT); each is driven only by
+// its own bus's engine and drains only that bus's queue.
 
 namespace adb_keyboard {
 
-/// Initialize the keyboard device state.
-void init();
+/// Initialize one bus's keyboard state.
+void init(uint8_t bus);
 
 /// Handle a Talk command for the given register.
 /// @param reg Register number (0-3).
 /// @param data Output: 16-bit data to send to host.
 /// @return true if there is data to send, false if no response.
-bool handle_talk(uint8_t reg, uint16_t& data);
+bool handle_talk(uint8_t bus, uint8_t reg, uint16_t& data);
 
 /// Handle a Listen command — host is writing data to us.
 /// @param reg Register number (0-3).
 /// @param data 16-bit data received from host.
-void handle_listen(uint8_t reg, uint16_t data);
+void handle_listen(uint8_t bus, uint8_t reg, uint16_t data);
 
 /// Handle a Flush command — clear all pending key events.
-void handle_flush();
+void handle_flush(uint8_t bus);
 
 /// Handle a Reset command — reset to default state.
-void handle_reset();
+void handle_reset(uint8_t bus);
+
+/// The host went away (host_presence): drop every key event buffered or
+/// still queued, so none replays when it comes back. Bus engine only.
+void discard(uint8_t bus);
 
 /// Check if the keyboard has pending data (for SRQ).
-bool has_data();
+bool has_data(uint8_t bus);
+
+/// Key events waiting in the buffer for a Talk R0 reply. Read from Core 0
+/// without a lock, as a back-pressure hint (text_inject).
+uint32_t buffered(uint8_t bus);
 
 /// Get the current ADB address (may change during enumeration).
-uint8_t current_address();
+uint8_t current_address(uint8_t bus);
+
+/// The reply to the last Talk on `reg` was aborted by a bus collision.
+/// R0: its keys go back to the buffer for the next poll. R3: the next
+/// Listen R3 with handler 0xFE leaves our address alone.
+void reply_collided(uint8_t bus, uint8_t reg);
+
+/// Get millis() since boot when the first key event was delivered to the
+/// host (0 = none yet). Measures reset-to-first-key latency.
+uint32_t get_first_key_ms();
 
 /// Process incoming events from the BLE queue.
 /// Call periodically from the ADB task to transfer events from the
 /// FreeRTOS queue into the internal key event buffer.
-void process_queue();
+void process_queue(uint8_t bus);
+
+/// Record buffer→wire and end-to-end latency for the keys carried by the
+/// Talk R0 reply just sent. Call after send_data(); no-op otherwise.
+/// @param wire_us adb_platform::micros_now() when the reply finished.
+void trace_reply_sent(uint8_t bus, uint32_t wire_us);
 
 } // namespace adb_keyboard
@@ -4,41 +4,54 @@
 
 // ─── ADB Mouse Device Emulation (Address 3) ────────────────────────────────
 // Emulates a standard Apple ADB mouse (100 cpi, 1 button).
-// Mouse deltas accumulate between ADB polls and are clamped to 7-bit range.
+// Mouse deltas accumulate between ADB polls (saturating at
+// ADB_MOUSE_ACCUM_MAX) and are clamped to 7-bit range per reply.
+// One mouse per ADB bus (`bus` < ADB_BUS_COUNT), as for adb_keyboard.
 
 namespace adb_mouse {
 
-/// Initialize the mouse device state.
-void init();
+/// Initialize one bus's mouse state.
+void init(uint8_t bus);
 
 /// Handle a Talk command for the given register.
 /// @param reg Register number (0-3).
 /// @param data Output: 16-bit data to send to host.
 /// @return true if there is data to send, false if no response.
-bool handle_talk(uint8_t reg, uint16_t& data);
+bool handle_talk(uint8_t bus, uint8_t reg, uint16_t& data);
 
 /// Handle a Listen command — host is writing data to us.
 /// @param reg Register number (0-3).
 /// @param data 16-bit data received from host.
-void handle_listen(uint8_t reg, uint16_t data);
+void handle_listen(uint8_t bus, uint8_t reg, uint16_t data);
 
 /// Handle a Flush command — clear accumulated deltas.
-void handle_flush();
+void handle_flush(uint8_t bus);
 
 /// Handle a Reset command — reset to default state.
-void handle_reset();
+void handle_reset(uint8_t bus);
+
+/// The host went away (host_presence): drop the motion held and still
+/// queued, and report the button up. Bus engine only.
+void discard(uint8_t bus);
 
 /// Check if the mouse has pending data (movement or button change).
-bool has_data();
+bool has_data(uint8_t bus);
 
 /// Get the current ADB address (may change during enumeration).
-uint8_t current_address();
+uint8_t current_address(uint8_t bus);
+
+/// The reply to the last Talk on `reg` was aborted by a bus collision.
+/// R0: the reported motion and button change return to the accumulators.
+/// R3: the next Listen R3 with handler 0xFE leaves our address alone.
+void reply_collided(uint8_t bus, uint8_t reg);
 
 /// Process incoming events from the BLE queue.
 /// Accumulates deltas for the next Talk Register 0 response.
-void process_queue();
+void process_queue(uint8_t bus);
 
-/// Get total mouse events dequeued (diagnostic).
-uint32_t get_queue_events();
+/// Record buffer→wire and end-to-end latency for the oldest motion carried
+/// by the Talk R0 reply just sent. Call after send_data(); no-op otherwise.
+/// @param wire_us adb_platform::micros_now() when the reply finished.
+void trace_reply_sent(uint8_t bus, uint32_t wire_us);
 
 } // namespace adb_mouse
@@ -5,13 +5,22 @@
 // ─── ADB Platform HAL ──────────────────────────────────────────────────────
 // Direct GPIO register access and microsecond timing for ADB bit-banging
 // on ESP32-S3 (Heltec V3). All functions are IRAM_ATTR in the .cpp for
-// flash-cache safety during interrupt-disabled sections.
+// flash-cache safety during interrupt-disabled sections. With
+// ADB_DEDICATED_GPIO=1 the pin is driven and read through the S3's
+// dedicated-GPIO CPU instructions instead of the GPIO registers.
 
 namespace adb_platform {
 
 /// Initialize GPIO48 as open-collector output (open-drain mode).
 void init();
 
+/// Finish setup from the ADB task, on the core that will drive the bus.
+/// With ADB_DEDICATED_GPIO=1 this claims a dedicated-GPIO bundle for the
+/// pin, which only the calling core can then drive or read; until then
+/// drive_low()/release()/read_pin() do nothing useful. With ADB_SELF_TEST=1
+/// it also prints a pin-access benchmark for each backend ([IO] lines).
+void bind_core();
+
 /// Drive the ADB data line low (active pull-down).
 void drive_low();
 
@@ -30,12 +39,23 @@ uint32_t micros_now();
 void delay_us(uint32_t us);
 
 /// Wait for the ADB data line to reach a specific state.
+/// With ADB_GLITCH_FILTER=1 the new level must hold for ADB_GLITCH_US
+/// first (see glitch_filter.h); shorter excursions are counted and ignored.
 /// @param state true = wait for high, false = wait for low.
 /// @param timeout_us Maximum time to wait.
 /// @return Elapsed time in µs, or 0 if timed out.
 uint32_t wait_for_state(bool state, uint32_t timeout_us);
 
-/// Measure how long the line stays in a given state.
+/// wait_for_state() for the waits where interrupts are enabled (idle line,
+/// attention pulse). Any gap of ADB_STALL_MIN_US or more between two reads
+/// means something else ran on this core: the first such gap in each RTOS
+/// tick is counted as the tick interrupt (adb.c1.tick_irq), the rest as
+/// foreign interrupts (adb.c1.foreign_irq), and every gap's length goes to
+/// adb.c1.stall_us.
+uint32_t wait_for_state_watch(bool state, uint32_t timeout_us);
+
+/// Measure how long the line stays in a given state. With
+/// ADB_GLITCH_FILTER=1, excursions shorter than ADB_GLITCH_US don't end it.
 /// @param state true = measure high duration, false = measure low duration.
 /// @param timeout_us Maximum time to measure.
 /// @return Duration in µs, or 0 if line was not in the expected state initially.
@@ -45,6 +65,22 @@ uint32_t measure_pulse(bool state, uint32_t timeout_us);
 void interrupts_disable();
 
 /// Re-enable interrupts on current core.
+/// With ADB_PROFILE=1 the window since interrupts_disable() is recorded
+/// in the adb.irq_off profiler zone.
 void interrupts_enable();
 
+// ─── Attention wake interrupt (ADB_ATTN_IRQ=1) ──────────────────────────────
+
+/// Install the falling-edge interrupt on the data line, disarmed. Must be
+/// called from the ADB task: the GPIO ISR is allocated on the calling core
+/// and notifies the calling task.
+void attn_irq_init();
+
+/// Block the calling task until the data line falls, or timeout_ms passes.
+/// The interrupt is armed only for the duration of the call and disarms
+/// itself on the first edge, so bit cells never re-trigger it.
+/// @return micros_now() taken in the ISR at the falling edge, or 0 on
+///         timeout. If the line is already low when armed, the current time.
+uint32_t sleep_until_low(uint32_t timeout_ms);
+
 } // namespace adb_platform
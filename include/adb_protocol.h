@@ -37,13 +37,17 @@ void bus_monitor();
 // ─── Low-level bit I/O (IRAM_ATTR in .cpp) ─────────────────────────────
 
 /// Send a single ADB bit (device→host).
-void send_bit(bool bit);
+/// @return false if another device held the line low when we released it
+///         (collision — the line is released, stop sending).
+bool send_bit(bool bit);
 
 /// Send a byte as 8 ADB bits, MSB first.
-void send_byte(uint8_t byte);
+/// @return false on collision (aborted at the colliding bit).
+bool send_byte(uint8_t byte);
 
 /// Send a 16-bit data word with start bit and stop bit (Talk response).
-void send_data(uint16_t data);
+/// @return false on collision (aborted at the colliding bit).
+bool send_data(uint16_t data);
 
 /// Receive a single ADB bit from the bus.
 /// @return -1 on timeout/error, 0 or 1 for the bit value.
@@ -64,10 +68,4 @@ AdbCommand receive_command();
 /// Assert a Service Request (extend stop-bit low to 300µs).
 void assert_srq();
 
-/// Get total ADB polls received.
-uint32_t get_poll_count();
-
-/// Get total Talk responses sent.
-uint32_t get_response_count();
-
 } // namespace adb_protocol
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+// ─── Second ADB Bus on RMT (ADB_BUS_B=1) ───────────────────────────────────
+// A second, independent ADB bus for a second Mac, with its own keyboard and
+// mouse state (adb_keyboard / adb_mouse bus index). Core 1 belongs to the
+// bit-banged bus loop, and Core 0 can't spin on a pin without starving
+// BLE, so this engine leans on hardware instead:
+//
+//   RX   An RMT receive channel times every low and high in hardware,
+//        behind its glitch filter, and interrupts once per low/high pair.
+//        The interrupt decodes attention, the command byte and Listen
+//        data with the bit threshold learned from this host.
+//   SRQ  The command's last pair lands as the host pulls the stop bit
+//        low: the interrupt then starts an RMT waveform that holds the
+//        line low for ADB_SRQ_LOW_US.
+//   TX   The task builds the Talk reply as RMT items led by an idle span
+//        that puts the start bit Tlt after the stop bit, however late the
+//        task itself ran. A reply it can no longer start in time is not
+//        sent (the data stays for the next poll) and counted as late.
+//
+// No collision detection on this bus: the RMT doesn't read back the line.
+
+namespace adb_rmt_bus {
+
+/// Set up the pin, RMT channels and receive interrupt for `bus`, then serve
+/// it forever. Run from a Core 0 task: the interrupt lands on the core
+/// that installs it.
+void task_loop(int pin, uint8_t bus);
+
+} // namespace adb_rmt_bus
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include "config.h"
+
+// ─── Adaptive Bit Threshold ────────────────────────────────────────────────
+// Running estimates of this host's '0'-bit and '1'-bit low times, learned
+// from the command bytes it sends, with the decode threshold kept at their
+// midpoint. Hosts differ (Mac SE, Mac II, IIgs, third-party controllers)
+// and a marginal one can put its '1' bits within jitter of the fixed 50µs
+// split; tracking the host keeps the split centred in its own gap.
+//
+// Each learned byte is split into '1's and '0's by a few two-means passes
+// started from the current threshold, not by the threshold itself, so a
+// skewed host is learned from its first bytes instead of only from what
+// the default already decodes correctly. A byte whose two groups end up
+// less than ADB_BIT_SPLIT_MIN_US apart is all one kind and is assigned by
+// the threshold. Sanity bounds keep one noisy byte from moving the
+// threshold far: samples outside ADB_BIT_LEARN_MIN_US..ADB_BIT_LEARN_MAX_US
+// reject the byte, and the threshold stays within ADB_BIT_THRESHOLD_MIN_US
+// ..ADB_BIT_THRESHOLD_MAX_US (or falls back to ADB_BIT_THRESHOLD_US while
+// the two estimates are less than ADB_BIT_SPLIT_MIN_US apart).
+//
+// Header-only and free of Arduino/IDF dependencies so the host-side
+// simulator (tools/adb_bit_sim.cpp) runs the same code as the firmware.
+// Single writer: the ADB task.
+
+class BitTiming {
+public:
+    BitTiming() { reset(); }
+
+    /// Back to the spec's nominal timing and the fixed threshold.
+    void reset() {
+        m_bit0_x16  = ADB_BIT_0_LOW_US << 4;
+        m_bit1_x16  = ADB_BIT_1_LOW_US << 4;
+        m_threshold = ADB_BIT_THRESHOLD_US;
+    }
+
+    /// Decode one bit cell from its low time: 1 below the threshold.
+    inline __attribute__((always_inline)) int classify(uint32_t low_us) const {
+        return low_us < m_threshold ? 1 : 0;
+    }
+
+    /// Fold in the low times of one byte the decoder accepted.
+    /// @return false if the byte was rejected by the sanity bounds.
+    bool learn_byte(const uint8_t low_us[8]) {
+        for (int i = 0; i < 8; i++) {
+            if (low_us[i] < ADB_BIT_LEARN_MIN_US || low_us[i] > ADB_BIT_LEARN_MAX_US) return false;
+        }
+
+        // Two-means in 1/16 µs, starting from the current split
+        uint32_t split_x16 = m_threshold << 4;
+        uint32_t mean1 = 0, mean0 = 0, n1 = 0;
+        for (int pass = 0; pass < 3; pass++) {
+            uint32_t sum1 = 0, sum0 = 0;
+            n1 = 0;
+            for (int i = 0; i < 8; i++) {
+                uint32_t v = (uint32_t)low_us[i] << 4;
+                if (v < split_x16) { sum1 += v; n1++; }
+                else               { sum0 += v; }
+            }
+            if (n1 == 0 || n1 == 8) break;
+            mean1 = sum1 / n1;
+            mean0 = sum0 / (8 - n1);
+            uint32_t next = (mean1 + mean0) / 2;
+            if (next == split_x16) break;
+            split_x16 = next;
+        }
+
+        if (n1 == 0 || n1 == 8 || mean0 < mean1 + (ADB_BIT_SPLIT_MIN_US << 4)) {
+            // All one kind (0x00, 0xFF, or groups too close to tell apart)
+            uint32_t sum = 0;
+            for (int i = 0; i < 8; i++) sum += (uint32_t)low_us[i] << 4;
+            uint32_t mean = sum / 8;
+            fold(classify(mean >> 4) ? m_bit1_x16 : m_bit0_x16, mean);
+        } else {
+            fold(m_bit1_x16, mean1);
+            fold(m_bit0_x16, mean0);
+        }
+        update_threshold();
+        return true;
+    }
+
+    /// Fold in the sync high time: the host times it with the same long
+    /// interval as a '0' bit's low phase.
+    void learn_sync(uint32_t sync_us) {
+        if (sync_us < ADB_BIT_LEARN_MIN_US || sync_us > ADB_BIT_LEARN_MAX_US) return;
+        fold(m_bit0_x16, sync_us << 4);
+        update_threshold();
+    }
+
+    uint32_t threshold_us() const { return m_threshold; }
+    uint32_t bit0_us() const { return (m_bit0_x16 + 8) >> 4; }
+    uint32_t bit1_us() const { return (m_bit1_x16 + 8) >> 4; }
+
+private:
+    /// Eighth-weight moving average in 1/16 µs.
+    static void fold(uint32_t& est_x16, uint32_t sample_x16) {
+        est_x16 = (uint32_t)((int32_t)est_x16 + ((int32_t)sample_x16 - (int32_t)est_x16) / 8);
+    }
+
+    void update_threshold() {
+        if (m_bit0_x16 < m_bit1_x16 + (ADB_BIT_SPLIT_MIN_US << 4)) {
+            m_threshold = ADB_BIT_THRESHOLD_US;
+            return;
+        }
+        uint32_t mid = ((m_bit0_x16 + m_bit1_x16) / 2 + 8) >> 4;
+        if (mid < ADB_BIT_THRESHOLD_MIN_US) mid = ADB_BIT_THRESHOLD_MIN_US;
+        if (mid > ADB_BIT_THRESHOLD_MAX_US) mid = ADB_BIT_THRESHOLD_MAX_US;
+        m_threshold = mid;
+    }
+
+    uint32_t m_bit0_x16;    // '0' low-time estimate, 1/16 µs
+    uint32_t m_bit1_x16;    // '1' low-time estimate, 1/16 µs
+    uint32_t m_threshold;   // current split, µs
+};
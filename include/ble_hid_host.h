@@ -4,7 +4,7 @@
 
 // ─── BLE HID Host (NimBLE Central) ─────────────────────────────────────────
 // Scans for BLE HID devices (keyboard and mouse), connects, subscribes to
-// HID Report notifications, parses reports, and pushes events to queues.
+// HID Report notifications, and hands raw reports to the input stage.
 
 namespace ble_hid_host {
 
@@ -18,12 +18,21 @@ enum class DeviceState : uint8_t {
     RECONNECTING
 };
 
+/// Scan scheduler mode (see ble_hid_host.cpp for the policy).
+enum class ScanMode : uint8_t {
+    OFF,             // all wanted devices connected
+    DISCOVERY,       // nothing live — aggressive active scan
+    DISCOVERY_BG,    // one device live, other slot unknown — low duty
+    RECONNECT        // bonded devices only — accept list, passive, low duty
+};
+
 /// Status of a connected BLE device.
 struct DeviceStatus {
     DeviceState state;
     char name[32];
     bool is_keyboard;
     bool is_mouse;
+    uint16_t conn_interval;   // negotiated, in 1.25 ms units (0 = no link)
 };
 
 /// Initialize the NimBLE stack and start scanning for HID devices.
@@ -34,10 +43,11 @@ void init();
 /// This function never returns.
 void task_loop();
 
-/// Get the current keyboard device status.
+/// Get the current keyboard device status. Safe from any core — returns
+/// the last consistent snapshot published by the BLE task (≤100 ms old).
 DeviceStatus get_keyboard_status();
 
-/// Get the current mouse device status.
+/// Get the current mouse device status (same snapshot rules).
 DeviceStatus get_mouse_status();
 
 /// Check if a keyboard is connected.
@@ -46,25 +56,27 @@ bool keyboard_connected();
 /// Check if a mouse is connected.
 bool mouse_connected();
 
-/// Get BLE mouse callback invocation count (diagnostic).
-uint32_t get_mouse_cb_count();
-
-/// Get BLE keyboard callback invocation count (diagnostic).
-uint32_t get_kbd_cb_count();
-
-/// Get count of keyboard reports that passed length filter.
-uint32_t get_kbd_cb_used();
-
-/// Get count of keyboard reports rejected by length filter.
-uint32_t get_kbd_cb_dropped();
-
 /// Get millis() timestamp of last keyboard notification.
 uint32_t get_kbd_last_ms();
 
 /// Get millis() timestamp of last mouse notification.
 uint32_t get_mouse_last_ms();
 
-/// Print per-handle callback stats to Serial.
-void dump_handle_stats();
+/// Get millis() since boot when the keyboard first became ready (0 = not yet).
+uint32_t get_kbd_ready_ms();
+
+/// Get millis() since boot when the mouse first became ready (0 = not yet).
+uint32_t get_mouse_ready_ms();
+
+/// Get the current scan scheduler mode.
+ScanMode get_scan_mode();
+
+/// Print per-mode residency and notification jitter to Serial.
+/// Reads the snapshot the BLE task publishes — safe from any core.
+void dump_scan_stats();
+
+/// Erase the remembered keyboard/mouse addresses from NVS and abandon any
+/// boot-time direct connection to them. Call after deleting all bonds.
+void forget_devices();
 
 } // namespace ble_hid_host
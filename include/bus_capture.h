@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include "config.h"
+
+// ─── ADB Bus Capture (ADB_BUS_CAPTURE=1) ───────────────────────────────────
+// Logic-analyzer mode. Core 1 does nothing but poll the ADB line and push a
+// timestamp for every edge into a large RAM ring; a streamer task on Core 0
+// encodes the edges into compact binary frames and writes them to Serial
+// while capture continues. tools/adb_capture_decode.cpp turns the stream
+// back into annotated transactions and VCD.
+//
+// This header is also included by the host-side decoder — keep it free of
+// firmware-only includes.
+
+// ─── Stream format ──────────────────────────────────────────────────────────
+// Frame, little-endian:
+//   [0xAD][0xCA][n:1][flags:1][t0_us:4][delta_us varint × (n−1)][xor:1]
+// t0_us   — 31-bit µs timestamp of the frame's first edge (wraps ~35 min)
+// deltas  — µs between consecutive edges, unsigned LEB128 varints
+// flags   — bit 0: line level after the first edge; levels then alternate
+//           bit 1: edges were dropped (ring full) before this frame
+// xor     — XOR of every byte after the two sync bytes
+// Bytes outside frames are plain Serial text and should be passed through.
+
+constexpr uint8_t CAPTURE_FRAME_SYNC0    = 0xAD;
+constexpr uint8_t CAPTURE_FRAME_SYNC1    = 0xCA;
+constexpr uint8_t CAPTURE_FLAG_LEVEL     = 0x01;
+constexpr uint8_t CAPTURE_FLAG_OVERFLOW  = 0x02;
+constexpr uint32_t CAPTURE_TIME_MASK     = 0x7FFFFFFF;   // 31-bit timestamps
+
+namespace bus_capture {
+
+/// Edge capture loop — runs on Core 1 in place of the bus loop.
+/// Never yields (Core 1's idle task is removed from the task watchdog).
+/// This function never returns.
+void capture_loop();
+
+/// Streamer task loop — runs on Core 0. Drains the edge ring into
+/// binary frames on Serial. This function never returns.
+void stream_task_loop();
+
+} // namespace bus_capture
@@ -8,6 +8,9 @@
 constexpr int ADB_DATA_PIN = 48;
 constexpr uint32_t ADB_PIN_BITMASK = (1UL << (ADB_DATA_PIN - 32));
 
+// GPIO47 — second ADB bus (ADB_BUS_B=1), also free on Heltec V3
+constexpr int ADB_BUS_B_PIN = 47;
+
 // ─── Vext (Heltec V3 external power control) ────────────────────────────────
 // GPIO36 controls power to OLED and other external peripherals.
 // LOW = power on, HIGH = power off.
@@ -41,6 +44,13 @@ constexpr uint32_t ADB_BIT_1_LOW_US      = 35;     // '1' bit: 35µs low, 65µs
 constexpr uint32_t ADB_BIT_1_HIGH_US     = 65;     // '1' bit: 65µs high
 constexpr uint32_t ADB_BIT_THRESHOLD_US  = 50;     // <50µs low = '1', >=50µs low = '0'
 
+// Adaptive bit threshold (bit_timing.h) — learned from the host's command bytes
+constexpr uint32_t ADB_BIT_THRESHOLD_MIN_US = 38;  // learned threshold never goes below this
+constexpr uint32_t ADB_BIT_THRESHOLD_MAX_US = 62;  // ... or above this
+constexpr uint32_t ADB_BIT_SPLIT_MIN_US  = 15;     // min '0'/'1' low-time gap to learn from
+constexpr uint32_t ADB_BIT_LEARN_MIN_US  = 15;     // low times outside these bounds reject the byte
+constexpr uint32_t ADB_BIT_LEARN_MAX_US  = 95;
+
 // Stop bit
 constexpr uint32_t ADB_STOP_LOW_US       = 65;     // stop bit low (same as '0')
 constexpr uint32_t ADB_STOP_HIGH_MIN_US  = 35;     // minimum stop bit high
@@ -52,12 +62,20 @@ constexpr uint32_t ADB_SRQ_LOW_US        = 300;    // SRQ: hold low for 300µs
 constexpr uint32_t ADB_TLT_US            = 200;    // Stop-to-Start time (Tlt)
 constexpr uint32_t ADB_TLT_MAX_US        = 260;    // max Tlt before host gives up
 
+// Collision detection (adb_protocol::send_bit)
+constexpr uint32_t ADB_COLLISION_SETTLE_US = 3;    // after release, before checking the line is high
+constexpr uint32_t ADB_COLLISION_BACKOFF_MAX_POLLS = 4; // after an R0 collision, skip 1..this many polls
+
 // Global reset
 constexpr uint32_t ADB_RESET_MIN_US      = 2800;   // >2800µs low = global reset
 
 // Timing tolerance
 constexpr uint32_t ADB_TIMING_TOLERANCE_US = 15;   // ±15µs tolerance on bit reads
 
+// Glitch filter (ADB_GLITCH_FILTER=1, glitch_filter.h)
+constexpr uint32_t ADB_GLITCH_US         = 3;      // a level held for less than this is a glitch
+constexpr uint32_t ADB_GLITCH_CONFIRM_SAMPLES = 3; // and it must also read back this many times in a row
+
 // ─── ADB Addresses ─────────────────────────────────────────────────────────
 constexpr uint8_t ADB_ADDR_KEYBOARD      = 2;      // default keyboard address
 constexpr uint8_t ADB_ADDR_MOUSE         = 3;      // default mouse address
@@ -75,11 +93,47 @@ constexpr uint8_t ADB_HANDLER_MOUSE      = 2;      // Standard 100cpi mouse hand
 // ─── Event Queue Sizes ─────────────────────────────────────────────────────
 constexpr int KBD_QUEUE_SIZE             = 32;     // keyboard event queue depth
 constexpr int MOUSE_QUEUE_SIZE           = 64;     // mouse event queue depth
+constexpr int ADB_KEY_BUF_SIZE           = 32;     // key events staged in the keyboard for Talk R0
+constexpr int ADB_MOUSE_ACCUM_MAX        = 1024;   // mouse motion held back for Talk R0, per axis (saturates)
+constexpr uint32_t LED_QUEUE_SIZE        = 8;      // keyboard LED changes in flight to the BLE task, per bus (power of two)
+
+// ─── Input Stage (raw HID report ring) ─────────────────────────────────────
+// NimBLE callbacks only copy the raw report into this ring; the input task
+// does the diffing and keycode translation off the NimBLE host task.
+constexpr int INPUT_RING_SIZE            = 64;     // raw reports in flight (power of 2)
+constexpr int INPUT_REPORT_MAX_LEN       = 16;     // bytes copied per report (longer = truncated)
+constexpr uint32_t INPUT_JITTER_GAP_US   = 50000;  // longer notification gaps = idle, not jitter
 
 // ─── BLE ────────────────────────────────────────────────────────────────────
 constexpr uint32_t BLE_SCAN_DURATION_S   = 0;      // 0 = scan forever
+
+// Scan scheduler duty cycles (window must be <= interval).
+// DISCOVERY: nothing connected — aggressive active scan.
 constexpr uint32_t BLE_SCAN_INTERVAL_MS  = 100;    // scan interval
 constexpr uint32_t BLE_SCAN_WINDOW_MS    = 80;     // scan window (must be <= interval)
+// DISCOVERY_BG: one device live, the other slot unknown — keep radio free for the live link.
+constexpr uint32_t BLE_SCAN_BG_INTERVAL_MS = 320;
+constexpr uint32_t BLE_SCAN_BG_WINDOW_MS   = 30;
+// RECONNECT: only bonded devices in RECONNECTING, accept-list filtered, passive.
+constexpr uint32_t BLE_SCAN_RECONNECT_INTERVAL_MS = 200;
+constexpr uint32_t BLE_SCAN_RECONNECT_WINDOW_MS   = 20;
+
+// Connection parameters (interval in 1.25 ms units, timeout in 10 ms units).
+// Fast while a Mac is polling; relaxed while host_presence says none is.
+constexpr uint16_t BLE_CONN_MIN_INTERVAL      = 12;    // 15 ms
+constexpr uint16_t BLE_CONN_MAX_INTERVAL      = 40;    // 50 ms
+constexpr uint16_t BLE_CONN_LATENCY           = 0;
+constexpr uint16_t BLE_CONN_TIMEOUT           = 400;   // 4 s
+constexpr uint16_t BLE_CONN_IDLE_MIN_INTERVAL = 80;    // 100 ms
+constexpr uint16_t BLE_CONN_IDLE_MAX_INTERVAL = 160;   // 200 ms
+constexpr uint16_t BLE_CONN_IDLE_LATENCY      = 4;     // peripheral may sit out 4 events with nothing to send
+constexpr uint16_t BLE_CONN_IDLE_TIMEOUT      = 600;   // 6 s (> 2 × (1 + latency) × interval)
+
+// ─── Host Presence ──────────────────────────────────────────────────────────
+// No command from the Mac for HOST_ABSENT_MS: it is asleep or off.
+constexpr uint32_t HOST_ABSENT_MS        = 2000;  // bus silence before the host counts as gone
+constexpr uint32_t HOST_LISTEN_MS        = 50;    // host gone: after line activity, spin this long before sleeping again
+constexpr uint32_t HOST_ABSENT_WAKE_MS   = 100;   // host gone: longest sleep (ADB_ATTN_IRQ=1, bus-B task)
 
 // ─── Bond Clear Button ──────────────────────────────────────────────────────
 constexpr int      BOND_CLEAR_PIN     = 0;     // GPIO0 (BOOT button on Heltec V3)
@@ -87,12 +141,88 @@ constexpr uint32_t BOND_CLEAR_HOLD_MS = 3000;  // hold 3 seconds to clear bonds
 
 // ─── BLE Reconnection ───────────────────────────────────────────────────────
 constexpr uint32_t BLE_RECONNECT_TIMEOUT_MS    = 5000;   // connect timeout per attempt
+constexpr uint32_t BLE_BOOT_CONNECT_TIMEOUT_MS = 1500;   // first direct-connect attempt at boot
 constexpr uint32_t BLE_RECONNECT_INITIAL_MS    = 1000;   // initial backoff delay
 constexpr uint32_t BLE_RECONNECT_MAX_MS        = 30000;  // max backoff delay
 constexpr int      BLE_RECONNECT_MAX_ATTEMPTS  = 10;     // give up after this many failures
 
 // ─── OLED Update ────────────────────────────────────────────────────────────
 constexpr uint32_t OLED_UPDATE_INTERVAL_MS = 250;  // 4 Hz display refresh
+constexpr uint32_t OLED_I2C_CHUNK          = 64;   // data bytes per I2C transaction (Wire buffer is 128)
+constexpr uint32_t OLED_BUTTON_POLL_MS     = 50;   // BOOT button sampling for page switching
+constexpr uint32_t OLED_SPARK_SAMPLES      = 120;  // latency sparkline history, one sample per second
+
+// ─── Core 1 Stall Detection ─────────────────────────────────────────────────
+constexpr uint32_t ADB_STALL_MIN_US      = 3;     // gap in a bus-wait spin counted as an interrupt
+
+// ─── Pin Access Benchmark (ADB_SELF_TEST=1) ─────────────────────────────────
+constexpr uint32_t ADB_IO_BENCH_SAMPLES  = 1000;  // reads, samples and falling edges timed per backend
+
+// ─── ADB Task Watchdog ──────────────────────────────────────────────────────
+constexpr uint32_t ADB_WDT_FEED_MS       = 500;   // ADB task feeds the TWDT at most this often
+constexpr uint32_t ADB_IDLE_YIELD_MS     = 100;   // bus silence before the ADB task yields a tick
+constexpr uint32_t ADB_LOOP_YIELD_MS     = 100;   // ADB_CORE1_ISOLATION=0: tick given to loop() this often
+constexpr uint32_t ADB_BURST_GAP_US      = 2000;  // attention this soon after a transaction ends is a back-to-back poll
+constexpr uint32_t ADB_YIELD_BUDGET_US   = 2500;  // predicted quiet time needed for a 1-tick yield
+
+// ─── Poll Predictor / Idle Jobs ─────────────────────────────────────────────
+constexpr uint32_t ADB_PRED_TOLERANCE_PCT = 20;   // burst interval within this of the estimate agrees
+constexpr uint32_t ADB_PRED_LOCK_SAMPLES  = 4;    // agreeing intervals before predictions are used
+constexpr uint32_t ADB_JOB_GUARD_US       = 300;  // jobs finish this long before the predicted attention
+constexpr uint32_t ADB_IDLE_JOBS_MAX      = 8;    // registered idle-gap jobs
+constexpr uint32_t ADB_JOB_STAGE_KBD_US   = 50;   // declared worst case: drain keyboard queue
+constexpr uint32_t ADB_JOB_STAGE_MOUSE_US = 100;  // declared worst case: drain mouse queue
+constexpr uint32_t ADB_JOB_DECAY_SHIFT    = 3;    // observed worst case decays 1/2^n per run or skipped window
+
+// ─── Attention Wake Interrupt (ADB_ATTN_IRQ=1) ──────────────────────────────
+constexpr uint32_t ADB_ATTN_IRQ_TIMEOUT_MS = 10;  // longest sleep before the loop re-checks (WDT feed)
+
+// ─── Second ADB Bus / KVM (ADB_BUS_B=1) ────────────────────────────────────
+constexpr int      ADB_BUS_B_RMT_CHANNEL  = 0;    // RMT TX channel for replies and SRQ
+constexpr int      ADB_BUS_B_RX_CHANNEL   = 4;    // RMT RX channel timing the host's edges (S3: 4-7 receive)
+constexpr uint32_t ADB_BUS_B_RX_IDLE_US   = 30000; // RX stops after this long without an edge (> a reset, < 32768)
+constexpr uint32_t ADB_BUS_B_TX_SETUP_US  = 20;   // shortest lead from starting an RMT reply to its first edge
+constexpr uint32_t ADB_BUS_B_IDLE_MS      = 5;    // bus-B task stages input at least this often
+constexpr uint8_t  KVM_HOTKEY_MODIFIERS   = 0x05; // USB modifier bits held for the switch: Left Ctrl + Left Alt
+constexpr uint8_t  KVM_HOTKEY_USAGE       = 0x2B; // USB usage pressed with them: Tab
+
+// ─── Text Injection ─────────────────────────────────────────────────────────
+// Console 'type' / 'paste' text typed into the focused Mac (text_inject).
+constexpr uint32_t TYPE_BUF_SIZE         = 2048;  // bytes of text buffered (power of 2)
+constexpr uint32_t TYPE_QUEUE_DEPTH      = 8;     // key events kept in flight (queue + keyboard buffer)
+constexpr uint32_t TYPE_POLL_MS          = 1;     // injector wake period while typing
+constexpr uint32_t TYPE_PACE_MS          = 0;     // default pause after each character (console 'pace')
+constexpr uint8_t  TYPE_END              = 0x04;  // Ctrl-D: ends a paste (and each 'type' line)
+constexpr uint32_t TYPE_XOFF_FREE        = TYPE_BUF_SIZE / 4;  // paste: XOFF once free space falls to this
+constexpr uint32_t TYPE_XON_FREE         = TYPE_BUF_SIZE / 2;  // paste: XON once it is back to this
+
+// ─── Deferred Logging ───────────────────────────────────────────────────────
+constexpr uint32_t LOG_RING_SIZE         = 64;    // records per core (power of 2)
+constexpr uint32_t LOG_MAX_ARGS          = 4;     // 32-bit arguments per record
+constexpr uint32_t LOG_DRAIN_INTERVAL_MS = 20;    // log task wake period
+
+// ─── Metrics ────────────────────────────────────────────────────────────────
+constexpr uint32_t METRICS_HIST_BUCKETS       = 32;      // buckets per histogram
+constexpr uint32_t METRICS_EXPORT_INTERVAL_MS = 30000;   // full [METRICS] dump period
+
+// ─── Serial Console ─────────────────────────────────────────────────────────
+constexpr uint32_t CONSOLE_LINE_MAX           = 64;      // longest accepted command line
+constexpr uint32_t CONSOLE_POLL_INTERVAL_MS   = 100;     // status/console wake period (input + status check)
+constexpr uint32_t CONSOLE_PASTE_POLL_MS      = 2;       // console wake period while text is pasted or typed
+constexpr uint32_t CONSOLE_RX_BUFFER          = 2048;    // UART RX buffer: a full poll interval at SERIAL_BAUD
+
+// ─── Bus Capture (ADB_BUS_CAPTURE=1) ────────────────────────────────────────
+constexpr uint32_t BUS_CAPTURE_RING_SIZE   = 8192;     // edges buffered in RAM (power of 2)
+constexpr uint32_t BUS_CAPTURE_FRAME_EDGES = 64;       // max edges per streamed frame
+constexpr uint32_t BUS_CAPTURE_FLUSH_MS    = 5;        // streamer poll period when idle
+constexpr int      BUS_CAPTURE_BAUD        = 921600;   // Serial baud in capture mode
+constexpr uint32_t BUS_CAPTURE_TX_BUFFER   = 4096;     // UART TX buffer in capture mode
+
+// ─── Serial HID Injection (ADB_HID_INJECT=1) ────────────────────────────────
+constexpr int      HID_INJECT_BAUD             = 921600;   // Serial baud with injection on
+constexpr uint32_t HID_INJECT_RX_BUFFER        = 4096;     // UART RX buffer: absorbs sender bursts
+constexpr uint32_t HID_INJECT_POLL_MS          = 1;        // serial reader wake period
+constexpr uint32_t HID_INJECT_FRAME_TIMEOUT_MS = 20;       // a frame silent this long is abandoned
 
 // ─── Debug ──────────────────────────────────────────────────────────────────
 constexpr int SERIAL_BAUD               = 115200;
@@ -106,16 +236,75 @@ constexpr int SERIAL_BAUD               = 115200;
 #define ADB_SELF_TEST 0          // 1 = run timing self-test at boot
 #endif
 
+#ifndef ADB_LOG_BINARY
+#define ADB_LOG_BINARY 0         // 1 = deferred log emits binary frames (tools/log_decode.cpp)
+#endif
+
 #ifndef ADB_BUS_MONITOR
 #define ADB_BUS_MONITOR 0        // 1 = passive bus monitor mode (no device emulation)
 #endif
 
+#ifndef ADB_PROFILE
+#define ADB_PROFILE 0            // 1 = cycle-profile hot-path zones (console "prof")
+#endif
+
+#ifndef ADB_BUS_CAPTURE
+#define ADB_BUS_CAPTURE 0        // 1 = logic-analyzer edge capture (tools/adb_capture_decode.cpp)
+#endif
+
+#ifndef ADB_CORE1_ISOLATION
+#define ADB_CORE1_ISOLATION 1    // 1 = init, ISRs and status/console on Core 0; Core 1 runs only ADB
+#endif
+
+#ifndef ADB_DEDICATED_GPIO
+#define ADB_DEDICATED_GPIO 0     // 1 = drive/read the ADB pin with dedicated-GPIO CPU instructions
+#endif
+
+#ifndef ADB_GLITCH_FILTER
+#define ADB_GLITCH_FILTER 0      // 1 = line waits ignore pulses shorter than ADB_GLITCH_US
+#endif
+
+#ifndef ADB_ATTN_IRQ
+#define ADB_ATTN_IRQ 0           // 1 = ADB task sleeps until a falling-edge interrupt on the data line
+#endif
+
+#ifndef ADB_HID_INJECT
+#define ADB_HID_INJECT 0         // 1 = HID report frames from a PC on the serial port (tools/hid_replay.cpp)
+#endif
+
+#ifndef ADB_BUS_B
+#define ADB_BUS_B 0              // 1 = second ADB bus on ADB_BUS_B_PIN (RMT) with a KVM hotkey
+#endif
+
+#if ADB_HID_INJECT && ADB_BUS_CAPTURE
+#error "ADB_HID_INJECT and ADB_BUS_CAPTURE both take over the serial port"
+#endif
+
+/// Emulated ADB buses: device state, event queues and input focus are per bus.
+constexpr int ADB_BUS_COUNT = ADB_BUS_B ? 2 : 1;
+
 // ─── Task Stack Sizes ───────────────────────────────────────────────────────
 constexpr uint32_t ADB_TASK_STACK_SIZE   = 4096;
 constexpr uint32_t BLE_TASK_STACK_SIZE   = 8192;
+constexpr uint32_t INPUT_TASK_STACK_SIZE = 4096;
 constexpr uint32_t OLED_TASK_STACK_SIZE  = 4096;
+constexpr uint32_t LOG_TASK_STACK_SIZE   = 3072;
+constexpr uint32_t CAPTURE_TASK_STACK_SIZE = 3072;
+constexpr uint32_t ADB_BUS_B_TASK_STACK_SIZE = 4096;
+constexpr uint32_t TYPE_TASK_STACK_SIZE  = 3072;
+constexpr uint32_t HID_INJECT_TASK_STACK_SIZE = 4096;  // also runs console commands
+constexpr uint32_t INIT_TASK_STACK_SIZE  = 8192;   // ADB_CORE1_ISOLATION — runs setup on Core 0
+constexpr uint32_t STATUS_TASK_STACK_SIZE = 4096;  // ADB_CORE1_ISOLATION — replaces loop()
 
 // ─── Task Priorities ────────────────────────────────────────────────────────
 constexpr int ADB_TASK_PRIORITY          = 5;      // highest — timing-critical
+constexpr int INPUT_TASK_PRIORITY        = 4;      // above BLE — parse reports promptly
 constexpr int BLE_TASK_PRIORITY          = 3;
 constexpr int OLED_TASK_PRIORITY         = 1;      // lowest — cosmetic only
+constexpr int LOG_TASK_PRIORITY          = 1;      // lowest — drains deferred log
+constexpr int CAPTURE_TASK_PRIORITY      = 2;      // capture mode only — streams edges
+constexpr int TYPE_TASK_PRIORITY         = 2;      // text injection — below input, so live keys still flow
+constexpr int HID_INJECT_TASK_PRIORITY   = 3;      // serial reader — a report producer, like BLE
+constexpr int ADB_BUS_B_TASK_PRIORITY    = 6;      // Core 0, above everything app-level — reply deadline
+constexpr int INIT_TASK_PRIORITY         = 1;      // same as the Arduino loop task it stands in for
+constexpr int STATUS_TASK_PRIORITY       = 1;      // lowest — serial status and console
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include "config.h"
+#include "log_tokens.h"
+
+// ─── Deferred Tokenized Logging ────────────────────────────────────────────
+// Logging for code that must not block on the UART — mainly the ADB task on
+// Core 1. A call stores a compact record (token ID, core, timestamp, raw
+// 32-bit arguments) into a per-core lock-free ring in a few dozen cycles.
+// A low-priority task on Core 0 formats and transmits the records, as text
+// or (ADB_LOG_BINARY=1) as binary frames for tools/log_decode.cpp.
+
+namespace deferred_log {
+
+/// Message IDs — generated from LOG_TOKEN_LIST in log_tokens.h.
+enum class Token : uint16_t {
+#define LOG_TOKEN_ENUM(id, fmt) id,
+    LOG_TOKEN_LIST(LOG_TOKEN_ENUM)
+#undef LOG_TOKEN_ENUM
+    COUNT
+};
+
+/// One deferred log record.
+struct Record {
+    uint32_t timestamp_us;
+    uint16_t token;
+    uint8_t  core;
+    uint8_t  nargs;
+    uint32_t args[LOG_MAX_ARGS];
+};
+
+/// Initialize the per-core rings.
+void init();
+
+/// Store a record in the calling core's ring (IRAM_ATTR, never blocks,
+/// safe with interrupts disabled). Drops the record if the ring is full.
+void write(Token token, uint8_t nargs, const uint32_t* args);
+
+/// Log drain task loop — runs on Core 0 at low priority.
+/// This function never returns.
+void task_loop();
+
+// ─── Call-site helpers ──────────────────────────────────────────────────────
+
+inline void log(Token token) {
+    write(token, 0, nullptr);
+}
+
+template <typename... Args>
+inline void log(Token token, Args... args) {
+    static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "too many deferred_log arguments");
+    const uint32_t a[] = { (uint32_t)args... };
+    write(token, sizeof...(Args), a);
+}
+
+} // namespace deferred_log
+
+/// Deferred log call: DLOG(ADB_FLUSH, addr)
+#define DLOG(token, ...) deferred_log::log(deferred_log::Token::token, ##__VA_ARGS__)
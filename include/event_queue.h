@@ -3,52 +3,110 @@
 #include <cstdint>
 #include <freertos/FreeRTOS.h>
 #include <freertos/queue.h>
+#include "metrics.h"
 
 // ─── Event Types ────────────────────────────────────────────────────────────
 
+// Latency trace timestamps are µs on the esp_timer clock (micros() on
+// Core 0, adb_platform::micros_now() on Core 1 — same time base).
+
 /// Keyboard event: a single key press or release.
 struct KbdEvent {
-    uint8_t adb_keycode;   // 7-bit ADB keycode (0x00–0x7F)
-    bool    released;      // true = key released, false = key pressed
+    uint8_t  adb_keycode;  // 7-bit ADB keycode (0x00–0x7F)
+    bool     released;     // true = key released, false = key pressed
+    uint32_t t_capture_us; // BLE notification arrived (NimBLE callback)
+    uint32_t t_queued_us;  // pushed into the event queue (set by send_kbd)
 };
 
 /// Mouse event: button state + movement deltas.
 struct MouseEvent {
-    int16_t dx;            // X movement (signed, will be clamped to 7-bit)
-    int16_t dy;            // Y movement (signed, will be clamped to 7-bit)
-    bool    button;        // true = button pressed (will be inverted for ADB)
+    int16_t  dx;           // X movement (signed, will be clamped to 7-bit)
+    int16_t  dy;           // Y movement (signed, will be clamped to 7-bit)
+    bool     button;       // true = button pressed (will be inverted for ADB)
+    uint32_t t_capture_us; // BLE notification arrived (NimBLE callback)
+    uint32_t t_queued_us;  // pushed into the event queue (set by send_mouse)
+};
+
+/// Keyboard LED state a Mac wrote (Listen R2), on its way to the BLE
+/// keyboard. Bits as in the HID output report, set = lit.
+struct LedEvent {
+    uint8_t  leds;         // bit 0 Num Lock, 1 Caps Lock, 2 Scroll Lock
+    uint32_t t_posted_us;  // posted by the bus engine
 };
 
+constexpr uint8_t HID_LED_NUM_LOCK    = 0x01;
+constexpr uint8_t HID_LED_CAPS_LOCK   = 0x02;
+constexpr uint8_t HID_LED_SCROLL_LOCK = 0x04;
+
 // ─── Queue Interface ────────────────────────────────────────────────────────
+// One keyboard and one mouse queue per ADB bus (ADB_BUS_COUNT). Producers
+// send to the focused bus; each bus's engine drains its own pair. Events
+// for a bus whose host is gone (host_presence) are discarded, and the
+// send reports success.
 
 namespace event_queue {
 
-/// Initialize both keyboard and mouse event queues.
+/// Initialize the keyboard and mouse event queues of every bus.
 /// Must be called before any other queue operations.
 void init();
 
-/// Get the keyboard event queue handle.
-QueueHandle_t kbd_queue();
+/// Get a bus's keyboard event queue handle.
+QueueHandle_t kbd_queue(uint8_t bus);
 
-/// Get the mouse event queue handle.
-QueueHandle_t mouse_queue();
+/// Get a bus's mouse event queue handle.
+QueueHandle_t mouse_queue(uint8_t bus);
 
-/// Push a keyboard event (non-blocking). Returns true on success.
+/// Bus that live input goes to (KVM focus; always 0 with one bus).
+uint8_t focus();
+
+/// Route input to another bus from now on. Events already queued stay
+/// with the bus they were sent to.
+void set_focus(uint8_t bus);
+
+/// Push a keyboard event to the focused bus (non-blocking). Stamps
+/// t_queued_us and records the notify→queue latency. Returns true on success.
 bool send_kbd(const KbdEvent& evt);
 
-/// Push a mouse event (non-blocking). Returns true on success.
+/// Push a keyboard event to a specific bus (e.g. releases on a focus switch).
+bool send_kbd(uint8_t bus, const KbdEvent& evt);
+
+/// Push a mouse event to the focused bus (non-blocking). Stamps
+/// t_queued_us and records the notify→queue latency. Returns true on success.
 bool send_mouse(const MouseEvent& evt);
 
+/// Push a mouse event to a specific bus.
+bool send_mouse(uint8_t bus, const MouseEvent& evt);
+
 /// Pop a keyboard event (non-blocking). Returns true if an event was available.
-bool receive_kbd(KbdEvent& evt);
+bool receive_kbd(uint8_t bus, KbdEvent& evt);
 
 /// Pop a mouse event (non-blocking). Returns true if an event was available.
-bool receive_mouse(MouseEvent& evt);
+bool receive_mouse(uint8_t bus, MouseEvent& evt);
+
+/// Check if a bus's keyboard queue has pending events.
+bool kbd_pending(uint8_t bus);
+
+/// Check if a bus's mouse queue has pending events.
+bool mouse_pending(uint8_t bus);
+
+/// High-water gauge of a bus's keyboard queue. One gauge per bus, so a
+/// bus-B burst never lands in bus A's figure.
+metrics::Gauge kbd_hwm_gauge(uint8_t bus);
+
+/// High-water gauge of a bus's mouse queue.
+metrics::Gauge mouse_hwm_gauge(uint8_t bus);
+
+// ─── LED Channel (bus engine → BLE task) ────────────────────────────────────
+// The other direction: a lock-free SPSC ring per bus, so the bus loop can
+// post from inside a transaction, interrupts off, in a few cycles. The BLE
+// task drains and coalesces, and does the GATT write itself.
 
-/// Check if keyboard queue has pending events.
-bool kbd_pending();
+/// Post a bus's new LED state (bus engine only). Returns false if the ring
+/// was full (led.dropped).
+bool post_leds(uint8_t bus, const LedEvent& evt);
 
-/// Check if mouse queue has pending events.
-bool mouse_pending();
+/// Pop a bus's oldest LED change (BLE task only). Returns true if one was
+/// available.
+bool receive_leds(uint8_t bus, LedEvent& evt);
 
 } // namespace event_queue
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+
+// ─── XON/XOFF Flow Control ─────────────────────────────────────────────────
+// Software flow control for a sender that fills a buffer faster than it
+// drains: XOFF once free space falls to `stop_free`, XON once it is back
+// to `go_free`. The gap between the two keeps the sender from being
+// toggled on every byte, and `stop_free` must cover what the sender still
+// has in flight when XOFF reaches it.
+//
+// Header-only and free of Arduino/IDF dependencies so the host-side
+// simulator (tools/adb_type_sim.cpp) runs the same decisions as the
+// console. Single user: whichever task reads the serial port.
+
+class XonXoff {
+public:
+    static constexpr uint8_t XON  = 0x11;   // Ctrl-Q
+    static constexpr uint8_t XOFF = 0x13;   // Ctrl-S
+
+    XonXoff(uint32_t stop_free, uint32_t go_free)
+        : m_stop_free(stop_free), m_go_free(go_free) {}
+
+    /// Check the buffer's free space after a write or a drain.
+    /// @return XOFF or XON to send to the sender, or 0 for nothing.
+    uint8_t update(uint32_t free) {
+        if (!m_stopped && free <= m_stop_free) {
+            m_stopped = true;
+            return XOFF;
+        }
+        if (m_stopped && free >= m_go_free) {
+            m_stopped = false;
+            return XON;
+        }
+        return 0;
+    }
+
+    /// XOFF sent and not yet lifted.
+    bool stopped() const { return m_stopped; }
+
+private:
+    uint32_t m_stop_free;
+    uint32_t m_go_free;
+    bool     m_stopped = false;
+};
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include "config.h"
+
+// ─── Glitch-Filtered Line Waits (ADB_GLITCH_FILTER=1) ──────────────────────
+// Without filtering, one spurious sample (ringing on a long cable, level-
+// shifter noise) ends a pulse early and corrupts the whole command. Here a
+// transition only counts once the new level has been read back
+// ADB_GLITCH_CONFIRM_SAMPLES times in a row, over at least ADB_GLITCH_US.
+// If the line reverts first, that was a glitch: it is reported through
+// Io::glitch() and the wait (or the pulse being measured) simply goes on.
+//
+// A confirmed transition is timestamped at its first sample, not at the end
+// of confirmation, so measured widths keep their accuracy. measure_pulse()
+// started right after wait_for_state() confirmed the same level measures
+// from that edge rather than from the (later) call. Anything that moves the
+// line without the filter seeing it (our own drive_low()/release(), a sleep
+// until the edge interrupt) must call forget(), so the next wait reads the
+// line again instead of trusting the last confirmed level.
+//
+// The line and clock come from the Io policy: static bool read(),
+// static uint32_t now() (µs) and static void glitch(). adb_platform
+// supplies the real pin; tools/adb_noise_sim.cpp supplies a simulated
+// noisy line, so both run this exact code.
+
+template <typename Io>
+class GlitchFilter {
+public:
+    /// The line has just been read as `state` at first_us: true once that
+    /// level holds; false (and one glitch reported) if it reverts first.
+    static inline __attribute__((always_inline)) bool confirm(bool state, uint32_t first_us) {
+        uint32_t n = 1;
+        while (true) {
+            if (Io::read() != state) {
+                Io::glitch();
+                return false;
+            }
+            if (++n >= ADB_GLITCH_CONFIRM_SAMPLES && Io::now() - first_us > ADB_GLITCH_US) {
+                return true;
+            }
+        }
+    }
+
+    /// wait_for_state(): elapsed µs until the level is confirmed, or 0 on
+    /// timeout. A line already confirmed in `state` returns at once (never
+    /// 0) and keeps its original edge.
+    inline __attribute__((always_inline)) uint32_t wait_for_state(bool state, uint32_t timeout_us) {
+        uint32_t start = Io::now();
+        if (m_edge_known && m_edge_state == state && Io::read() == state) {
+            uint32_t elapsed = Io::now() - start;
+            return elapsed ? elapsed : 1;
+        }
+        while (true) {
+            while (Io::read() != state) {
+                if (Io::now() - start >= timeout_us) return 0;
+            }
+            uint32_t edge = Io::now();
+            if (confirm(state, edge)) {
+                note_edge(state, edge);
+                return Io::now() - start;
+            }
+        }
+    }
+
+    /// measure_pulse(): µs the line stays in `state` (glitches of the
+    /// opposite level don't end it), timeout_us if it never leaves, or 0
+    /// if it isn't in `state` to begin with. A line last confirmed in
+    /// `state` is taken to still be there — a glitch on the first read
+    /// must not lose the pulse.
+    inline __attribute__((always_inline)) uint32_t measure_pulse(bool state, uint32_t timeout_us) {
+        bool confirmed = m_edge_known && m_edge_state == state;
+        if (!confirmed && Io::read() != state) return 0;
+
+        uint32_t start = Io::now();
+        if (confirmed && start - m_edge_us <= ADB_GLITCH_US * 4) {
+            start = m_edge_us;      // confirmed just now: measure from the edge
+        }
+        while (true) {
+            while (Io::read() == state) {
+                uint32_t elapsed = Io::now() - start;
+                if (elapsed >= timeout_us) return elapsed;
+            }
+            uint32_t end = Io::now();
+            if (confirm(!state, end)) {
+                note_edge(!state, end);
+                return end - start;
+            }
+        }
+    }
+
+    /// Record a transition the caller confirmed itself (e.g. a watched wait).
+    void note_edge(bool state, uint32_t edge_us) {
+        m_edge_us = edge_us;
+        m_edge_state = state;
+        m_edge_known = true;
+    }
+
+    /// The line may have moved unseen: trust nothing until the next
+    /// confirmed transition. One store, cheap enough for the send path.
+    inline __attribute__((always_inline)) void forget() {
+        m_edge_known = false;
+    }
+
+private:
+    uint32_t m_edge_us    = 0;      // last confirmed transition
+    bool     m_edge_state = true;   // level after it
+    bool     m_edge_known = true;   // false: the line moved without us seeing it
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include "config.h"
+
+// ─── Serial HID Injection (ADB_HID_INJECT=1) ───────────────────────────────
+// Raw HID keyboard and mouse reports from a PC over the serial port, fed
+// into the input stage exactly like BLE notifications: same diffing,
+// keycode translation, motion path and latency stamps. A wired, radio-free
+// input source, and a load generator whose rates are set by the sender
+// (tools/hid_replay.cpp).
+//
+// Frames share the port with console text: a byte that isn't part of a
+// frame goes to the serial console as typed. Paste mode (console 'paste')
+// turns frame decoding off until Ctrl-D.
+//
+// This header is also included by the host-side sender — keep it free of
+// firmware-only includes.
+
+// ─── Frame format ───────────────────────────────────────────────────────────
+//   [0xAD][0x1E][seq:1][kind:1][len:1][payload × len][xor:1]
+// seq     — increments per frame; gaps count frames lost on the link
+// kind    — HID_FRAME_* below
+// payload — the report as a BLE notification would carry it (keyboard:
+//           8-byte boot report; mouse: 3-byte boot or 5–7-byte report
+//           protocol), at most HID_FRAME_MAX_PAYLOAD bytes; empty for resets
+// xor     — XOR of seq, kind, len and the payload
+
+constexpr uint8_t HID_FRAME_SYNC0       = 0xAD;
+constexpr uint8_t HID_FRAME_SYNC1       = 0x1E;
+constexpr uint8_t HID_FRAME_KEYBOARD    = 0;
+constexpr uint8_t HID_FRAME_MOUSE       = 1;
+constexpr uint8_t HID_FRAME_RESET_KBD   = 2;     // release everything (like a disconnect)
+constexpr uint8_t HID_FRAME_RESET_MOUSE = 3;
+constexpr size_t  HID_FRAME_MAX_PAYLOAD = INPUT_REPORT_MAX_LEN;
+constexpr size_t  HID_FRAME_OVERHEAD    = 6;     // sync ×2, seq, kind, len, xor
+
+/// Encode one frame into `out` (HID_FRAME_OVERHEAD + len bytes).
+/// @return Frame length, or 0 if the payload is too long.
+inline size_t hid_frame_encode(uint8_t seq, uint8_t kind,
+                               const uint8_t* payload, size_t len, uint8_t* out) {
+    if (len > HID_FRAME_MAX_PAYLOAD) return 0;
+    uint8_t x = seq ^ kind ^ (uint8_t)len;
+    out[0] = HID_FRAME_SYNC0;
+    out[1] = HID_FRAME_SYNC1;
+    out[2] = seq;
+    out[3] = kind;
+    out[4] = (uint8_t)len;
+    for (size_t i = 0; i < len; i++) {
+        out[5 + i] = payload[i];
+        x ^= payload[i];
+    }
+    out[5 + len] = x;
+    return HID_FRAME_OVERHEAD + len;
+}
+
+namespace hid_inject {
+
+/// Serial reader task loop — runs on Core 0. Owns serial input: decodes
+/// frames into the input stage and hands every other byte to the serial
+/// console. This function never returns.
+void task_loop();
+
+} // namespace hid_inject
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+
+// ─── Host Presence ─────────────────────────────────────────────────────────
+// Whether a Mac is polling, from the time of the last command each bus
+// engine decoded. After HOST_ABSENT_MS of silence the host on that bus is
+// asleep or off, and the pipeline stops working for it:
+//   - its engine drops the keys and motion the devices hold, once
+//     (adb_keyboard::discard / adb_mouse::discard), and sleeps between
+//     looks at the line instead of spinning;
+//   - event_queue discards input sent to it (host.discarded), so nothing
+//     stale is waiting when the host comes back;
+//   - with no host on any bus, the BLE task relaxes the connection
+//     parameters and scans for new devices at low duty.
+// The first command decoded brings the bus back at once; BLE follows
+// within a task iteration (host.resume_ms).
+//
+// on_command() and gone() are the bus engines' (one writer per bus);
+// present() reads a timestamp and is safe anywhere. update() and active() belong to the
+// BLE task, which owns the pipeline-wide mode.
+
+namespace host_presence {
+
+/// Bus engine: a command decoded cleanly on `bus`.
+void on_command(uint8_t bus);
+
+/// The host on `bus` sent a command within the last HOST_ABSENT_MS.
+bool present(uint8_t bus);
+
+/// Bus engine: !present(bus). The first call after the host went quiet
+/// also empties the bus's keyboard and mouse, so nothing replays on wake.
+bool gone(uint8_t bus);
+
+/// Pipeline mode: true while a host on any bus is present. Changes only in
+/// update(), so it lags present() by up to one BLE task iteration.
+bool active();
+
+/// Re-evaluate the pipeline mode: print and count transitions, account
+/// residency (host.active_ms / host.absent_ms).
+/// @return true if active() changed.
+bool update();
+
+/// millis() of the first command after the pipeline last became active
+/// (0 = never inactive since boot).
+uint32_t active_since_ms();
+
+} // namespace host_presence
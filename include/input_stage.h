@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include "config.h"
+
+// ─── Input Stage ───────────────────────────────────────────────────────────
+// Decouples HID report parsing from the NimBLE host task. BLE notification
+// callbacks only copy the raw report (plus handle and timestamp) into a
+// preallocated lock-free ring; the input task on Core 0 drains the ring,
+// diffs keyboard reports, translates keycodes and pushes KbdEvent/MouseEvent
+// into the event queues for the ADB side.
+
+namespace input_stage {
+
+/// What a ring record carries.
+enum class ReportKind : uint8_t {
+    KEYBOARD,          // raw keyboard input report
+    MOUSE,             // raw mouse input report
+    RESET_KEYBOARD,    // keyboard disconnected — forget previous key state
+    RESET_MOUSE        // mouse disconnected — forget previous button state
+};
+
+/// One raw report as captured in the NimBLE callback.
+struct RawReport {
+    uint32_t   timestamp_us;                   // micros() at capture
+    uint16_t   handle;                         // GATT characteristic handle
+    ReportKind kind;
+    uint8_t    length;                         // bytes valid in data[]
+    uint8_t    data[INPUT_REPORT_MAX_LEN];
+};
+
+/// Notification inter-arrival jitter accumulators for one device.
+/// Monotonic — diff two snapshots to get the jitter over an interval.
+/// Deviation is |interval − running mean interval|; gaps longer than
+/// INPUT_JITTER_GAP_US (device idle) are not counted.
+struct JitterStats {
+    uint32_t samples;
+    uint64_t abs_dev_sum_us;
+};
+
+/// Initialize the ring and parser state. Call before NimBLE starts.
+void init();
+
+/// Copy a raw report into the ring. Called from NimBLE notification
+/// callbacks — does no parsing and never blocks.
+/// @return false if the ring was full (report dropped).
+bool post_report(ReportKind kind, uint16_t handle,
+                 const uint8_t* data, size_t length);
+
+/// Queue a parser state reset (e.g. on disconnect), ordered with reports.
+void post_reset(ReportKind kind);
+
+#if ADB_HID_INJECT
+/// Handle reported for injected reports in the handle stats.
+constexpr uint16_t INJECTED_HANDLE = 0;
+
+/// post_report() for reports injected over serial (hid_inject). They have
+/// their own ring — the BLE ring has exactly one producer — and go through
+/// the same parser state, so use one keyboard source at a time.
+bool post_injected(ReportKind kind, const uint8_t* data, size_t length);
+#endif
+
+/// Input processing task loop — runs on Core 0.
+/// Sleeps until a report is posted, then parses everything in the ring(s).
+/// This function never returns.
+void task_loop();
+
+/// Get notification jitter accumulators for the keyboard or mouse.
+JitterStats get_jitter(bool keyboard);
+
+/// Print per-handle report counts to Serial.
+void dump_handle_stats();
+
+} // namespace input_stage
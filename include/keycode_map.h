@@ -16,6 +16,11 @@ constexpr uint8_t ADB_KEY_NONE = 0xFF;
 /// @return ADB 7-bit keycode, or ADB_KEY_NONE (0xFF) if unmapped.
 uint8_t usb_to_adb(uint8_t usb_keycode);
 
+/// Reverse lookup for diagnostics and host tools: name of an ADB keycode.
+/// @param adb_keycode 7-bit ADB keycode (release bit must be stripped).
+/// @return Key name (e.g. "Command", "KP5"), or nullptr if no such key.
+const char* adb_key_name(uint8_t adb_keycode);
+
 // ─── USB HID modifier bit positions ────────────────────────────────────────
 // These match the modifier byte in the USB HID boot protocol keyboard report.
 
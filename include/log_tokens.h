@@ -0,0 +1,31 @@
+#pragma once
+
+// ─── Deferred Log Token Table ──────────────────────────────────────────────
+// Every deferred_log message is declared here once: a token ID plus its
+// printf format. Call sites only store the token and raw arguments; the
+// format is applied later on Core 0 (text mode) or on the Linux side by
+// tools/log_decode.cpp (binary mode), which includes this same header.
+//
+// Arguments are stored as unsigned 32-bit values — use %lu / %lX only.
+// Append new tokens at the end so IDs in old binary captures stay valid.
+//
+// Pure preprocessor data — no firmware headers, so host tools can use it.
+
+#define LOG_TOKEN_LIST(X)                                                   \
+    X(ADB_LISTEN,        "[ADB] Listen A%lu R%lu <- 0x%04lX")               \
+    X(ADB_FLUSH,         "[ADB] Flush A%lu")                                \
+    X(ADB_RESET,         "[ADB] Reset A%lu")                                \
+    X(ADB_GLOBAL_RESET,  "[ADB] Global reset (%luus)")                      \
+    X(ADB_COMMAND,       "[ADB] Addr:%lu Cmd:%lu Reg:%lu")                  \
+    X(ADB_TALK,          "[ADB] Talk A%lu R%lu -> 0x%04lX")                 \
+    X(KBD_ADDRESS,       "[KBD] Address changed to %lu")                    \
+    X(KBD_HANDLER,       "[KBD] Handler changed to %lu")                    \
+    X(MOUSE_ADDRESS,     "[MOUSE] Address changed to %lu")                  \
+    X(MOUSE_HANDLER,     "[MOUSE] Handler changed to %lu")                  \
+    X(ADB_COLLISION,     "[ADB] Collision A%lu R%lu (reply 0x%04lX aborted)")
+
+// Binary frame layout (ADB_LOG_BINARY=1), little-endian:
+//   [0xA5][0x5A][token:2][core:1][nargs:1][timestamp_us:4][args:4*nargs][xor:1]
+// The XOR covers every byte after the two sync bytes.
+#define LOG_FRAME_SYNC0 0xA5
+#define LOG_FRAME_SYNC1 0x5A
@@ -0,0 +1,314 @@
+#pragma once
+
+#include <cstdint>
+#include <freertos/FreeRTOS.h>
+#include "config.h"
+
+// ─── Metrics Registry ──────────────────────────────────────────────────────
+// All diagnostic counters, gauges and histograms, declared once at compile
+// time. Counters and histograms are stored per core — each core only writes
+// its own slot, so no increment is ever a cross-core read-modify-write, and
+// a write masks interrupts for a few instructions so tasks and ISRs on the
+// same core cannot tear it. Readers (status task, OLED, serial exporter) take a
+// Snapshot that sums both cores.
+//
+// Gauges are single global words — each gauge has one writer.
+
+// ─── Declarations ───────────────────────────────────────────────────────────
+
+/// Monotonic event counts.
+#define METRIC_COUNTER_LIST(X)                                              \
+    X(ADB_POLLS,              "adb.polls")                                  \
+    X(ADB_TALK_REPLIES,       "adb.talk_replies")                           \
+    X(ADB_CMD_DECODE_ERRORS,  "adb.cmd_decode_err")                         \
+    X(ADB_LISTEN_DECODE_ERRORS, "adb.listen_decode_err")                    \
+    X(ADB_MOUSE_EVENTS,       "adb.mouse_events")                           \
+    X(ADB_ERR_ATTN_RANGE,     "adb.err.attn_range")                         \
+    X(ADB_ERR_SYNC_TIMEOUT,   "adb.err.sync_timeout")                       \
+    X(ADB_ERR_BIT_NO_EDGE,    "adb.err.bit_no_edge")                        \
+    X(ADB_ERR_BIT_GLITCH,     "adb.err.bit_glitch")                         \
+    X(ADB_ERR_BIT_LONG_LOW,   "adb.err.bit_long_low")                       \
+    X(ADB_ERR_LISTEN_NO_DATA, "adb.err.listen_no_data")                     \
+    X(ADB_ERR_LISTEN_START,   "adb.err.listen_start_bit")                   \
+    X(ADB_BIT_LEARN_REJECT,   "adb.bit.learn_reject")                       \
+    X(ADB_GLITCHES_FILTERED,  "adb.glitch.filtered")                        \
+    X(ADB_CORE1_TICK_IRQ,     "adb.c1.tick_irq")                            \
+    X(ADB_CORE1_FOREIGN_IRQ,  "adb.c1.foreign_irq")                         \
+    X(ADB_IDLE_YIELDS,        "adb.idle_yields")                            \
+    X(ADB_YIELD_MISSED,       "adb.yield_missed")                           \
+    X(ADB_PRED_EARLY,         "adb.pred.early")                             \
+    X(ADB_JOB_RUNS,           "adb.jobs.runs")                              \
+    X(ADB_JOB_OVERRUNS,       "adb.jobs.overruns")                          \
+    X(ADB_JOB_COLLISIONS,     "adb.jobs.collisions")                        \
+    X(ADB_WAKE_IRQ,           "adb.wake.irq")                               \
+    X(ADB_WAKE_LATE,          "adb.wake.late")                              \
+    X(ADB_WAKE_TIMEOUTS,      "adb.wake.timeouts")                          \
+    X(ADB_COLLISIONS,         "adb.coll")                                   \
+    X(ADB_COLLISION_BACKOFF,  "adb.coll.backoff")                           \
+    X(ADB_ADDR_MOVES,         "adb.addr.moves")                             \
+    X(ADB_ADDR_HELD,          "adb.addr.held")                              \
+    X(ADB_B_POLLS,            "adb.b.polls")                                \
+    X(ADB_B_REPLIES,          "adb.b.replies")                              \
+    X(ADB_B_LATE,             "adb.b.late")                                 \
+    X(ADB_B_DECODE_ERRORS,    "adb.b.decode_err")                           \
+    X(ADB_B_SRQ,              "adb.b.srq")                                  \
+    X(ADB_B_SRQ_LATE,         "adb.b.srq_late")                             \
+    X(ADB_B_DROPPED,          "adb.b.dropped")                              \
+    X(KVM_SWITCHES,           "kvm.switches")                               \
+    X(TYPE_CHARS,             "type.chars")                                 \
+    X(TYPE_UNMAPPED,          "type.unmapped")                              \
+    X(TYPE_DROPPED,           "type.dropped")                               \
+    X(HID_INJECT_FRAMES,      "inject.frames")                              \
+    X(HID_INJECT_BAD,         "inject.bad")                                 \
+    X(HID_INJECT_SEQ_LOST,    "inject.seq_lost")                            \
+    X(HOST_FOUND,             "host.found")                                 \
+    X(HOST_LOST,              "host.lost")                                  \
+    X(HOST_ACTIVE_TIME_MS,    "host.active_ms")                             \
+    X(HOST_ABSENT_TIME_MS,    "host.absent_ms")                             \
+    X(HOST_DISCARDED,         "host.discarded")                             \
+    X(BLE_CONN_UPDATES,       "ble.conn_updates")                           \
+    X(LED_POSTED,             "led.posted")                                 \
+    X(LED_DROPPED,            "led.dropped")                                \
+    X(LED_COALESCED,          "led.coalesced")                              \
+    X(LED_WRITES,             "led.writes")                                 \
+    X(LED_WRITE_FAIL,         "led.write_fail")                             \
+    X(BLE_KBD_NOTIFY,         "ble.kbd_notify")                             \
+    X(BLE_MOUSE_NOTIFY,       "ble.mouse_notify")                           \
+    X(INPUT_REPORTS,          "input.reports")                              \
+    X(INPUT_RING_FULL,        "input.ring_full")                            \
+    X(INPUT_TRUNCATED,        "input.truncated")                            \
+    X(INPUT_KBD_USED,         "input.kbd_used")                             \
+    X(INPUT_KBD_SHORT,        "input.kbd_short")                            \
+    X(INPUT_MOUSE_SHORT,      "input.mouse_short")                          \
+    X(KBD_QUEUE_DROPS,        "queue.kbd_drops")                            \
+    X(MOUSE_QUEUE_DROPS,      "queue.mouse_drops")                          \
+    X(LOG_RECORDS,            "log.records")                                \
+    X(LOG_DROPPED,            "log.dropped")                                \
+    X(CAPTURE_EDGES,          "capture.edges")                              \
+    X(CAPTURE_DROPPED,        "capture.dropped")                            \
+    X(OLED_FRAMES,            "oled.frames")                                \
+    X(OLED_PAGES_SENT,        "oled.pages_sent")                            \
+    X(OLED_I2C_BYTES,         "oled.i2c_bytes")                             \
+    X(OLED_I2C_ERRORS,        "oled.i2c_errors")
+
+/// Last-written or high-water values.
+#define METRIC_GAUGE_LIST(X)                                                \
+    X(INPUT_RING_HWM,         "input.ring_hwm")                             \
+    X(INPUT_INJECT_RING_HWM,  "input.inject_ring_hwm")                      \
+    X(KBD_QUEUE_HWM,          "queue.kbd_hwm")                              \
+    X(MOUSE_QUEUE_HWM,        "queue.mouse_hwm")                            \
+    X(KBD_QUEUE_HWM_B,        "queue.b.kbd_hwm")                            \
+    X(MOUSE_QUEUE_HWM_B,      "queue.b.mouse_hwm")                          \
+    X(LOG_CYCLES_MAX_CORE0,   "log.cycles_max_c0")                          \
+    X(LOG_CYCLES_MAX_CORE1,   "log.cycles_max_c1")                          \
+    X(STACK_FREE_ADB,         "stack.adb")                                  \
+    X(STACK_FREE_BLE,         "stack.ble")                                  \
+    X(STACK_FREE_INPUT,       "stack.input")                                \
+    X(STACK_FREE_OLED,        "stack.oled")                                 \
+    X(STACK_FREE_LOG,         "stack.log")                                  \
+    X(STACK_FREE_LOOP,        "stack.loop")                                 \
+    X(HEAP_FREE,              "heap.free")                                  \
+    X(HEAP_MIN_FREE,          "heap.min_free")                              \
+    X(CAPTURE_RING_HWM,       "capture.ring_hwm")                           \
+    X(ADB_POLL_PERIOD_US,     "adb.pred.period_us")                         \
+    X(ADB_POLL_BURST,         "adb.pred.burst")                             \
+    X(ADB_PRED_LOCKED,        "adb.pred.locked")                            \
+    X(ADB_BIT_THRESHOLD,      "adb.bit.threshold_us")                       \
+    X(ADB_BIT0_EST_US,        "adb.bit.est0_us")                            \
+    X(ADB_BIT1_EST_US,        "adb.bit.est1_us")                            \
+    X(ADB_B_BIT_THRESHOLD,    "adb.b.bit.threshold_us")                     \
+    X(KVM_FOCUS,              "kvm.focus")                                  \
+    X(TYPE_CPS,               "type.cps")                                   \
+    X(HOST_ACTIVE,            "host.active")
+
+/// Fixed-bucket histograms: X(id, name, scale, base, width).
+/// LOG2 buckets are half-octaves (0, 1, 2, 3, 4, 6, 8, 12, …) — base/width
+/// unused. LINEAR buckets start at base and are width units wide.
+/// Values past the last bucket land in it; the exact max is kept separately.
+#define METRIC_HISTOGRAM_LIST(X)                                            \
+    X(INPUT_CAPTURE_CYCLES,   "input.capture_cyc",  LOG2,   0, 0)           \
+    X(INPUT_WAIT_US,          "input.wait_us",      LOG2,   0, 0)           \
+    X(INPUT_PARSE_CYCLES,     "input.parse_cyc",    LOG2,   0, 0)           \
+    X(KBD_NOTIFY_TO_QUEUE_US, "lat.kbd.notify_q",   LOG2,   0, 0)           \
+    X(KBD_QUEUE_TO_BUFFER_US, "lat.kbd.q_buf",      LOG2,   0, 0)           \
+    X(KBD_BUFFER_TO_WIRE_US,  "lat.kbd.buf_wire",   LOG2,   0, 0)           \
+    X(KBD_END_TO_END_US,      "lat.kbd.total",      LOG2,   0, 0)           \
+    X(MOUSE_NOTIFY_TO_QUEUE_US, "lat.mouse.notify_q", LOG2, 0, 0)           \
+    X(MOUSE_QUEUE_TO_BUFFER_US, "lat.mouse.q_buf",  LOG2,   0, 0)           \
+    X(MOUSE_BUFFER_TO_WIRE_US,  "lat.mouse.buf_wire", LOG2, 0, 0)           \
+    X(MOUSE_END_TO_END_US,    "lat.mouse.total",    LOG2,   0, 0)           \
+    X(ADB_ATTN_US,            "adb.attn_us",        LINEAR, 400, 25)        \
+    X(ADB_SYNC_US,            "adb.sync_us",        LINEAR, 40, 2)          \
+    X(ADB_BIT0_LOW_US,        "adb.bit0_low_us",    LINEAR, 40, 2)          \
+    X(ADB_BIT1_LOW_US,        "adb.bit1_low_us",    LINEAR, 16, 2)          \
+    X(ADB_HOST_TLT_US,        "adb.host_tlt_us",    LINEAR, 100, 8)         \
+    X(ADB_REPLY_TLT_US,       "adb.reply_tlt_us",   LINEAR, 100, 8)         \
+    X(ADB_B_REPLY_TLT_US,     "adb.b.reply_tlt_us", LINEAR, 100, 8)         \
+    X(ADB_B_SRQ_LAT_US,       "adb.b.srq_lat_us",   LINEAR, 0, 4)           \
+    X(ADB_CORE1_STALL_US,     "adb.c1.stall_us",    LOG2,   0, 0)           \
+    X(ADB_PRED_ERR_US,        "adb.pred.err_us",    LOG2,   0, 0)           \
+    X(ADB_WAKE_US,            "adb.wake_us",        LOG2,   0, 0)           \
+    X(HOST_RESUME_MS,         "host.resume_ms",     LOG2,   0, 0)           \
+    X(HOST_AWAY_S,            "host.away_s",        LOG2,   0, 0)           \
+    X(LED_SYNC_US,            "led.sync_us",        LOG2,   0, 0)           \
+    X(OLED_RENDER_US,         "oled.render_us",     LOG2,   0, 0)           \
+    X(OLED_FLUSH_US,          "oled.flush_us",      LOG2,   0, 0)
+
+namespace metrics {
+
+enum class Counter : uint8_t {
+#define METRIC_ENUM(id, name) id,
+    METRIC_COUNTER_LIST(METRIC_ENUM)
+#undef METRIC_ENUM
+    COUNT
+};
+
+enum class Gauge : uint8_t {
+#define METRIC_ENUM(id, name) id,
+    METRIC_GAUGE_LIST(METRIC_ENUM)
+#undef METRIC_ENUM
+    COUNT
+};
+
+enum class Histogram : uint8_t {
+#define METRIC_ENUM(id, name, scale, base, width) id,
+    METRIC_HISTOGRAM_LIST(METRIC_ENUM)
+#undef METRIC_ENUM
+    COUNT
+};
+
+constexpr uint32_t NUM_COUNTERS   = (uint32_t)Counter::COUNT;
+constexpr uint32_t NUM_GAUGES     = (uint32_t)Gauge::COUNT;
+constexpr uint32_t NUM_HISTOGRAMS = (uint32_t)Histogram::COUNT;
+
+enum class Scale : uint8_t { LOG2, LINEAR };
+
+struct HistogramSpec {
+    Scale    scale;
+    uint32_t base;
+    uint32_t width;
+};
+
+constexpr HistogramSpec HISTOGRAM_SPECS[] = {
+#define METRIC_SPEC(id, name, scale, base, width) { Scale::scale, base, width },
+    METRIC_HISTOGRAM_LIST(METRIC_SPEC)
+#undef METRIC_SPEC
+};
+
+// ─── Storage (written via the inline helpers below) ─────────────────────────
+
+namespace detail {
+
+struct HistogramSlot {
+    uint32_t buckets[METRICS_HIST_BUCKETS];
+    uint64_t sum;
+    uint32_t max;
+};
+
+struct CoreSlot {
+    uint32_t      counters[NUM_COUNTERS];
+    HistogramSlot histograms[NUM_HISTOGRAMS];
+};
+
+extern CoreSlot g_cores[2];
+extern volatile uint32_t g_gauges[NUM_GAUGES];
+
+inline uint32_t log2_bucket(uint32_t v) {
+    if (v < 2) return v;
+    uint32_t msb = 31 - __builtin_clz(v);
+    uint32_t idx = (msb << 1) | ((v >> (msb - 1)) & 1);
+    return idx < METRICS_HIST_BUCKETS ? idx : METRICS_HIST_BUCKETS - 1;
+}
+
+inline uint32_t linear_bucket(uint32_t v, uint32_t base, uint32_t width) {
+    if (v < base) return 0;
+    uint32_t idx = (v - base) / width;
+    return idx < METRICS_HIST_BUCKETS ? idx : METRICS_HIST_BUCKETS - 1;
+}
+
+} // namespace detail
+
+// ─── Recording (any core, any context) ──────────────────────────────────────
+
+/// Add to a counter.
+inline void inc(Counter c, uint32_t n = 1) {
+    uint32_t irq = portSET_INTERRUPT_MASK_FROM_ISR();
+    detail::g_cores[xPortGetCoreID()].counters[(uint32_t)c] += n;
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(irq);
+}
+
+/// Set a gauge.
+inline void set(Gauge g, uint32_t value) {
+    detail::g_gauges[(uint32_t)g] = value;
+}
+
+/// Raise a gauge to value if it is higher (high-water mark).
+inline void set_max(Gauge g, uint32_t value) {
+    if (value > detail::g_gauges[(uint32_t)g]) detail::g_gauges[(uint32_t)g] = value;
+}
+
+/// Record one histogram sample.
+inline void record(Histogram h, uint32_t value) {
+    const HistogramSpec& spec = HISTOGRAM_SPECS[(uint32_t)h];
+    uint32_t idx = (spec.scale == Scale::LOG2)
+        ? detail::log2_bucket(value)
+        : detail::linear_bucket(value, spec.base, spec.width);
+
+    uint32_t irq = portSET_INTERRUPT_MASK_FROM_ISR();
+    detail::HistogramSlot& slot = detail::g_cores[xPortGetCoreID()].histograms[(uint32_t)h];
+    slot.buckets[idx]++;
+    slot.sum += value;
+    if (value > slot.max) slot.max = value;
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(irq);
+}
+
+// ─── Snapshot (reader side) ─────────────────────────────────────────────────
+
+/// One histogram, summed over both cores.
+struct HistogramSnapshot {
+    uint32_t count;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t buckets[METRICS_HIST_BUCKETS];
+
+    uint32_t avg() const { return count ? (uint32_t)(sum / count) : 0; }
+};
+
+/// All metrics at one point in time.
+struct Snapshot {
+    uint32_t          taken_ms;
+    uint32_t          counters[NUM_COUNTERS];
+    uint32_t          gauges[NUM_GAUGES];
+    HistogramSnapshot histograms[NUM_HISTOGRAMS];
+
+    uint32_t get(Counter c) const                  { return counters[(uint32_t)c]; }
+    uint32_t get(Gauge g) const                    { return gauges[(uint32_t)g]; }
+    const HistogramSnapshot& get(Histogram h) const { return histograms[(uint32_t)h]; }
+};
+
+/// Read a single counter (both cores) without taking a full snapshot.
+uint32_t read(Counter c);
+
+/// Copy every metric into out. Each histogram's count is derived from its
+/// buckets, so percentiles are always self-consistent.
+void snapshot(Snapshot& out);
+
+/// Estimate a percentile (permille: 500 = p50, 990 = p99) from a histogram
+/// snapshot. Returns the upper edge of the bucket holding that rank,
+/// capped at the recorded max.
+uint32_t percentile(Histogram h, const HistogramSnapshot& hs, uint32_t permille);
+
+/// The same over METRICS_HIST_BUCKETS raw LOG2 buckets (detail::log2_bucket)
+/// kept outside the registry, e.g. the profiler's zones.
+uint32_t log2_percentile(const uint32_t* buckets, uint32_t count, uint32_t max,
+                         uint32_t permille);
+
+/// Metric display names.
+const char* name(Counter c);
+const char* name(Gauge g);
+const char* name(Histogram h);
+
+/// Serial exporter — print every metric in a snapshot.
+void dump(const Snapshot& snap);
+
+} // namespace metrics
@@ -4,7 +4,11 @@
 
 // ─── OLED Display ───────────────────────────────────────────────────────────
 // Status display on Heltec V3's onboard 128x64 SSD1306 OLED.
-// Non-blocking updates at 4Hz on Core 0.
+// Non-blocking updates at 4Hz on Core 0. Each refresh renders into the
+// library framebuffer and sends only the columns that changed since the
+// last frame (see flush() in oled_display.cpp). After startup the BOOT
+// button cycles through dashboard pages: status, latency sparkline, queues,
+// ADB bus timing and BLE link details.
 
 namespace oled_display {
 
@@ -16,20 +20,22 @@ void init();
 void update();
 
 /// Main display task loop — runs on Core 0.
-/// Calls update() at the configured interval.
+/// Calls update() at the configured interval, and immediately when a BOOT
+/// button press selects the next page.
 /// This function never returns.
 void task_loop();
 
 /// Set the ADB bus activity indicator.
 void set_adb_active(bool active);
 
-/// Increment the ADB poll counter.
-void inc_poll_count();
-
-/// Increment the event counter (key/mouse events processed).
-void inc_event_count();
-
 /// Show a centered message on the display (blocking, for init-time use).
 void show_message(const char* line1, const char* line2 = nullptr);
 
+/// Send every page on every refresh instead of only the changed columns.
+/// For comparing I2C load ("oled full" / "oled diff" on the console).
+void set_full_refresh(bool full);
+
+/// True when full-frame refresh is selected.
+bool full_refresh();
+
 } // namespace oled_display
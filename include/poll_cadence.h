@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+#include "config.h"
+
+// ─── Host Poll Cadence ─────────────────────────────────────────────────────
+// Learns the period and phase of the host's poll bursts from attention-edge
+// timestamps. An attention within ADB_BURST_GAP_US of the previous
+// transaction's end continues the current burst (keyboard then mouse,
+// back-to-back); anything later starts a new one. Burst-start intervals
+// feed a period estimate (1/8 steps) that locks once ADB_PRED_LOCK_SAMPLES
+// of them in a row agree within ADB_PRED_TOLERANCE_PCT. An interval of a
+// whole number of periods is bursts we didn't decode and keeps the phase;
+// any other disagreement relearns from the new interval.
+//
+// Header-only and free of Arduino/IDF dependencies so the host-side
+// simulator (tools/adb_pred_sim.cpp) runs the same code as the firmware.
+// Single writer: the ADB task (poll_predictor).
+
+class PollCadence {
+public:
+    /// What an attention edge meant.
+    struct Attention {
+        bool    new_burst;  // false: continues the current burst
+        bool    scored;     // new burst while locked: err_us is valid
+        int32_t err_us;     // burst start minus its prediction
+    };
+
+    /// Feed a valid attention pulse's falling-edge time (µs).
+    Attention on_attention(uint32_t t_us) {
+        Attention a = { true, false, 0 };
+        uint32_t gap = t_us - m_last_end;
+        bool first = !m_have_attn;
+        m_have_attn = true;
+
+        if (!first && gap < ADB_BURST_GAP_US) {
+            m_burst_index++;
+            a.new_burst = false;
+            return a;
+        }
+
+        // Score the prediction for this burst before updating the estimate
+        if (locked()) {
+            a.scored = true;
+            a.err_us = (int32_t)(t_us - m_predicted);
+        }
+
+        uint32_t interval = t_us - m_burst_start;
+        if (!first) {
+            m_burst_prev2 = m_burst_prev;
+            m_burst_prev  = m_burst_index;
+
+            if (m_period_us == 0) {
+                m_period_us = interval;
+            } else if (near(interval, m_period_us, m_period_us)) {
+                m_period_us = (uint32_t)((int32_t)m_period_us +
+                                         ((int32_t)interval - (int32_t)m_period_us) / 8);
+                if (m_agree < ADB_PRED_LOCK_SAMPLES) m_agree++;
+            } else {
+                // A whole number of periods means bursts we didn't decode —
+                // the phase still holds. Anything else: relearn from here.
+                uint32_t k = (interval + m_period_us / 2) / m_period_us;
+                if (k < 2 || !near(interval, k * m_period_us, m_period_us)) {
+                    m_period_us = interval;
+                    m_agree = 0;
+                }
+            }
+        }
+
+        m_burst_start = t_us;
+        m_burst_index = 1;
+        m_predicted   = t_us + m_period_us;
+        return a;
+    }
+
+    /// Mark the end of the current transaction (reply sent, or command handled).
+    void on_transaction_end(uint32_t t_us) {
+        m_last_end = t_us;
+    }
+
+    /// Predicted quiet time from now until the next attention pulse, less
+    /// ADB_JOB_GUARD_US. 0 while unlocked or while the current burst is
+    /// still expected to continue.
+    uint32_t idle_budget_us(uint32_t now_us) const {
+        if (!locked()) return 0;
+
+        // The rest of the burst follows within ADB_BURST_GAP_US — no gap yet
+        if (m_burst_index < burst()) return 0;
+
+        int32_t left = (int32_t)(m_predicted - now_us) - (int32_t)ADB_JOB_GUARD_US;
+        return left > 0 ? (uint32_t)left : 0;
+    }
+
+    /// True once the period estimate has held for ADB_PRED_LOCK_SAMPLES bursts.
+    bool locked() const { return m_agree >= ADB_PRED_LOCK_SAMPLES; }
+
+    /// Burst-start interval estimate (µs), 0 = unknown.
+    uint32_t period_us() const { return m_period_us; }
+
+    /// Commands per burst: the larger of the last two complete bursts.
+    uint32_t burst() const { return m_burst_prev > m_burst_prev2 ? m_burst_prev : m_burst_prev2; }
+
+private:
+    /// |a - b| within ADB_PRED_TOLERANCE_PCT of ref.
+    static bool near(uint32_t a, uint32_t b, uint32_t ref) {
+        uint32_t diff = a > b ? a - b : b - a;
+        return (uint64_t)diff * 100 <= (uint64_t)ref * ADB_PRED_TOLERANCE_PCT;
+    }
+
+    bool     m_have_attn   = false;
+    uint32_t m_last_end    = 0;    // end of the last transaction
+    uint32_t m_burst_start = 0;    // first attention of the current burst
+    uint32_t m_burst_index = 0;    // commands seen so far in this burst
+    uint32_t m_burst_prev  = 0;    // size of the last two complete bursts
+    uint32_t m_burst_prev2 = 0;
+    uint32_t m_period_us   = 0;
+    uint32_t m_agree       = 0;    // consecutive intervals within tolerance
+    uint32_t m_predicted   = 0;    // next burst start, valid while locked
+};
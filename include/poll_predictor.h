@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+
+// ─── Host Poll Predictor and Idle-Gap Jobs ─────────────────────────────────
+// The Mac polls in bursts on a steady cadence: one Talk per burst, or the
+// keyboard then the mouse back-to-back (~200µs apart). The predictor learns
+// the burst period and phase from attention-edge timestamps (PollCadence,
+// include/poll_cadence.h) and, once locked, says how long the bus will
+// stay quiet after the current burst.
+//
+// Bounded background jobs registered with add_job() run from the bus loop
+// only inside that window, each only if its worst-case cost still fits
+// before the next predicted attention pulse minus ADB_JOB_GUARD_US.
+//
+// Everything here runs on Core 1 in the ADB task; results are exported
+// through metrics (adb.pred.*, adb.jobs.*).
+
+namespace poll_predictor {
+
+/// Background job: must be bounded and must not block.
+typedef void (*JobFn)();
+
+/// Register a job with its expected worst-case cost. Call before the bus
+/// loop starts; at most ADB_IDLE_JOBS_MAX jobs.
+void add_job(const char* name, JobFn fn, uint32_t cost_us);
+
+/// Feed a valid attention pulse's falling-edge time (µs). An attention
+/// within ADB_BURST_GAP_US of the previous transaction's end continues the
+/// current burst; anything later starts a new one.
+void on_attention(uint32_t t_us);
+
+/// Mark the end of the current transaction (reply sent, or command handled).
+void on_transaction_end(uint32_t t_us);
+
+/// Predicted quiet time from now until the next attention pulse, less the
+/// guard. 0 while unlocked or while the current burst is still expected to
+/// continue.
+uint32_t idle_budget_us(uint32_t now_us);
+
+/// Run the jobs that fit in the current idle budget, round-robin. Returns
+/// early if the line goes low (the host started a command).
+void run_idle_jobs();
+
+/// True once the period estimate has held for ADB_PRED_LOCK_SAMPLES bursts.
+bool locked();
+
+} // namespace poll_predictor
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+#include <freertos/FreeRTOS.h>
+#include <hal/cpu_hal.h>
+#include "config.h"
+#include "metrics.h"
+
+// ─── Hot-Path Cycle Profiler (ADB_PROFILE=1) ───────────────────────────────
+// Named zones that time a scope in CPU cycles (CCOUNT) and keep count,
+// min, sum, max and a half-octave histogram per zone, bucketed and read
+// with the metrics registry's LOG2 helpers. Zones are written
+// by exactly one core each (ADB zones on Core 1, BLE zones on Core 0), so
+// a record only masks interrupts on its own core for a few instructions.
+//
+// With ADB_PROFILE=0 (the default) PROF_SCOPE compiles to nothing and the
+// profiler adds no code to the hot path. The "prof" console command prints
+// the report.
+
+// ─── Zones ──────────────────────────────────────────────────────────────────
+
+/// Timed zones: X(id, name). ADB zones run on Core 1, BLE zones on Core 0.
+/// adb.irq_off is each interrupts_disable() → interrupts_enable() window.
+#define PROF_ZONE_LIST(X)                                                   \
+    X(ADB_WAIT_ATTN,          "adb.wait_attn")                              \
+    X(ADB_ATTN,               "adb.attn")                                   \
+    X(ADB_DECODE,             "adb.decode")                                 \
+    X(ADB_STOP_BIT,           "adb.stop_bit")                               \
+    X(ADB_HANDLE_TALK,        "adb.handle_talk")                            \
+    X(ADB_KBD_PROCESS_QUEUE,  "adb.kbd_queue")                              \
+    X(ADB_MOUSE_PROCESS_QUEUE, "adb.mouse_queue")                           \
+    X(ADB_TLT_SPIN,           "adb.tlt_spin")                               \
+    X(ADB_SEND_DATA,          "adb.send_data")                              \
+    X(ADB_LISTEN_RX,          "adb.listen_rx")                              \
+    X(ADB_IRQ_OFF,            "adb.irq_off")                                \
+    X(BLE_KBD_CB,             "ble.kbd_cb")                                 \
+    X(BLE_MOUSE_CB,           "ble.mouse_cb")
+
+namespace profiler {
+
+enum class Zone : uint8_t {
+#define PROF_ENUM(id, name) id,
+    PROF_ZONE_LIST(PROF_ENUM)
+#undef PROF_ENUM
+    COUNT
+};
+
+constexpr uint32_t NUM_ZONES = (uint32_t)Zone::COUNT;
+
+// ─── Storage (written via record()) ─────────────────────────────────────────
+
+namespace detail {
+
+struct ZoneSlot {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t buckets[METRICS_HIST_BUCKETS];   // metrics::detail::log2_bucket
+};
+
+extern ZoneSlot g_zones[NUM_ZONES];
+
+} // namespace detail
+
+// ─── Recording ──────────────────────────────────────────────────────────────
+
+inline uint32_t cycles_now() {
+    return cpu_hal_get_cycle_count();
+}
+
+/// Add one sample (in cycles) to a zone.
+inline void record(Zone z, uint32_t cycles) {
+    uint32_t irq = portSET_INTERRUPT_MASK_FROM_ISR();
+    detail::ZoneSlot& s = detail::g_zones[(uint32_t)z];
+    if (s.count == 0 || cycles < s.min) s.min = cycles;
+    if (cycles > s.max) s.max = cycles;
+    s.count++;
+    s.sum += cycles;
+    s.buckets[metrics::detail::log2_bucket(cycles)]++;
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(irq);
+}
+
+/// Times the enclosing scope into a zone.
+class Scope {
+public:
+    explicit Scope(Zone z) : m_zone(z), m_start(cycles_now()) {}
+    ~Scope() { record(m_zone, cycles_now() - m_start); }
+
+private:
+    Zone     m_zone;
+    uint32_t m_start;
+};
+
+// ─── Reporting ──────────────────────────────────────────────────────────────
+
+/// Print every zone with samples: count, min/avg/p50/p99/max in cycles and µs.
+void report();
+
+/// Clear all zones. Diagnostic only — a sample recorded on the other core
+/// during the reset may be half-cleared.
+void reset();
+
+/// Zone display name.
+const char* name(Zone z);
+
+} // namespace profiler
+
+// ─── Instrumentation macros ─────────────────────────────────────────────────
+
+#if ADB_PROFILE
+#define PROF_CONCAT_(a, b) a##b
+#define PROF_CONCAT(a, b)  PROF_CONCAT_(a, b)
+/// Time from here to the end of the enclosing block into the named zone.
+#define PROF_SCOPE(zone) \
+    profiler::Scope PROF_CONCAT(prof_scope_, __LINE__)(profiler::Zone::zone)
+#else
+#define PROF_SCOPE(zone) do {} while (0)
+#endif
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <freertos/FreeRTOS.h>
+
+// ─── Seqlock Snapshot ──────────────────────────────────────────────────────
+// Publishes a small, trivially-copyable struct from one core so readers on
+// either core get a consistent copy without taking a lock. The writer bumps
+// a sequence number to odd, copies the value in, then bumps it to even;
+// a reader copies the value out and retries if the sequence was odd or
+// changed underneath it.
+//
+// Writers must all run on the same core (or publish before the readers
+// start). write() masks interrupts on that core for the copy, so a second
+// writer (or a same-core reader) can never preempt a half-written value —
+// readers only ever retry against the other core, for at most one copy's
+// duration.
+
+template <typename T>
+class Seqlock {
+public:
+    Seqlock() : m_value() {}
+
+    /// Publish a new value (writer core only).
+    void write(const T& value) {
+        uint32_t irq = portSET_INTERRUPT_MASK_FROM_ISR();
+        uint32_t seq = m_seq.load(std::memory_order_relaxed);
+        m_seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(&m_value, &value, sizeof(T));
+        m_seq.store(seq + 2, std::memory_order_release);
+        portCLEAR_INTERRUPT_MASK_FROM_ISR(irq);
+    }
+
+    /// Copy out the latest fully-published value (any core, any task).
+    T read() const {
+        T out;
+        while (true) {
+            uint32_t before = m_seq.load(std::memory_order_acquire);
+            if (before & 1) continue;   // write in progress on the other core
+            memcpy(&out, &m_value, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (m_seq.load(std::memory_order_relaxed) == before) return out;
+        }
+    }
+
+private:
+    std::atomic<uint32_t> m_seq{0};
+    T m_value;
+};
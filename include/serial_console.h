@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+// ─── Serial Console ────────────────────────────────────────────────────────
+// Line-based diagnostic commands typed into the serial monitor. Input is
+// read without blocking from whichever task calls poll(); each complete
+// line is matched against a fixed command table.
+//
+//   help           list commands
+//   metrics        dump the metrics registry now
+//   prof           print the hot-path cycle profile (ADB_PROFILE=1)
+//   prof reset     clear the profile
+//   type <text>    type the text into the focused Mac
+//   paste          type everything sent until Ctrl-D (XON/XOFF paced)
+//   pace <ms>      pause after each typed character (0 = bus rate)
+
+namespace serial_console {
+
+/// Read any pending serial input and run complete command lines.
+/// Never blocks. With ADB_HID_INJECT the serial reader task owns the
+/// port and calls feed() instead.
+void poll();
+
+/// Process one byte of console input.
+void feed(uint8_t byte);
+
+/// Paste mode: every byte is text to type, frames included.
+bool raw_mode();
+
+/// False while pasted text has nowhere to go: leave further input in the
+/// UART buffer until the type task makes room.
+bool accepting();
+
+/// Send XON once a paused paste has drained. poll() calls it; with
+/// ADB_HID_INJECT the serial reader task calls it after each read pass.
+void service();
+
+} // namespace serial_console
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// ─── Single-Producer / Single-Consumer Ring ────────────────────────────────
+// Lock-free, fixed-capacity ring for handing records from exactly one
+// producer context to exactly one consumer context (which may run on the
+// other core). Storage is preallocated inline — no heap, no FreeRTOS calls,
+// safe to use from NimBLE callbacks and the ADB task alike.
+
+template <typename T, uint32_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0,
+                  "SpscRing capacity must be a power of two");
+
+public:
+    /// Reserve the next free slot (producer side).
+    /// Fill it in place, then call commit(). Returns nullptr if full.
+    T* claim() {
+        uint32_t head = m_head.load(std::memory_order_relaxed);
+        uint32_t tail = m_tail.load(std::memory_order_acquire);
+        if (head - tail >= N) return nullptr;
+        return &m_buf[head & (N - 1)];
+    }
+
+    /// Publish the slot returned by the last claim() (producer side).
+    void commit() {
+        m_head.store(m_head.load(std::memory_order_relaxed) + 1,
+                     std::memory_order_release);
+    }
+
+    /// Copy an item into the ring (producer side). Returns false if full.
+    bool push(const T& item) {
+        T* slot = claim();
+        if (!slot) return false;
+        *slot = item;
+        commit();
+        return true;
+    }
+
+    /// Oldest unconsumed item (consumer side), or nullptr if empty.
+    /// The pointer stays valid until pop().
+    const T* front() const {
+        uint32_t tail = m_tail.load(std::memory_order_relaxed);
+        uint32_t head = m_head.load(std::memory_order_acquire);
+        if (head == tail) return nullptr;
+        return &m_buf[tail & (N - 1)];
+    }
+
+    /// Release the item returned by front() (consumer side).
+    void pop() {
+        m_tail.store(m_tail.load(std::memory_order_relaxed) + 1,
+                     std::memory_order_release);
+    }
+
+    /// Copy out and release the oldest item (consumer side).
+    /// Returns false if the ring was empty.
+    bool pop(T& out) {
+        const T* item = front();
+        if (!item) return false;
+        out = *item;
+        pop();
+        return true;
+    }
+
+    /// Number of items currently queued (approximate from either side).
+    uint32_t size() const {
+        return m_head.load(std::memory_order_acquire) -
+               m_tail.load(std::memory_order_acquire);
+    }
+
+    bool empty() const { return size() == 0; }
+
+    static constexpr uint32_t capacity() { return N; }
+
+private:
+    T m_buf[N];
+    std::atomic<uint32_t> m_head{0};   // next slot to write (producer-owned)
+    std::atomic<uint32_t> m_tail{0};   // next slot to read (consumer-owned)
+};
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <cstdint>
+
+// ─── Text → ADB Key Events ─────────────────────────────────────────────────
+// Turns a UTF-8 byte stream into the ADB key events a US keyboard would
+// send to type it: [release bit | 7-bit keycode], the same format as the
+// keyboard's key buffer. Shift is pressed only when the next character
+// needs it and held across a run of shifted characters, so "HELLO" costs
+// one Shift press and release rather than five.
+//
+// Mapped: printable ASCII, Return (CR, LF or CRLF), Tab, Backspace and
+// Escape. Every other code point — non-ASCII included, since the Mac's
+// Option-key sequences depend on its keyboard layout and font — is
+// skipped and counted as unmapped. A malformed UTF-8 sequence counts as
+// one unmapped character.
+//
+// Header-only and free of Arduino/IDF dependencies so the host-side
+// simulator (tools/adb_type_sim.cpp) runs the same code as the firmware.
+// Single user: the text injection task.
+
+class TextEncoder {
+public:
+    /// Most events one feed() or finish() can produce: Shift change,
+    /// key press, key release.
+    static constexpr int MAX_EVENTS = 3;
+
+    static constexpr uint8_t RELEASE   = 0x80;
+    static constexpr uint8_t KEY_SHIFT = 0x38;   // ADB Left Shift
+
+    TextEncoder() { reset(); }
+
+    /// Forget any partial sequence and the Shift state (without releasing
+    /// it: call finish() first if Shift may be down).
+    void reset() {
+        m_cp       = 0;
+        m_need     = 0;
+        m_shift    = false;
+        m_after_cr = false;
+        m_chars    = 0;
+        m_unmapped = 0;
+    }
+
+    /// Feed one byte of text.
+    /// @return Number of events written to `out` (0 while a UTF-8
+    ///         sequence is incomplete, or for an unmapped character).
+    int feed(uint8_t byte, uint8_t* out) {
+        if (byte >= 0x80 && byte < 0xC0) {
+            // Continuation byte
+            if (m_need == 0) {
+                m_unmapped++;
+                return 0;
+            }
+            m_cp = (m_cp << 6) | (byte & 0x3F);
+            if (--m_need) return 0;
+            return emit(m_cp, out);
+        }
+        if (m_need) {
+            // Sequence cut short by a new lead byte
+            m_need = 0;
+            m_unmapped++;
+        }
+        if (byte < 0x80) return emit(byte, out);
+        if (byte >= 0xF8) {
+            m_unmapped++;
+            return 0;
+        }
+        m_need = (byte >= 0xF0) ? 3 : (byte >= 0xE0) ? 2 : 1;
+        m_cp   = byte & (0x3F >> m_need);
+        return 0;
+    }
+
+    /// End of text: release Shift if it is down.
+    /// @return Number of events written to `out` (0 or 1).
+    int finish(uint8_t* out) {
+        if (m_need) {
+            m_need = 0;
+            m_unmapped++;
+        }
+        m_after_cr = false;
+        if (!m_shift) return 0;
+        m_shift = false;
+        out[0] = RELEASE | KEY_SHIFT;
+        return 1;
+    }
+
+    uint32_t chars() const    { return m_chars; }
+    uint32_t unmapped() const { return m_unmapped; }
+
+    /// Key for a code point on a US layout.
+    /// @return false if there is none.
+    static bool lookup(uint32_t cp, uint8_t& keycode, bool& shift) {
+        static const uint8_t LETTERS[26] = {
+            0x00, 0x0B, 0x08, 0x02, 0x0E, 0x03, 0x05, 0x04, 0x22, 0x26,  // a–j
+            0x28, 0x25, 0x2E, 0x2D, 0x1F, 0x23, 0x0C, 0x0F, 0x01, 0x11,  // k–t
+            0x20, 0x09, 0x0D, 0x07, 0x10, 0x06,                          // u–z
+        };
+        // 0x20–0x40 and 0x5B–0x60, 0x7B–0x7E; SH marks a shifted key
+        static constexpr uint8_t SH = 0x80;
+        static const uint8_t PUNCT_20[33] = {
+            0x31,      0x12 | SH, 0x27 | SH, 0x14 | SH,   //   ! " #
+            0x15 | SH, 0x17 | SH, 0x1A | SH, 0x27,        // $ % & '
+            0x19 | SH, 0x1D | SH, 0x1C | SH, 0x18 | SH,   // ( ) * +
+            0x2B,      0x1B,      0x2F,      0x2C,        // , - . /
+            0x1D, 0x12, 0x13, 0x14, 0x15,                 // 0–4
+            0x17, 0x16, 0x1A, 0x1C, 0x19,                 // 5–9
+            0x29 | SH, 0x29,      0x2B | SH, 0x18,        // : ; < =
+            0x2F | SH, 0x2C | SH, 0x13 | SH,              // > ? @
+        };
+        static const uint8_t PUNCT_5B[6] = {
+            0x21, 0x2A, 0x1E, 0x16 | SH, 0x1B | SH, 0x32, // [ \ ] ^ _ `
+        };
+        static const uint8_t PUNCT_7B[4] = {
+            0x21 | SH, 0x2A | SH, 0x1E | SH, 0x32 | SH,   // { | } ~
+        };
+
+        uint8_t k;
+        if (cp >= 'a' && cp <= 'z')        k = LETTERS[cp - 'a'];
+        else if (cp >= 'A' && cp <= 'Z')   k = LETTERS[cp - 'A'] | SH;
+        else if (cp >= 0x20 && cp <= 0x40) k = PUNCT_20[cp - 0x20];
+        else if (cp >= 0x5B && cp <= 0x60) k = PUNCT_5B[cp - 0x5B];
+        else if (cp >= 0x7B && cp <= 0x7E) k = PUNCT_7B[cp - 0x7B];
+        else if (cp == '\r' || cp == '\n') k = 0x24;   // Return
+        else if (cp == '\t')               k = 0x30;   // Tab
+        else if (cp == '\b')               k = 0x33;   // Delete (backspace)
+        else if (cp == 0x1B)               k = 0x35;   // Escape
+        else return false;
+
+        keycode = k & 0x7F;
+        shift   = (k & SH) != 0;
+        return true;
+    }
+
+private:
+    int emit(uint32_t cp, uint8_t* out) {
+        // CRLF is one Return
+        bool after_cr = m_after_cr;
+        m_after_cr = (cp == '\r');
+        if (cp == '\n' && after_cr) return 0;
+
+        uint8_t keycode;
+        bool shift;
+        if (!lookup(cp, keycode, shift)) {
+            m_unmapped++;
+            return 0;
+        }
+
+        int n = 0;
+        if (shift != m_shift) {
+            out[n++] = shift ? KEY_SHIFT : (RELEASE | KEY_SHIFT);
+            m_shift = shift;
+        }
+        out[n++] = keycode;
+        out[n++] = RELEASE | keycode;
+        m_chars++;
+        return n;
+    }
+
+    uint32_t m_cp;          // code point being assembled
+    uint8_t  m_need;        // continuation bytes still expected
+    bool     m_shift;       // Shift is down
+    bool     m_after_cr;    // last character was CR (swallow a following LF)
+    uint32_t m_chars;       // characters typed
+    uint32_t m_unmapped;    // characters skipped
+};
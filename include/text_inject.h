@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include "config.h"
+
+// ─── Text Injection ────────────────────────────────────────────────────────
+// Types text into the focused Mac as if on its keyboard — for pasting
+// config files and BASIC listings into machines whose only input is the
+// bridge. The console writes UTF-8 text into a preallocated ring; the type
+// task on Core 0 turns it into key events (TextEncoder, US layout) and
+// feeds them to the keyboard's event queue as fast as the bus takes them:
+//
+//   - TYPE_QUEUE_DEPTH events are kept in flight (queued or in the
+//     keyboard's buffer), so every Talk R0 reply carries two and SRQ keeps
+//     the host polling the keyboard back-to-back, without burying live
+//     keys behind the text.
+//   - Nothing is dropped between the ring and the wire: the task waits for
+//     queue space, and the keyboard leaves events queued while its own
+//     buffer is full.
+//   - A pace (console 'pace <ms>') pauses after each character for
+//     applications that read the Mac's event queue slowly.
+//
+// Each run of text ends at TYPE_END (Ctrl-D), which releases Shift and
+// prints the achieved rate once the keyboard has sent the last key.
+
+namespace text_inject {
+
+/// Queue text to type (single producer: the console). Bytes that don't
+/// fit in the ring are dropped and counted. The last free byte only takes
+/// TYPE_END, so a run of text can always be ended.
+/// @return Bytes accepted.
+size_t write(const uint8_t* data, size_t length);
+
+/// Free bytes in the ring, the one kept for TYPE_END included.
+size_t space();
+
+/// Pause after each character (ms); 0 = as fast as the bus allows.
+void set_pace_ms(uint32_t ms);
+uint32_t pace_ms();
+
+/// Text queued or still being typed.
+bool busy();
+
+/// Type task loop — runs on Core 0. Sleeps until text is written.
+/// This function never returns.
+void task_loop();
+
+} // namespace text_inject
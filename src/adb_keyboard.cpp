@@ -1,5 +1,10 @@
 #include "adb_keyboard.h"
+#include "adb_device_id.h"
 #include "event_queue.h"
+#include "adb_platform.h"
+#include "deferred_log.h"
+#include "metrics.h"
+#include "profiler.h"
 #include "config.h"
 
 #include <Arduino.h>
@@ -8,14 +13,14 @@ namespace adb_keyboard {
 
 // ─── Internal state ─────────────────────────────────────────────────────────
 
-static uint8_t s_address   = ADB_ADDR_KEYBOARD;  // current address (may change)
-static uint8_t s_handler   = ADB_HANDLER_KEYBOARD;
-
 // Key event ring buffer (holds ADB-formatted key events)
-static constexpr int KEY_BUF_SIZE = 32;
-static uint8_t s_key_buf[KEY_BUF_SIZE];  // each entry: [release_bit | 7-bit keycode]
-static int s_key_head = 0;
-static int s_key_tail = 0;
+static constexpr int KEY_BUF_SIZE = ADB_KEY_BUF_SIZE;
+
+// Trace stamps of the keys in the last Talk R0 reply, until it is on the wire
+struct PendingTrace {
+    uint32_t capture_us;
+    uint32_t buffered_us;
+};
 
 // Register 2: modifier key state (active-low bits)
 // Bit 7: not used (1)
@@ -35,134 +40,222 @@ static int s_key_tail = 0;
 // Bit 2: Caps Lock
 // Bit 1: Delete
 // Bit 0: not used (0)
-static uint16_t s_register2 = 0xFFFF;  // all modifiers released
+
+/// One emulated keyboard. Each bus has its own, touched only by that
+/// bus's engine.
+struct Keyboard {
+    AdbDeviceId id;                             // address / handler (may change during enumeration)
+    uint8_t  key_buf[KEY_BUF_SIZE];             // each entry: [release_bit | 7-bit keycode]
+    uint32_t key_capture_us[KEY_BUF_SIZE];      // latency trace: BLE notification time
+    uint32_t key_buffered_us[KEY_BUF_SIZE];     // latency trace: time moved into key_buf
+    int      key_head;
+    int      key_tail;
+    int      reply_tail;                        // key_tail before the last Talk R0 reply's pops
+    PendingTrace pending[2];
+    int      pending_count;
+    uint16_t register2;                         // 0xFFFF = all modifiers released
+};
+static Keyboard s_kbd[ADB_BUS_COUNT];
+
+// millis() when the first key event went out in a Talk R0 reply (boot metric)
+static uint32_t s_first_key_ms = 0;
 
 // ─── Buffer helpers ─────────────────────────────────────────────────────────
 
-static bool buf_empty() {
-    return s_key_head == s_key_tail;
+static bool buf_empty(const Keyboard& k) {
+    return k.key_head == k.key_tail;
 }
 
-static bool buf_full() {
-    return ((s_key_head + 1) % KEY_BUF_SIZE) == s_key_tail;
+static bool buf_full(const Keyboard& k) {
+    return ((k.key_head + 1) % KEY_BUF_SIZE) == k.key_tail;
 }
 
-static void buf_push(uint8_t key_event) {
-    if (!buf_full()) {
-        s_key_buf[s_key_head] = key_event;
-        s_key_head = (s_key_head + 1) % KEY_BUF_SIZE;
+static void buf_push(Keyboard& k, uint8_t key_event, uint32_t capture_us, uint32_t buffered_us) {
+    if (!buf_full(k)) {
+        k.key_buf[k.key_head] = key_event;
+        k.key_capture_us[k.key_head] = capture_us;
+        k.key_buffered_us[k.key_head] = buffered_us;
+        k.key_head = (k.key_head + 1) % KEY_BUF_SIZE;
     }
 }
 
-static uint8_t buf_pop() {
-    uint8_t val = s_key_buf[s_key_tail];
-    s_key_tail = (s_key_tail + 1) % KEY_BUF_SIZE;
+/// Pop one key event and remember its trace stamps for trace_reply_sent().
+static uint8_t buf_pop(Keyboard& k) {
+    uint8_t val = k.key_buf[k.key_tail];
+    if (k.pending_count < 2) {
+        k.pending[k.pending_count].capture_us  = k.key_capture_us[k.key_tail];
+        k.pending[k.pending_count].buffered_us = k.key_buffered_us[k.key_tail];
+        k.pending_count++;
+    }
+    k.key_tail = (k.key_tail + 1) % KEY_BUF_SIZE;
     return val;
 }
 
 // ─── Public interface ───────────────────────────────────────────────────────
 
-void init() {
-    s_address = ADB_ADDR_KEYBOARD;
-    s_handler = ADB_HANDLER_KEYBOARD;
-    s_key_head = 0;
-    s_key_tail = 0;
-    s_register2 = 0xFFFF;
+void init(uint8_t bus) {
+    Keyboard& k = s_kbd[bus];
+    k.id.reset(ADB_ADDR_KEYBOARD, ADB_HANDLER_KEYBOARD);
+    k.key_head = 0;
+    k.key_tail = 0;
+    k.reply_tail = 0;
+    k.pending_count = 0;
+    k.register2 = 0xFFFF;
 }
 
-bool handle_talk(uint8_t reg, uint16_t& data) {
+bool handle_talk(uint8_t bus, uint8_t reg, uint16_t& data) {
+    Keyboard& k = s_kbd[bus];
     switch (reg) {
         case 0: {
             // Register 0: key data — up to 2 key events
-            process_queue();
+            process_queue(bus);
 
-            if (buf_empty()) return false;
+            if (buf_empty(k)) return false;
 
-            uint8_t key1 = buf_pop();
-            uint8_t key2 = buf_empty() ? 0xFF : buf_pop();  // 0xFF = no second key
+            k.pending_count = 0;
+            k.reply_tail = k.key_tail;
+            uint8_t key1 = buf_pop(k);
+            uint8_t key2 = buf_empty(k) ? 0xFF : buf_pop(k);  // 0xFF = no second key
 
             data = ((uint16_t)key1 << 8) | key2;
+            if (!s_first_key_ms) s_first_key_ms = millis();
             return true;
         }
 
         case 2:
             // Register 2: modifier key state + LED state
-            data = s_register2;
+            data = k.register2;
             return true;
 
-        case 3: {
-            // Register 3: device info
-            // Byte 0: [exceptional_event(0) | srq_enable(1) | 2-bit reserved(01) | 4-bit address]
-            // Byte 1: handler ID
-            uint8_t byte0 = 0x60 | (s_address & 0x0F);  // SRQ enabled, no exceptional event
-            data = ((uint16_t)byte0 << 8) | s_handler;
+        case 3:
+            // Register 3: device info (random address, see adb_device_id.h)
+            data = k.id.talk_r3((uint8_t)esp_random());
             return true;
-        }
 
         default:
             return false;
     }
 }
 
-void handle_listen(uint8_t reg, uint16_t data) {
+void handle_listen(uint8_t bus, uint8_t reg, uint16_t data) {
+    Keyboard& k = s_kbd[bus];
     switch (reg) {
-        case 2:
-            // Host writing LED state / modifier state
-            s_register2 = data;
+        case 2: {
+            // Host writing LED state / modifier state. LED bits are low =
+            // lit; hand changes to the BLE task for the real keyboard.
+            uint16_t changed = (k.register2 ^ data) & 0x07;
+            k.register2 = data;
+            if (changed) {
+                LedEvent evt;
+                evt.leds        = (uint8_t)(~data & 0x07);
+                evt.t_posted_us = adb_platform::micros_now();
+                event_queue::post_leds(bus, evt);
+            }
             break;
+        }
 
-        case 3: {
+        case 3:
             // Host writing new address / handler ID (enumeration)
-            uint8_t new_addr = data >> 8;
-            uint8_t new_handler = data & 0xFF;
-
-            // Address change request
-            if (new_addr != 0 && new_addr != 0xFE) {
-                s_address = new_addr & 0x0F;
+            switch (k.id.listen_r3(data)) {
+                case AdbDeviceId::ListenResult::MOVED:
+                    metrics::inc(metrics::Counter::ADB_ADDR_MOVES);
 #if ADB_DEBUG_VERBOSE
-                Serial.printf("[KBD] Address changed to %d\n", s_address);
+                    DLOG(KBD_ADDRESS, k.id.address());
 #endif
-            }
-
-            // Handler change
-            if (new_handler != 0 && new_handler != 0xFE) {
-                s_handler = new_handler;
+                    break;
+                case AdbDeviceId::ListenResult::HELD:
+                    metrics::inc(metrics::Counter::ADB_ADDR_HELD);
+                    break;
+                case AdbDeviceId::ListenResult::HANDLER:
 #if ADB_DEBUG_VERBOSE
-                Serial.printf("[KBD] Handler changed to %d\n", s_handler);
+                    DLOG(KBD_HANDLER, k.id.handler());
 #endif
+                    break;
+                default:
+                    break;
             }
             break;
-        }
 
         default:
             break;
     }
 }
 
-void handle_flush() {
-    s_key_head = 0;
-    s_key_tail = 0;
+void handle_flush(uint8_t bus) {
+    s_kbd[bus].key_head = 0;
+    s_kbd[bus].key_tail = 0;
 }
 
-void handle_reset() {
-    init();
+void handle_reset(uint8_t bus) {
+    init(bus);
 }
 
-bool has_data() {
-    return !buf_empty() || event_queue::kbd_pending();
+void discard(uint8_t bus) {
+    Keyboard& k = s_kbd[bus];
+    KbdEvent evt;
+    while (event_queue::receive_kbd(bus, evt)) {}
+    k.key_head = k.key_tail = 0;
+    k.pending_count = 0;
 }
 
-uint8_t current_address() {
-    return s_address;
+bool has_data(uint8_t bus) {
+    return !buf_empty(s_kbd[bus]) || event_queue::kbd_pending(bus);
 }
 
-void process_queue() {
+uint32_t buffered(uint8_t bus) {
+    const Keyboard& k = s_kbd[bus];
+    return (uint32_t)(k.key_head - k.key_tail + KEY_BUF_SIZE) % KEY_BUF_SIZE;
+}
+
+uint8_t current_address(uint8_t bus) {
+    return s_kbd[bus].id.address();
+}
+
+void reply_collided(uint8_t bus, uint8_t reg) {
+    Keyboard& k = s_kbd[bus];
+    if (reg == 0) {
+        // Put the popped keys back; nothing was pushed since handle_talk()
+        k.key_tail = k.reply_tail;
+        k.pending_count = 0;
+    } else if (reg == 3) {
+        k.id.reply_collided();
+    }
+}
+
+uint32_t get_first_key_ms() {
+    return s_first_key_ms;
+}
+
+static void drain_queue(uint8_t bus) {
+    Keyboard& k = s_kbd[bus];
     KbdEvent evt;
-    while (event_queue::receive_kbd(evt)) {
+    // Stop at a full buffer: the rest waits in the queue, where the sender
+    // sees back-pressure (and counts a drop) instead of keys vanishing here
+    while (!buf_full(k) && event_queue::receive_kbd(bus, evt)) {
         // Format: bit 7 = release flag, bits 6:0 = ADB keycode
         uint8_t adb_event = (evt.released ? 0x80 : 0x00) | (evt.adb_keycode & 0x7F);
-        buf_push(adb_event);
+        uint32_t now = adb_platform::micros_now();
+        metrics::record(metrics::Histogram::KBD_QUEUE_TO_BUFFER_US, now - evt.t_queued_us);
+        buf_push(k, adb_event, evt.t_capture_us, now);
+    }
+}
+
+void process_queue(uint8_t bus) {
+    if (bus == 0) {
+        PROF_SCOPE(ADB_KBD_PROCESS_QUEUE);     // profiler zones are Core 1's: bus 0 only
+        drain_queue(bus);
+    } else {
+        drain_queue(bus);
+    }
+}
+
+void trace_reply_sent(uint8_t bus, uint32_t wire_us) {
+    Keyboard& k = s_kbd[bus];
+    for (int i = 0; i < k.pending_count; i++) {
+        metrics::record(metrics::Histogram::KBD_BUFFER_TO_WIRE_US, wire_us - k.pending[i].buffered_us);
+        metrics::record(metrics::Histogram::KBD_END_TO_END_US, wire_us - k.pending[i].capture_us);
     }
+    k.pending_count = 0;
 }
 
 } // namespace adb_keyboard
@@ -1,5 +1,10 @@
 #include "adb_mouse.h"
+#include "adb_device_id.h"
 #include "event_queue.h"
+#include "adb_platform.h"
+#include "deferred_log.h"
+#include "metrics.h"
+#include "profiler.h"
 #include "config.h"
 
 #include <Arduino.h>
@@ -8,16 +13,33 @@ namespace adb_mouse {
 
 // ─── Internal state ─────────────────────────────────────────────────────────
 
-static uint8_t s_address = ADB_ADDR_MOUSE;
-static uint8_t s_handler = ADB_HANDLER_MOUSE;
-
-// Accumulated movement deltas (signed, accumulate between polls)
-static int16_t s_accum_dx = 0;
-static int16_t s_accum_dy = 0;
-
-// Button state: ADB uses 1=released, 0=pressed (inverted from USB)
-static bool s_button_pressed = false;
-static bool s_button_changed = false;
+/// One emulated mouse. Each bus has its own, touched only by that bus's
+/// engine.
+struct Mouse {
+    AdbDeviceId id;             // address / handler (may change during enumeration)
+
+    // Accumulated movement deltas (signed, accumulate between polls,
+    // saturating at ±ADB_MOUSE_ACCUM_MAX)
+    int16_t accum_dx;
+    int16_t accum_dy;
+
+    // Button state: ADB uses 1=released, 0=pressed (inverted from USB)
+    bool button_pressed;
+    bool button_changed;
+
+    // What the last Talk R0 reply took out of the accumulators (restored on collision)
+    int8_t reply_dx;
+    int8_t reply_dy;
+    bool   reply_button;
+
+    // Latency trace: stamps of the oldest event not yet fully reported.
+    // Deltas are merged, so one reply is attributed to its oldest contributor.
+    bool     trace_valid;
+    uint32_t trace_capture_us;
+    uint32_t trace_buffered_us;
+    bool     trace_in_reply;    // last R0 reply carries the trace
+};
+static Mouse s_mouse[ADB_BUS_COUNT];
 
 // ─── Helpers ────────────────────────────────────────────────────────────────
 
@@ -28,117 +50,194 @@ static int8_t clamp7(int16_t val) {
     return (int8_t)val;
 }
 
+/// Add a delta to an accumulator, saturating at ±ADB_MOUSE_ACCUM_MAX — a
+/// host that stops polling must not wrap it around.
+static int16_t accumulate(int16_t accum, int16_t delta) {
+    int32_t sum = (int32_t)accum + delta;
+    if (sum > ADB_MOUSE_ACCUM_MAX) return ADB_MOUSE_ACCUM_MAX;
+    if (sum < -ADB_MOUSE_ACCUM_MAX) return -ADB_MOUSE_ACCUM_MAX;
+    return (int16_t)sum;
+}
+
 // ─── Public interface ───────────────────────────────────────────────────────
 
-void init() {
-    s_address = ADB_ADDR_MOUSE;
-    s_handler = ADB_HANDLER_MOUSE;
-    s_accum_dx = 0;
-    s_accum_dy = 0;
-    s_button_pressed = false;
-    s_button_changed = false;
+void init(uint8_t bus) {
+    Mouse& m = s_mouse[bus];
+    m.id.reset(ADB_ADDR_MOUSE, ADB_HANDLER_MOUSE);
+    m.accum_dx = 0;
+    m.accum_dy = 0;
+    m.button_pressed = false;
+    m.button_changed = false;
+    m.reply_dx = 0;
+    m.reply_dy = 0;
+    m.reply_button = false;
+    m.trace_valid = false;
+    m.trace_in_reply = false;
 }
 
-bool handle_talk(uint8_t reg, uint16_t& data) {
+bool handle_talk(uint8_t bus, uint8_t reg, uint16_t& data) {
+    Mouse& m = s_mouse[bus];
     switch (reg) {
         case 0: {
             // Register 0: mouse data
             // [button(1=up)][7-bit Y delta][1][7-bit X delta]
-            process_queue();
+            process_queue(bus);
 
-            if (s_accum_dx == 0 && s_accum_dy == 0 && !s_button_changed) {
+            if (m.accum_dx == 0 && m.accum_dy == 0 && !m.button_changed) {
                 return false;  // no movement, no button change
             }
 
             // Clamp deltas to 7-bit signed range
-            int8_t dx = clamp7(s_accum_dx);
-            int8_t dy = clamp7(s_accum_dy);
+            int8_t dx = clamp7(m.accum_dx);
+            int8_t dy = clamp7(m.accum_dy);
 
             // Subtract what we're reporting (remainder carries forward)
-            s_accum_dx -= dx;
-            s_accum_dy -= dy;
-            s_button_changed = false;
+            m.accum_dx -= dx;
+            m.accum_dy -= dy;
+            m.reply_dx = dx;
+            m.reply_dy = dy;
+            m.reply_button = m.button_changed;
+            m.button_changed = false;
 
             // Pack into ADB mouse format:
             // Byte 0: [button][Y6..Y0]  — button: 1=released, 0=pressed
             // Byte 1: [1][X6..X0]       — bit 7 always 1 (reserved / 2nd button released)
-            uint8_t button_bit = s_button_pressed ? 0x00 : 0x80;  // invert for ADB
+            uint8_t button_bit = m.button_pressed ? 0x00 : 0x80;  // invert for ADB
             uint8_t byte0 = button_bit | (dy & 0x7F);
             uint8_t byte1 = 0x80 | (dx & 0x7F);  // bit 7 = 1 (2nd button released)
 
             data = ((uint16_t)byte0 << 8) | byte1;
+            m.trace_in_reply = m.trace_valid;
             return true;
         }
 
-        case 3: {
-            // Register 3: device info
-            uint8_t byte0 = 0x60 | (s_address & 0x0F);  // SRQ enabled
-            data = ((uint16_t)byte0 << 8) | s_handler;
+        case 3:
+            // Register 3: device info (random address, see adb_device_id.h)
+            data = m.id.talk_r3((uint8_t)esp_random());
             return true;
-        }
 
         default:
             return false;
     }
 }
 
-void handle_listen(uint8_t reg, uint16_t data) {
+void handle_listen(uint8_t bus, uint8_t reg, uint16_t data) {
+    Mouse& m = s_mouse[bus];
     if (reg == 3) {
         // Address / handler change (enumeration)
-        uint8_t new_addr = data >> 8;
-        uint8_t new_handler = data & 0xFF;
-
-        if (new_addr != 0 && new_addr != 0xFE) {
-            s_address = new_addr & 0x0F;
+        switch (m.id.listen_r3(data)) {
+            case AdbDeviceId::ListenResult::MOVED:
+                metrics::inc(metrics::Counter::ADB_ADDR_MOVES);
 #if ADB_DEBUG_VERBOSE
-            Serial.printf("[MOUSE] Address changed to %d\n", s_address);
+                DLOG(MOUSE_ADDRESS, m.id.address());
 #endif
-        }
-        if (new_handler != 0 && new_handler != 0xFE) {
-            s_handler = new_handler;
+                break;
+            case AdbDeviceId::ListenResult::HELD:
+                metrics::inc(metrics::Counter::ADB_ADDR_HELD);
+                break;
+            case AdbDeviceId::ListenResult::HANDLER:
 #if ADB_DEBUG_VERBOSE
-            Serial.printf("[MOUSE] Handler changed to %d\n", s_handler);
+                DLOG(MOUSE_HANDLER, m.id.handler());
 #endif
+                break;
+            default:
+                break;
         }
     }
 }
 
-void handle_flush() {
-    s_accum_dx = 0;
-    s_accum_dy = 0;
-    s_button_changed = false;
+void handle_flush(uint8_t bus) {
+    Mouse& m = s_mouse[bus];
+    m.accum_dx = 0;
+    m.accum_dy = 0;
+    m.button_changed = false;
+    m.trace_valid = false;
 }
 
-void handle_reset() {
-    init();
+void handle_reset(uint8_t bus) {
+    init(bus);
 }
 
-bool has_data() {
-    return (s_accum_dx != 0) || (s_accum_dy != 0) || s_button_changed
-           || event_queue::mouse_pending();
+void discard(uint8_t bus) {
+    Mouse& m = s_mouse[bus];
+    MouseEvent evt;
+    while (event_queue::receive_mouse(bus, evt)) {}
+    handle_flush(bus);
+    m.button_pressed = false;
+    m.trace_in_reply = false;
 }
 
-uint8_t current_address() {
-    return s_address;
+bool has_data(uint8_t bus) {
+    const Mouse& m = s_mouse[bus];
+    return (m.accum_dx != 0) || (m.accum_dy != 0) || m.button_changed
+           || event_queue::mouse_pending(bus);
 }
 
-static volatile uint32_t s_events_from_queue = 0;
+uint8_t current_address(uint8_t bus) {
+    return s_mouse[bus].id.address();
+}
+
+void reply_collided(uint8_t bus, uint8_t reg) {
+    Mouse& m = s_mouse[bus];
+    if (reg == 0) {
+        // Give the reported motion back; it goes out with the next reply
+        m.accum_dx += m.reply_dx;
+        m.accum_dy += m.reply_dy;
+        if (m.reply_button) m.button_changed = true;
+        m.trace_in_reply = false;
+    } else if (reg == 3) {
+        m.id.reply_collided();
+    }
+}
 
-void process_queue() {
+static void drain_queue(uint8_t bus) {
+    Mouse& m = s_mouse[bus];
     MouseEvent evt;
-    while (event_queue::receive_mouse(evt)) {
-        s_accum_dx += evt.dx;
-        s_accum_dy += evt.dy;
-        s_events_from_queue++;
+    while (event_queue::receive_mouse(bus, evt)) {
+        uint32_t now = adb_platform::micros_now();
+        metrics::record(metrics::Histogram::MOUSE_QUEUE_TO_BUFFER_US, now - evt.t_queued_us);
+
+        m.accum_dx = accumulate(m.accum_dx, evt.dx);
+        m.accum_dy = accumulate(m.accum_dy, evt.dy);
+        metrics::inc(metrics::Counter::ADB_MOUSE_EVENTS);
 
         bool new_button = evt.button;
-        if (new_button != s_button_pressed) {
-            s_button_pressed = new_button;
-            s_button_changed = true;
+        bool button_edge = (new_button != m.button_pressed);
+        if (button_edge) {
+            m.button_pressed = new_button;
+            m.button_changed = true;
+        }
+
+        // Start a trace at the first event that gives the host something to report
+        if (!m.trace_valid && (evt.dx != 0 || evt.dy != 0 || button_edge)) {
+            m.trace_valid = true;
+            m.trace_capture_us = evt.t_capture_us;
+            m.trace_buffered_us = now;
         }
     }
 }
 
-uint32_t get_queue_events() { return s_events_from_queue; }
+void process_queue(uint8_t bus) {
+    if (bus == 0) {
+        PROF_SCOPE(ADB_MOUSE_PROCESS_QUEUE);   // profiler zones are Core 1's: bus 0 only
+        drain_queue(bus);
+    } else {
+        drain_queue(bus);
+    }
+}
+
+void trace_reply_sent(uint8_t bus, uint32_t wire_us) {
+    Mouse& m = s_mouse[bus];
+    if (!m.trace_in_reply) return;
+    m.trace_in_reply = false;
+
+    metrics::record(metrics::Histogram::MOUSE_BUFFER_TO_WIRE_US, wire_us - m.trace_buffered_us);
+    metrics::record(metrics::Histogram::MOUSE_END_TO_END_US, wire_us - m.trace_capture_us);
+
+    // Remainder carried to the next reply keeps the same (older) stamps
+    if (m.accum_dx == 0 && m.accum_dy == 0 && !m.button_changed) {
+        m.trace_valid = false;
+    }
+}
 
 } // namespace adb_mouse
@@ -1,9 +1,20 @@
 #include "adb_platform.h"
 #include "config.h"
+#include "metrics.h"
+#include "profiler.h"
+#include "glitch_filter.h"
 
 #include <Arduino.h>
 #include <soc/gpio_struct.h>
 #include <esp_timer.h>
+#if ADB_ATTN_IRQ || ADB_DEDICATED_GPIO
+#include <driver/gpio.h>
+#include <hal/gpio_ll.h>
+#endif
+#if ADB_DEDICATED_GPIO
+#include <driver/dedic_gpio.h>
+#include <hal/dedic_gpio_cpu_ll.h>
+#endif
 
 // GPIO48 is in the upper bank (GPIOs 32-48).
 // Register offset bit = 48 - 32 = 16.
@@ -11,26 +22,84 @@
 
 namespace adb_platform {
 
+// ─── Pin access backends ────────────────────────────────────────────────────
+
+/// GPIO matrix registers: every access is a load/store over the peripheral
+/// bus, tens of cycles with some variation.
+struct RegisterPin {
+    static inline __attribute__((always_inline)) void low() {
+        GPIO.out1_w1tc.val = ADB_PIN_BITMASK;
+    }
+    static inline __attribute__((always_inline)) void high() {
+        GPIO.out1_w1ts.val = ADB_PIN_BITMASK;
+    }
+    static inline __attribute__((always_inline)) bool read() {
+        return (GPIO.in1.val & ADB_PIN_BITMASK) != 0;
+    }
+};
+
+#if ADB_DEDICATED_GPIO
+static dedic_gpio_bundle_handle_t s_bundle = nullptr;
+static uint32_t s_dedic_out = 0;    // bundle channel masks, set by bind_core()
+static uint32_t s_dedic_in  = 0;
+
+/// Dedicated-GPIO CPU instructions (ee.wr_mask_gpio_out / ee.get_gpio_in):
+/// a single instruction each, but only on the core that created the bundle.
+struct DedicatedPin {
+    static inline __attribute__((always_inline)) void low() {
+        dedic_gpio_cpu_ll_write_mask(s_dedic_out, 0);
+    }
+    static inline __attribute__((always_inline)) void high() {
+        dedic_gpio_cpu_ll_write_mask(s_dedic_out, s_dedic_out);
+    }
+    static inline __attribute__((always_inline)) bool read() {
+        return (dedic_gpio_cpu_ll_read_in() & s_dedic_in) != 0;
+    }
+};
+
+typedef DedicatedPin Pin;
+#else
+typedef RegisterPin Pin;
+#endif
+
 void init() {
     // Configure GPIO48 as open-drain output with internal pull-up disabled
     // (external 1kΩ pull-up is used on the ADB side of the level shifter)
     pinMode(ADB_DATA_PIN, OUTPUT_OPEN_DRAIN);
-    release();  // start with line released (high via pull-up)
+    RegisterPin::high();  // start with line released (high via pull-up)
 }
 
+#if ADB_GLITCH_FILTER
+/// GlitchFilter's view of the pin: glitches go to adb.glitch.filtered.
+struct FilterIo {
+    static inline __attribute__((always_inline)) bool read() { return Pin::read(); }
+    static inline __attribute__((always_inline)) uint32_t now() { return micros_now(); }
+    static inline __attribute__((always_inline)) void glitch() {
+        metrics::inc(metrics::Counter::ADB_GLITCHES_FILTERED);
+    }
+};
+
+static GlitchFilter<FilterIo> s_filter;
+#endif
+
 void IRAM_ATTR drive_low() {
     // Set output low — actively pulls the line down
-    GPIO.out1_w1tc.val = ADB_PIN_BITMASK;
+    Pin::low();
+#if ADB_GLITCH_FILTER
+    s_filter.forget();              // the filter never saw this edge
+#endif
 }
 
 void IRAM_ATTR release() {
     // Set output high — open-drain means high-Z, pull-up brings line high
-    GPIO.out1_w1ts.val = ADB_PIN_BITMASK;
+    Pin::high();
+#if ADB_GLITCH_FILTER
+    s_filter.forget();
+#endif
 }
 
 bool IRAM_ATTR read_pin() {
-    // Enable input on the pin (ESP32-S3 needs input enabled to read)
-    return (GPIO.in1.val & ADB_PIN_BITMASK) != 0;
+    return Pin::read();
 }
 
 uint32_t IRAM_ATTR micros_now() {
@@ -44,39 +113,234 @@ void IRAM_ATTR delay_us(uint32_t us) {
     }
 }
 
+
 uint32_t IRAM_ATTR wait_for_state(bool state, uint32_t timeout_us) {
+#if ADB_GLITCH_FILTER
+    return s_filter.wait_for_state(state, timeout_us);
+#else
     uint32_t start = micros_now();
-    while (read_pin() != state) {
+    while (Pin::read() != state) {
         uint32_t elapsed = micros_now() - start;
         if (elapsed >= timeout_us) {
             return 0;  // timed out
         }
     }
     return micros_now() - start;
+#endif
+}
+
+static TickType_t s_stall_tick = 0;    // RTOS tick of the last counted stall
+
+static void IRAM_ATTR note_stall(uint32_t us) {
+    TickType_t tick = xTaskGetTickCount();
+    if (tick != s_stall_tick) {
+        s_stall_tick = tick;
+        metrics::inc(metrics::Counter::ADB_CORE1_TICK_IRQ);
+    } else {
+        metrics::inc(metrics::Counter::ADB_CORE1_FOREIGN_IRQ);
+    }
+    metrics::record(metrics::Histogram::ADB_CORE1_STALL_US, us);
+}
+
+uint32_t IRAM_ATTR wait_for_state_watch(bool state, uint32_t timeout_us) {
+    uint32_t start = micros_now();
+    uint32_t prev  = start;
+    while (true) {
+        while (Pin::read() != state) {
+            uint32_t now = micros_now();
+            if (now - prev >= ADB_STALL_MIN_US) {
+                note_stall(now - prev);
+            }
+            prev = now;
+            if (now - start >= timeout_us) {
+                return 0;  // timed out
+            }
+        }
+#if ADB_GLITCH_FILTER
+        uint32_t edge = micros_now();
+        if (!GlitchFilter<FilterIo>::confirm(state, edge)) {
+            prev = micros_now();    // the confirm spin is not a stall
+            continue;
+        }
+        s_filter.note_edge(state, edge);
+#endif
+        return micros_now() - start;
+    }
 }
 
 uint32_t IRAM_ATTR measure_pulse(bool state, uint32_t timeout_us) {
+#if ADB_GLITCH_FILTER
+    return s_filter.measure_pulse(state, timeout_us);
+#else
     // Verify the line is currently in the expected state
-    if (read_pin() != state) {
+    if (Pin::read() != state) {
         return 0;
     }
 
     uint32_t start = micros_now();
-    while (read_pin() == state) {
+    while (Pin::read() == state) {
         uint32_t elapsed = micros_now() - start;
         if (elapsed >= timeout_us) {
             return elapsed;  // still in state at timeout
         }
     }
     return micros_now() - start;
+#endif
 }
 
+#if ADB_PROFILE
+static uint32_t s_irq_off_cycles = 0;   // CCOUNT at the last interrupts_disable()
+#endif
+
 void IRAM_ATTR interrupts_disable() {
     portDISABLE_INTERRUPTS();
+#if ADB_PROFILE
+    s_irq_off_cycles = profiler::cycles_now();
+#endif
 }
 
 void IRAM_ATTR interrupts_enable() {
+#if ADB_PROFILE
+    profiler::record(profiler::Zone::ADB_IRQ_OFF, profiler::cycles_now() - s_irq_off_cycles);
+#endif
+    portENABLE_INTERRUPTS();
+}
+
+// ─── Attention wake interrupt ───────────────────────────────────────────────
+
+#if ADB_ATTN_IRQ
+static TaskHandle_t       s_wake_task = nullptr;
+static volatile uint32_t  s_edge_us   = 0;
+
+static void IRAM_ATTR attn_isr(void*) {
+    // One-shot: the command's bit cells that follow must not fire again
+    gpio_ll_intr_disable(&GPIO, (gpio_num_t)ADB_DATA_PIN);
+    s_edge_us = micros_now();
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(s_wake_task, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+void attn_irq_init() {
+    s_wake_task = xTaskGetCurrentTaskHandle();
+    gpio_set_intr_type((gpio_num_t)ADB_DATA_PIN, GPIO_INTR_NEGEDGE);
+    gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+    gpio_isr_handler_add((gpio_num_t)ADB_DATA_PIN, attn_isr, nullptr);
+    gpio_intr_disable((gpio_num_t)ADB_DATA_PIN);
+}
+
+/// Not IRAM_ATTR: it blocks in the scheduler and the GPIO driver, and only
+/// the ADB task calls it, never with the cache off.
+uint32_t sleep_until_low(uint32_t timeout_ms) {
+#if ADB_GLITCH_FILTER
+    s_filter.forget();              // the line moves while we sleep
+#endif
+    ulTaskNotifyTake(pdTRUE, 0);    // drop a wake left over from a late edge
+    gpio_ll_clear_intr_status_high(&GPIO, ADB_PIN_BITMASK);
+    gpio_intr_enable((gpio_num_t)ADB_DATA_PIN);
+
+    // An edge between the caller's last read and arming was never latched
+    if (!read_pin()) {
+        gpio_intr_disable((gpio_num_t)ADB_DATA_PIN);
+        return micros_now();
+    }
+
+    if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeout_ms)) != 0) {
+        return s_edge_us;
+    }
+
+    // Timed out — but the edge may have fired just before disarming
+    gpio_intr_disable((gpio_num_t)ADB_DATA_PIN);
+    if (ulTaskNotifyTake(pdTRUE, 0) != 0) {
+        return s_edge_us;
+    }
+    return 0;
+}
+#else
+void attn_irq_init() {}
+uint32_t sleep_until_low(uint32_t) { return 0; }
+#endif
+
+// ─── Core binding and pin-access benchmark ──────────────────────────────────
+
+/// Time one backend on this core with interrupts off: a bare read, one
+/// wait_for_state() sample (read + timestamp), and the falling edge from
+/// the low() write until read() sees it. The spread of the latter is the
+/// edge jitter the backend adds. Drives the bus, so self-test builds only.
+template <typename P>
+static void io_benchmark(const char* label) {
+    uint32_t mhz = getCpuFrequencyMhz();
+
+    portDISABLE_INTERRUPTS();
+    uint32_t t0 = profiler::cycles_now();
+    for (uint32_t i = 0; i < ADB_IO_BENCH_SAMPLES; i++) {
+        (void)P::read();
+    }
+    uint32_t read_cyc = (profiler::cycles_now() - t0) / ADB_IO_BENCH_SAMPLES;
+
+    t0 = profiler::cycles_now();
+    for (uint32_t i = 0; i < ADB_IO_BENCH_SAMPLES; i++) {
+        (void)P::read();
+        (void)micros_now();
+    }
+    uint32_t sample_cyc = (profiler::cycles_now() - t0) / ADB_IO_BENCH_SAMPLES;
     portENABLE_INTERRUPTS();
+
+    uint32_t fall_min = UINT32_MAX, fall_max = 0, n = 0;
+    uint64_t fall_sum = 0;
+    for (uint32_t i = 0; i < ADB_IO_BENCH_SAMPLES; i++) {
+        if (!P::read()) continue;                     // host (or pull-up) still low
+        portDISABLE_INTERRUPTS();
+        uint32_t start = profiler::cycles_now();
+        P::low();
+        while (P::read() && profiler::cycles_now() - start < mhz) {}
+        uint32_t fall = profiler::cycles_now() - start;
+        P::high();
+        portENABLE_INTERRUPTS();
+        if (fall >= mhz) continue;                    // no edge within 1µs
+        if (fall < fall_min) fall_min = fall;
+        if (fall > fall_max) fall_max = fall;
+        fall_sum += fall;
+        n++;
+        delay_us(5);                                  // let the pull-up recover
+    }
+    if (n == 0) fall_min = 0;
+
+    Serial.printf("[IO] %-9s read:%lucyc sample:%lucyc (%lukS/s) fall:%lu/%lu/%lucyc (min/avg/max) jitter:%lucyc (%luns) n=%lu\n",
+                  label, read_cyc, sample_cyc, mhz * 1000 / sample_cyc,
+                  fall_min, n ? (uint32_t)(fall_sum / n) : 0, fall_max,
+                  fall_max - fall_min, (fall_max - fall_min) * 1000 / mhz, n);
+}
+
+void bind_core() {
+#if ADB_SELF_TEST
+    io_benchmark<RegisterPin>("register");
+#endif
+#if ADB_DEDICATED_GPIO
+    // Release every channel first so the pin doesn't glitch low as the
+    // bundle takes it over
+    dedic_gpio_cpu_ll_write_mask(0xFF, 0xFF);
+
+    const int pins[] = { ADB_DATA_PIN };
+    dedic_gpio_bundle_config_t cfg = {};
+    cfg.gpio_array   = pins;
+    cfg.array_size   = 1;
+    cfg.flags.in_en  = 1;
+    cfg.flags.out_en = 1;
+    if (dedic_gpio_new_bundle(&cfg, &s_bundle) != ESP_OK) {
+        Serial.println("[ADB] Dedicated GPIO bundle failed — bus I/O will not work");
+        return;
+    }
+    dedic_gpio_get_out_mask(s_bundle, &s_dedic_out);
+    dedic_gpio_get_in_mask(s_bundle, &s_dedic_in);
+    gpio_ll_od_enable(&GPIO, (gpio_num_t)ADB_DATA_PIN);   // the bundle sets push-pull
+    DedicatedPin::high();
+    Serial.printf("[ADB] Dedicated GPIO bound on core %d (out:0x%02lx in:0x%02lx)\n",
+                  xPortGetCoreID(), s_dedic_out, s_dedic_in);
+#if ADB_SELF_TEST
+    io_benchmark<DedicatedPin>("dedicated");
+#endif
+#endif
 }
 
 } // namespace adb_platform
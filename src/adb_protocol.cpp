@@ -2,61 +2,84 @@
 #include "adb_platform.h"
 #include "adb_keyboard.h"
 #include "adb_mouse.h"
+#include "bit_timing.h"
+#include "host_presence.h"
 #include "oled_display.h"
+#include "deferred_log.h"
+#include "metrics.h"
+#include "poll_predictor.h"
+#include "profiler.h"
 #include "config.h"
 
 #include <Arduino.h>
+#include <esp_task_wdt.h>
 
 using namespace adb_platform;
 
 namespace adb_protocol {
 
+// This bit-banged engine serves bus 0 on ADB_DATA_PIN; a second bus, if
+// any, is adb_rmt_bus's.
+static constexpr uint8_t BUS = 0;
+
 // ─── Low-level bit I/O ─────────────────────────────────────────────────────
 
-void IRAM_ATTR send_bit(bool bit) {
-    if (bit) {
-        // '1' bit: 35µs low, 65µs high
-        drive_low();
-        delay_us(ADB_BIT_1_LOW_US);
-        release();
-        delay_us(ADB_BIT_1_HIGH_US);
-    } else {
-        // '0' bit: 65µs low, 35µs high
-        drive_low();
-        delay_us(ADB_BIT_0_LOW_US);
-        release();
-        delay_us(ADB_BIT_0_HIGH_US);
-    }
+// The bus is wired-AND: another device talking at the same time shows up
+// as the line staying low after we release it. Whoever releases first has
+// lost — it stops at once and leaves the rest of the cell (and the bus) to
+// the winner, whose reply reaches the host intact.
+
+bool IRAM_ATTR send_bit(bool bit) {
+    uint32_t low  = bit ? ADB_BIT_1_LOW_US  : ADB_BIT_0_LOW_US;    // '1': 35µs low, 65µs high
+    uint32_t high = bit ? ADB_BIT_1_HIGH_US : ADB_BIT_0_HIGH_US;   // '0': 65µs low, 35µs high
+
+    drive_low();
+    delay_us(low);
+    release();
+    delay_us(ADB_COLLISION_SETTLE_US);
+    if (!read_pin()) return false;      // someone else is holding it low
+    delay_us(high - ADB_COLLISION_SETTLE_US);
+    return true;
 }
 
-void IRAM_ATTR send_byte(uint8_t byte) {
+bool IRAM_ATTR send_byte(uint8_t byte) {
     for (int i = 7; i >= 0; i--) {
-        send_bit((byte >> i) & 1);
+        if (!send_bit((byte >> i) & 1)) return false;
     }
+    return true;
 }
 
-void IRAM_ATTR send_data(uint16_t data) {
+bool IRAM_ATTR send_data(uint16_t data) {
     // Start bit (always '1')
-    send_bit(1);
+    if (!send_bit(1)) return false;
 
     // 16 data bits, MSB first
     for (int i = 15; i >= 0; i--) {
-        send_bit((data >> i) & 1);
+        if (!send_bit((data >> i) & 1)) return false;
     }
 
     // Stop bit (always '0')
-    send_bit(0);
+    return send_bit(0);
 }
 
-int IRAM_ATTR receive_bit() {
+// Host bit timing, learned from command bytes (single writer: bus loop)
+static BitTiming s_bit_timing;
+static uint8_t   s_cmd_lows[8];    // low times of the last command byte, MSB first
+
+/// receive_bit() that also returns the cell's low time.
+static int IRAM_ATTR receive_bit_timed(uint32_t& low_time) {
+    low_time = 0;
+
     // Wait for line to go low (start of bit cell)
     if (wait_for_state(false, ADB_BIT_CELL_US * 2) == 0) {
+        metrics::inc(metrics::Counter::ADB_ERR_BIT_NO_EDGE);
         return -1;  // timeout
     }
 
     // Measure low duration
-    uint32_t low_time = measure_pulse(false, ADB_BIT_CELL_US + ADB_TIMING_TOLERANCE_US);
+    low_time = measure_pulse(false, ADB_BIT_CELL_US + ADB_TIMING_TOLERANCE_US);
     if (low_time == 0) {
+        metrics::inc(metrics::Counter::ADB_ERR_BIT_GLITCH);  // high again before we looked
         return -1;
     }
 
@@ -64,24 +87,46 @@ int IRAM_ATTR receive_bit() {
     // Don't need to measure — just wait for it
     wait_for_state(true, ADB_BIT_CELL_US);
 
-    // Decode: <50µs low = '1', >=50µs low = '0'
-    return (low_time < ADB_BIT_THRESHOLD_US) ? 1 : 0;
+    // Decode: below the learned threshold (nominally 50µs) = '1', else '0'
+    if (s_bit_timing.classify(low_time)) {
+        metrics::record(metrics::Histogram::ADB_BIT1_LOW_US, low_time);
+        return 1;
+    }
+    metrics::record(metrics::Histogram::ADB_BIT0_LOW_US, low_time);
+    if (low_time >= ADB_BIT_CELL_US + ADB_TIMING_TOLERANCE_US) {
+        metrics::inc(metrics::Counter::ADB_ERR_BIT_LONG_LOW);  // decoded as '0' anyway
+    }
+    return 0;
 }
 
-int IRAM_ATTR receive_byte() {
+int IRAM_ATTR receive_bit() {
+    uint32_t low_time;
+    return receive_bit_timed(low_time);
+}
+
+/// receive_byte() that also keeps each bit's low time, MSB first.
+static int IRAM_ATTR receive_byte_timed(uint8_t lows[8]) {
     int result = 0;
     for (int i = 7; i >= 0; i--) {
-        int bit = receive_bit();
+        uint32_t low_time;
+        int bit = receive_bit_timed(low_time);
         if (bit < 0) return -1;
+        lows[7 - i] = low_time > 0xFF ? 0xFF : (uint8_t)low_time;
         result |= (bit << i);
     }
     return result;
 }
 
+int IRAM_ATTR receive_byte() {
+    uint8_t lows[8];
+    return receive_byte_timed(lows);
+}
+
 int32_t IRAM_ATTR receive_data() {
     // Wait for start bit
     int start = receive_bit();
     if (start < 0 || start != 1) {
+        if (start == 0) metrics::inc(metrics::Counter::ADB_ERR_LISTEN_START);
         return -1;  // missing or invalid start bit
     }
 
@@ -103,7 +148,7 @@ AdbCommand IRAM_ATTR receive_command() {
     AdbCommand cmd = {0, 0, 0, false};
 
     // Read the 8-bit command byte
-    int byte = receive_byte();
+    int byte = receive_byte_timed(s_cmd_lows);
     if (byte < 0) return cmd;
 
     // NOTE: We do NOT consume the stop bit here.
@@ -130,6 +175,7 @@ void IRAM_ATTR assert_srq() {
 
 /// Consume the host's stop bit, optionally asserting SRQ.
 void IRAM_ATTR consume_stop_bit(bool do_srq) {
+    PROF_SCOPE(ADB_STOP_BIT);
     // The stop bit starts with a low phase (~65µs).
     // Wait for the line to go low (start of stop bit).
     wait_for_state(false, ADB_BIT_CELL_US * 2);
@@ -143,20 +189,24 @@ void IRAM_ATTR consume_stop_bit(bool do_srq) {
     }
 }
 
-// ─── ADB activity counters ──────────────────────────────────────────────────
-static volatile uint32_t s_poll_count = 0;
-static volatile uint32_t s_talk_response_count = 0;
-
-uint32_t get_poll_count()     { return s_poll_count; }
-uint32_t get_response_count() { return s_talk_response_count; }
+/// Fold the last command byte, and its sync if one was measured, into the
+/// host's bit timing. Runs after the transaction, with interrupts enabled.
+static void learn_bit_timing(uint32_t sync_us) {
+    if (!s_bit_timing.learn_byte(s_cmd_lows)) {
+        metrics::inc(metrics::Counter::ADB_BIT_LEARN_REJECT);
+        return;
+    }
+    if (sync_us > 0) s_bit_timing.learn_sync(sync_us);
+    metrics::set(metrics::Gauge::ADB_BIT_THRESHOLD, s_bit_timing.threshold_us());
+    metrics::set(metrics::Gauge::ADB_BIT0_EST_US,   s_bit_timing.bit0_us());
+    metrics::set(metrics::Gauge::ADB_BIT1_EST_US,   s_bit_timing.bit1_us());
+}
 
 // ─── Bus monitoring ─────────────────────────────────────────────────────────
 
 static void log_command(const AdbCommand& cmd) {
 #if ADB_DEBUG_VERBOSE
-    static const char* cmd_names[] = {"Reset", "Flush", "Listen", "Talk"};
-    Serial.printf("[ADB] Addr:%d Cmd:%s Reg:%d\n",
-                  cmd.address, cmd_names[cmd.command], cmd.reg);
+    DLOG(ADB_COMMAND, cmd.address, cmd.command, cmd.reg);
 #endif
 }
 
@@ -165,17 +215,20 @@ static void log_command(const AdbCommand& cmd) {
 /// Process a received ADB command. Called with the stop bit NOT yet consumed.
 /// @param cmd Parsed command.
 /// @param ints_disabled true if interrupts are currently disabled (caller must re-enable).
+// Talk R0 polls each device still sits out after a collided reply
+// (0 = keyboard, 1 = mouse)
+static uint8_t s_backoff[2] = { 0, 0 };
+
 static void handle_command(const AdbCommand& cmd, bool ints_disabled) {
     oled_display::set_adb_active(true);
-    oled_display::inc_poll_count();
-    s_poll_count++;
+    metrics::inc(metrics::Counter::ADB_POLLS);
 
-    bool is_kbd   = (cmd.address == adb_keyboard::current_address());
-    bool is_mouse = (cmd.address == adb_mouse::current_address());
+    bool is_kbd   = (cmd.address == adb_keyboard::current_address(BUS));
+    bool is_mouse = (cmd.address == adb_mouse::current_address(BUS));
 
     if (!is_kbd && !is_mouse) {
         // Not addressed to us — assert SRQ during the stop bit if we have data
-        bool want_srq = adb_keyboard::has_data() || adb_mouse::has_data();
+        bool want_srq = adb_keyboard::has_data(BUS) || adb_mouse::has_data(BUS);
         consume_stop_bit(want_srq);
         if (ints_disabled) interrupts_enable();
         return;
@@ -184,8 +237,9 @@ static void handle_command(const AdbCommand& cmd, bool ints_disabled) {
     // Addressed to us — assert SRQ if the OTHER device has pending data.
     // We emulate two devices on one bus, so when keyboard is polled,
     // mouse should signal if it needs attention, and vice versa.
-    bool other_has_data = is_kbd ? adb_mouse::has_data() : adb_keyboard::has_data();
+    bool other_has_data = is_kbd ? adb_mouse::has_data(BUS) : adb_keyboard::has_data(BUS);
     consume_stop_bit(other_has_data);
+    uint32_t stop_end_us = micros_now();   // Tlt reference for both directions
     if (ints_disabled) interrupts_enable();
 
     switch (cmd.command) {
@@ -193,26 +247,62 @@ static void handle_command(const AdbCommand& cmd, bool ints_disabled) {
             uint16_t data;
             bool has_response = false;
 
-            if (is_kbd) {
-                has_response = adb_keyboard::handle_talk(cmd.reg, data);
-            } else {
-                has_response = adb_mouse::handle_talk(cmd.reg, data);
+            // Backing off: stay quiet and keep the data for a later poll
+            uint8_t& backoff = s_backoff[is_kbd ? 0 : 1];
+            if (cmd.reg == 0 && backoff > 0) {
+                backoff--;
+                metrics::inc(metrics::Counter::ADB_COLLISION_BACKOFF);
+                break;
+            }
+
+            {
+                PROF_SCOPE(ADB_HANDLE_TALK);
+                if (is_kbd) {
+                    has_response = adb_keyboard::handle_talk(BUS, cmd.reg, data);
+                } else {
+                    has_response = adb_mouse::handle_talk(BUS, cmd.reg, data);
+                }
             }
 
             if (has_response) {
                 // Wait Tlt (stop-to-start time)
-                delay_us(ADB_TLT_US);
+                {
+                    PROF_SCOPE(ADB_TLT_SPIN);
+                    delay_us(ADB_TLT_US);
+                }
 
                 interrupts_disable();
-                send_data(data);
+                metrics::record(metrics::Histogram::ADB_REPLY_TLT_US, micros_now() - stop_end_us);
+                bool sent;
+                {
+                    PROF_SCOPE(ADB_SEND_DATA);
+                    sent = send_data(data);
+                }
                 interrupts_enable();
 
-                oled_display::inc_event_count();
+                if (!sent) {
+                    metrics::inc(metrics::Counter::ADB_COLLISIONS);
+                    if (is_kbd) adb_keyboard::reply_collided(BUS, cmd.reg);
+                    else        adb_mouse::reply_collided(BUS, cmd.reg);
+                    // R3 collisions are how the host finds shared addresses;
+                    // after an R0 collision sit out a random few polls so two
+                    // devices with data don't collide on every one
+                    if (cmd.reg == 0) {
+                        backoff = 1 + esp_random() % ADB_COLLISION_BACKOFF_MAX_POLLS;
+                    }
+                    DLOG(ADB_COLLISION, cmd.address, cmd.reg, data);
+                    break;
+                }
+
+                uint32_t wire_us = micros_now();
+                if (is_kbd) adb_keyboard::trace_reply_sent(BUS, wire_us);
+                else        adb_mouse::trace_reply_sent(BUS, wire_us);
+
+                metrics::inc(metrics::Counter::ADB_TALK_REPLIES);
 
 #if ADB_DEBUG_VERBOSE
-                Serial.printf("[ADB] Talk A%d R%d -> 0x%04X\n", cmd.address, cmd.reg, data);
+                DLOG(ADB_TALK, cmd.address, cmd.reg, data);
 #endif
-                s_talk_response_count++;
             }
             // No data = no response (bus stays idle per ADB spec)
             break;
@@ -223,115 +313,300 @@ static void handle_command(const AdbCommand& cmd, bool ints_disabled) {
             // The host controls Tlt timing — wait for the line to go low
             // rather than using a fixed delay
             if (wait_for_state(false, ADB_TLT_MAX_US + 100) == 0) {
+                metrics::inc(metrics::Counter::ADB_ERR_LISTEN_NO_DATA);
                 break;  // host didn't send data
             }
+            metrics::record(metrics::Histogram::ADB_HOST_TLT_US, micros_now() - stop_end_us);
 
             interrupts_disable();
-            int32_t data = receive_data();
+            int32_t data;
+            {
+                PROF_SCOPE(ADB_LISTEN_RX);
+                data = receive_data();
+            }
             interrupts_enable();
 
             if (data >= 0) {
                 if (is_kbd) {
-                    adb_keyboard::handle_listen(cmd.reg, (uint16_t)data);
+                    adb_keyboard::handle_listen(BUS, cmd.reg, (uint16_t)data);
                 } else {
-                    adb_mouse::handle_listen(cmd.reg, (uint16_t)data);
+                    adb_mouse::handle_listen(BUS, cmd.reg, (uint16_t)data);
                 }
-                Serial.printf("[ADB] Listen A%d R%d <- 0x%04X\n", cmd.address, cmd.reg, (uint16_t)data);
+                DLOG(ADB_LISTEN, cmd.address, cmd.reg, (uint16_t)data);
+            } else {
+                metrics::inc(metrics::Counter::ADB_LISTEN_DECODE_ERRORS);
             }
             break;
         }
 
         case ADB_CMD_FLUSH:
-            if (is_kbd) adb_keyboard::handle_flush();
-            if (is_mouse) adb_mouse::handle_flush();
-            Serial.printf("[ADB] Flush A%d\n", cmd.address);
+            if (is_kbd) adb_keyboard::handle_flush(BUS);
+            if (is_mouse) adb_mouse::handle_flush(BUS);
+            DLOG(ADB_FLUSH, cmd.address);
             break;
 
         case ADB_CMD_RESET:
-            if (is_kbd) adb_keyboard::handle_reset();
-            if (is_mouse) adb_mouse::handle_reset();
-            Serial.printf("[ADB] Reset A%d\n", cmd.address);
+            if (is_kbd) adb_keyboard::handle_reset(BUS);
+            if (is_mouse) adb_mouse::handle_reset(BUS);
+            DLOG(ADB_RESET, cmd.address);
             break;
     }
 }
 
+// ─── Host presence and line holds ───────────────────────────────────────────
+
+static void feed_watchdog(uint32_t& last_feed) {
+    if (micros_now() - last_feed >= ADB_WDT_FEED_MS * 1000) {
+        esp_task_wdt_reset();
+        last_feed = micros_now();
+    }
+}
+
+/// Whether the host has gone quiet. host_presence empties the devices the
+/// first time, since what they hold would only replay on wake.
+static bool host_gone() {
+    return host_presence::gone(BUS);
+}
+
+/// The line has been low since low_start for longer than any attention
+/// pulse: a global reset, or no Mac powering the pull-up. Wait for the
+/// release — sleeping a tick at a time once no reset could last this
+/// long — then reset both devices to their default addresses.
+static void global_reset(uint32_t low_start, uint32_t& last_feed) {
+    while (!read_pin()) {
+        feed_watchdog(last_feed);
+        if (micros_now() - low_start >= HOST_LISTEN_MS * 1000) vTaskDelay(1);
+    }
+    adb_keyboard::handle_reset(BUS);
+    adb_mouse::handle_reset(BUS);
+    DLOG(ADB_GLOBAL_RESET, micros_now() - low_start);
+}
+
+#if !ADB_ATTN_IRQ
+/// Host gone: sleep a tick at a time (IDLE1 parks Core 1 in waiti) and
+/// look at the line in between, until it is seen low. A tick is shorter
+/// than a reset pulse, so a starting Mac's reset is never slept through;
+/// a poll may be, but the caller then spins long enough for the next.
+static void sleep_until_activity(uint32_t& last_feed) {
+    while (read_pin()) {
+        feed_watchdog(last_feed);
+        vTaskDelay(1);
+    }
+}
+#endif
+
 // ─── Main bus loop ──────────────────────────────────────────────────────────
 
 void init() {
     adb_platform::init();
-    adb_keyboard::init();
-    adb_mouse::init();
+    adb_keyboard::init(BUS);
+    adb_mouse::init(BUS);
+
+    // Stage queued input into the device buffers between bursts, so a
+    // Talk R0 usually finds its reply ready (handle_talk still drains
+    // whatever arrived since)
+    poll_predictor::add_job("kbd_stage",   []() { adb_keyboard::process_queue(BUS); }, ADB_JOB_STAGE_KBD_US);
+    poll_predictor::add_job("mouse_stage", []() { adb_mouse::process_queue(BUS); },    ADB_JOB_STAGE_MOUSE_US);
+
+    metrics::set(metrics::Gauge::ADB_BIT_THRESHOLD, s_bit_timing.threshold_us());
+    metrics::set(metrics::Gauge::ADB_BIT0_EST_US,   s_bit_timing.bit0_us());
+    metrics::set(metrics::Gauge::ADB_BIT1_EST_US,   s_bit_timing.bit1_us());
 }
 
 void bus_loop() {
     Serial.println("[ADB] Bus loop started on core " + String(xPortGetCoreID()));
 
-    uint32_t yield_counter = 0;
+    // This task feeds the task watchdog itself rather than yielding so that
+    // IDLE1 can: a 1 ms vTaskDelay() lands on a poll far too easily (the Mac
+    // sends the mouse poll ~200µs after the keyboard's). Core 1's idle task
+    // is taken off the watchdog instead.
+    disableCore1WDT();
+    esp_task_wdt_add(nullptr);
+    uint32_t last_feed = micros_now();
+#if !ADB_ATTN_IRQ
+    uint32_t last_attn = micros_now();   // last attention edge, or last idle yield
+#endif
+    bool     after_yield = false;        // no valid attention seen since the last yield
+    uint32_t quiet_since = micros_now(); // line last known to have gone high
+#if !ADB_CORE1_ISOLATION && !ADB_ATTN_IRQ
+    // loop() shares Core 1 at priority 1 and only runs when this task sleeps
+    uint32_t last_loop_yield = micros_now();
+#endif
+#if ADB_ATTN_IRQ
+    // Armed only inside sleep_until_low(), so with Core 1 isolation this
+    // task's own wake is still the only interrupt source on the core
+    attn_irq_init();
+#endif
 
     while (true) {
+        feed_watchdog(last_feed);
+
         // Always wait for line to be high (idle) first, then detect
         // the falling edge. This ensures we measure the full attention
         // pulse and don't catch a partial one already in progress.
         if (!read_pin()) {
             // Line is already low — we missed the start.
             // Wait for it to go high again before looking for next command.
-            wait_for_state(true, ADB_RESET_MIN_US + 500);
+            if (after_yield) {
+                after_yield = false;
+                metrics::inc(metrics::Counter::ADB_YIELD_MISSED);
+            }
+            uint32_t seen = micros_now();
+            uint32_t rest = wait_for_state(true, ADB_RESET_MIN_US + 500);
+            if (rest == 0) {
+                // Still low after a whole reset's length: a reset under
+                // way, or a line with no Mac pulling it up
+                global_reset(seen, last_feed);
+#if !ADB_ATTN_IRQ
+                last_attn = micros_now();
+#endif
+            }
+            quiet_since = micros_now();
             continue;
         }
 
         // Line is high (idle) — wait for falling edge (attention start)
-        if (wait_for_state(false, 10000) == 0) {
-            // No bus activity for 10ms — safe to yield for TWDT
-            vTaskDelay(1);
+        bool attn_edge;
+        uint32_t low_start;
+#if ADB_ATTN_IRQ
+        // Sleep (IDLE1 parks the core in waiti) until the edge interrupt;
+        // the ISR timestamps the edge, so only the rest of the pulse is
+        // measured by spinning below
+        {
+            PROF_SCOPE(ADB_WAIT_ATTN);
+            // Host gone: wake less often (devices already emptied)
+            low_start = sleep_until_low(host_gone() ? HOST_ABSENT_WAKE_MS : ADB_ATTN_IRQ_TIMEOUT_MS);
+        }
+        attn_edge = low_start != 0;
+        if (!attn_edge) {
+            metrics::inc(metrics::Counter::ADB_WAKE_TIMEOUTS);
+            continue;
+        }
+        metrics::inc(metrics::Counter::ADB_WAKE_IRQ);
+        metrics::record(metrics::Histogram::ADB_WAKE_US, micros_now() - low_start);
+        if (read_pin()) {
+            // Woke after the pulse ended (or a glitch) — its length is unknown
+            metrics::inc(metrics::Counter::ADB_WAKE_LATE);
+            quiet_since = micros_now();
             continue;
         }
+#else
+        {
+            PROF_SCOPE(ADB_WAIT_ATTN);
+            attn_edge = wait_for_state_watch(false, 10000) != 0;
+        }
+        if (!attn_edge) {
+            // Host asleep or off: sleep until the line moves, then spin for
+            // HOST_LISTEN_MS so its first full poll is caught
+            if (host_gone() && micros_now() - last_attn >= HOST_LISTEN_MS * 1000) {
+                sleep_until_activity(last_feed);
+                last_attn = micros_now();
+                continue;
+            }
+
+            // The host polls every ~11 ms while awake, so only a long
+            // silence (asleep, or no host) is a safe gap to give Core 1's
+            // idle task a tick for its housekeeping.
+            if (micros_now() - last_attn >= ADB_IDLE_YIELD_MS * 1000) {
+                metrics::inc(metrics::Counter::ADB_IDLE_YIELDS);
+                vTaskDelay(1);
+                last_attn = micros_now();
+                after_yield = true;
+            }
+            continue;
+        }
+        last_attn = micros_now();
 
         // Falling edge detected — measure the full low pulse duration
-        uint32_t low_start = micros_now();
-        wait_for_state(true, ADB_RESET_MIN_US + 500);
+        low_start = micros_now();
+#endif
+        {
+            PROF_SCOPE(ADB_ATTN);
+            wait_for_state_watch(true, ADB_RESET_MIN_US + 500);
+        }
         uint32_t low_duration = micros_now() - low_start;
 
         if (low_duration >= ADB_RESET_MIN_US) {
             // Global reset — reset both devices to default addresses
-            adb_keyboard::handle_reset();
-            adb_mouse::handle_reset();
-            Serial.printf("[ADB] Global reset (%luus)\n", low_duration);
+            global_reset(low_start, last_feed);
+            quiet_since = micros_now();
             continue;
         }
 
-        if (low_duration >= ADB_ATTN_MIN_US && low_duration <= ADB_ATTN_MAX_US) {
+        // Only a low after at least Tlt of idle line can be an attention
+        // pulse; shorter gaps are another device's reply bits or an SRQ
+        // stop bit, normal traffic that says nothing about the host
+        bool after_idle = (int32_t)(low_start - quiet_since) >= (int32_t)ADB_TLT_MAX_US;
+        if (after_idle) metrics::record(metrics::Histogram::ADB_ATTN_US, low_duration);
+
+        // A pulse already under way when a yield returned measures short
+        bool attn_valid = low_duration >= ADB_ATTN_MIN_US && low_duration <= ADB_ATTN_MAX_US;
+        if (after_yield) {
+            after_yield = false;
+            if (!attn_valid) metrics::inc(metrics::Counter::ADB_YIELD_MISSED);
+        }
+        if (attn_valid) {
+            poll_predictor::on_attention(low_start);
+        }
+
+        if (attn_valid) {
             // Valid attention pulse — line is now high (sync period)
             // Measure sync high duration
             uint32_t sync_start = micros_now();
-            wait_for_state(false, ADB_SYNC_NOMINAL_US + 30);
+            bool sync_edge = wait_for_state(false, ADB_SYNC_NOMINAL_US + 30) != 0;
             uint32_t sync = micros_now() - sync_start;
+            if (sync_edge) {
+                metrics::record(metrics::Histogram::ADB_SYNC_US, sync);
+            } else {
+                metrics::inc(metrics::Counter::ADB_ERR_SYNC_TIMEOUT);
+            }
 
             if (sync > 0) {
                 // Read command byte (line just went low = start of first bit)
                 // Keep interrupts disabled through stop bit consumption
                 // (handle_command will re-enable them)
                 interrupts_disable();
-                AdbCommand cmd = receive_command();
+                AdbCommand cmd;
+                {
+                    PROF_SCOPE(ADB_DECODE);
+                    cmd = receive_command();
+                }
 
                 if (cmd.valid) {
                     handle_command(cmd, true);  // true = ints still disabled
+                    host_presence::on_command(BUS);
                     log_command(cmd);
+                    learn_bit_timing(sync_edge ? sync : 0);
                 } else {
                     interrupts_enable();
+                    metrics::inc(metrics::Counter::ADB_CMD_DECODE_ERRORS);
                 }
             }
+        } else if (after_idle) {
+            // Noise or out-of-spec pulse — ignore, loop back to wait for idle
+            metrics::inc(metrics::Counter::ADB_ERR_ATTN_RANGE);
+        }
+        quiet_since = micros_now();
+
+        // Predicted gap before the next burst: staging and other idle jobs
+        if (attn_valid) {
+            poll_predictor::on_transaction_end(micros_now());
         }
-        // else: noise or invalid pulse — ignore, loop back to wait for idle
-
-        // Periodic yield to keep Core 1 idle task alive for TWDT.
-        // Yields ~1ms every 256 iterations (~3s at 91 polls/s).
-        // We must NOT yield after every command — the Mac sends
-        // back-to-back polls (keyboard then mouse) with only ~200µs
-        // gap, and a 1ms delay would consistently miss the mouse.
-        if (++yield_counter >= 256) {
-            yield_counter = 0;
+        poll_predictor::run_idle_jobs();
+
+#if !ADB_CORE1_ISOLATION && !ADB_ATTN_IRQ
+        // Give loop() a tick only where the predictor expects no poll for
+        // longer than a tick can last. If the cadence won't lock, fall back
+        // to yielding after any command once loop() has waited too long.
+        bool starved = micros_now() - last_loop_yield >= ADB_LOOP_YIELD_MS * 1000 * 10;
+        if ((poll_predictor::idle_budget_us(micros_now()) >= ADB_YIELD_BUDGET_US || starved) &&
+            micros_now() - last_loop_yield >= ADB_LOOP_YIELD_MS * 1000) {
+            metrics::inc(metrics::Counter::ADB_IDLE_YIELDS);
             vTaskDelay(1);
+            last_loop_yield = micros_now();
+            after_yield = true;
         }
+#endif
     }
 }
 
@@ -451,10 +726,14 @@ void bus_monitor() {
 
                     // If Listen, try to read host data
                     if (cmd == ADB_CMD_LISTEN) {
-                        delay_us(ADB_TLT_US);
-                        int32_t data = receive_data();
-                        if (data >= 0) {
-                            Serial.printf(" ← 0x%04X", (uint16_t)data);
+                        // Host controls Tlt — wait for the start bit's falling edge
+                        if (wait_for_state(false, ADB_TLT_MAX_US + 100) != 0) {
+                            int32_t data = receive_data();
+                            if (data >= 0) {
+                                Serial.printf(" ← 0x%04X", (uint16_t)data);
+                            }
+                        } else {
+                            Serial.print(" (no data)");
                         }
                     }
                 }
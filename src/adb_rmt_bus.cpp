@@ -0,0 +1,534 @@
+#include "adb_rmt_bus.h"
+#include "adb_keyboard.h"
+#include "adb_mouse.h"
+#include "adb_platform.h"
+#include "bit_timing.h"
+#include "deferred_log.h"
+#include "host_presence.h"
+#include "metrics.h"
+#include "config.h"
+
+#include <Arduino.h>
+
+#if ADB_BUS_B
+
+#include <driver/gpio.h>
+#include <driver/rmt.h>
+#include <hal/gpio_ll.h>
+#include <hal/rmt_ll.h>
+#include <soc/rmt_struct.h>
+
+namespace adb_rmt_bus {
+
+using adb_platform::micros_now;
+
+// ─── Configuration (set once by task_loop) ─────────────────────────────────
+
+static constexpr int CH    = ADB_BUS_B_RMT_CHANNEL;
+static constexpr int RX_CH = ADB_BUS_B_RX_CHANNEL;
+static constexpr int RX_LL = RX_CH - 4;        // rmt_ll numbers the RX channels from CH4
+static constexpr uint32_t RX_MEM_ITEMS = 48;   // one memory block, used as a ring (wrap mode)
+
+// The RMT's own input filter drops pulses shorter than ADB_GLITCH_US, in
+// 80 MHz APB cycles, before they ever reach an entry
+static constexpr uint32_t RX_FILTER_CYCLES = ADB_GLITCH_US * 80;
+static_assert(RX_FILTER_CYCLES <= 255, "RMT RX filter threshold is 8 bits");
+static_assert(ADB_BUS_B_RX_IDLE_US > ADB_RESET_MIN_US && ADB_BUS_B_RX_IDLE_US < 32768,
+              "RX must time a whole global reset in a 15-bit entry");
+
+static gpio_num_t   s_pin  = (gpio_num_t)ADB_BUS_B_PIN;
+static uint8_t      s_bus  = 1;
+static TaskHandle_t s_task = nullptr;
+
+// ─── ISR → task events ──────────────────────────────────────────────────────
+// ISR and task share Core 0, so a small ring with one writer per index is
+// enough. A host transaction yields at most three events (command, its
+// stop bit, then Listen data) within a millisecond or so.
+
+enum class EventKind : uint8_t { COMMAND, STOP, LISTEN_DATA, RESET };
+
+struct BusEvent {
+    EventKind kind;
+    uint8_t   cmd;              // COMMAND: raw command byte
+    bool      srq;              // COMMAND: we asserted SRQ in its stop bit; STOP: srq_lat_us valid
+    uint8_t   sync_us;          // COMMAND: sync high, for learning (0 = out of range)
+    uint8_t   low_us[8];        // COMMAND: bit low times, for learning
+    uint16_t  data;             // LISTEN_DATA: received word; STOP: Tlt before our reply (0 = none)
+    uint16_t  srq_lat_us;       // STOP: stop-bit fall to our SRQ, when we asserted one in time
+    uint32_t  stop_end_us;      // COMMAND: expected end of the stop bit, SRQ included
+};
+
+static constexpr uint32_t EVENT_RING_SIZE = 8;
+static BusEvent          s_events[EVENT_RING_SIZE];
+static volatile uint32_t s_event_head = 0;     // written by the ISR
+static volatile uint32_t s_event_tail = 0;     // written by the task
+
+// ─── ISR state ──────────────────────────────────────────────────────────────
+// The RMT receiver times every low and high in hardware, so interrupt
+// latency delays the decode but never skews a measured bit. Each entry
+// is one low and the high after it, and is written at the next falling
+// edge: the eighth entry after attention lands as the host pulls the
+// stop bit low, just in time to decide SRQ.
+
+enum RxPhase : uint8_t { RX_IDLE, RX_COMMAND, RX_STOP, RX_ECHO, RX_DATA };
+
+static uint8_t  s_phase   = RX_IDLE;
+static uint8_t  s_nbits   = 0;
+static uint32_t s_bits    = 0;
+static uint8_t  s_cmd     = 0;
+static uint8_t  s_sync_us = 0;
+static uint8_t  s_lows[8];
+static bool     s_srq_pending = false;     // our SRQ is in the stop bit being timed
+static uint32_t s_rx_index = 0;            // next RX memory entry to read
+static volatile bool s_rx_stopped = false; // receiver idled out with the line low
+
+// Host bit threshold, learned by the task from each command's low times
+// and read by the ISR (one word, same core)
+static BitTiming s_bit_timing;
+
+// Entries of our own Talk reply still to come back through the receiver.
+// Set by the task when it starts a reply, counted down by the ISR.
+static volatile uint8_t s_echo_left = 0;
+
+// Published by the task for the ISR's SRQ decision
+static volatile uint8_t s_kbd_addr   = ADB_ADDR_KEYBOARD;
+static volatile uint8_t s_mouse_addr = ADB_ADDR_MOUSE;
+static volatile bool    s_kbd_data   = false;
+static volatile bool    s_mouse_data = false;
+
+// Counted in the ISR, folded into metrics by the task
+static volatile uint32_t s_isr_errors   = 0;
+static volatile uint32_t s_isr_srq      = 0;
+static volatile uint32_t s_isr_srq_late = 0;
+static volatile uint32_t s_isr_dropped  = 0;
+
+// A Listen's data arrives as its own event; who it is for (task only)
+static bool    s_listen_kbd   = false;
+static bool    s_listen_mouse = false;
+static uint8_t s_listen_reg   = 0;
+
+// ─── RMT transmit ───────────────────────────────────────────────────────────
+
+/// Copy items into the channel's RMT memory and start it from the top.
+/// Register writes only, so the ISR can use it too.
+static inline __attribute__((always_inline)) void tx_send(const rmt_item32_t* items, int n) {
+    for (int i = 0; i < n; i++) RMTMEM.chan[CH].data32[i].val = items[i].val;
+    rmt_ll_tx_reset_pointer(&RMT, CH);
+    rmt_ll_tx_start(&RMT, CH);
+}
+
+/// One RMT item: `level0` for `us0`, then `level1` for `us1`. A zero
+/// duration ends the waveform and the pin returns to idle (released).
+static inline __attribute__((always_inline)) rmt_item32_t item(uint32_t level0, uint32_t us0,
+                                                               uint32_t level1, uint32_t us1) {
+    rmt_item32_t it;
+    it.level0    = level0;
+    it.duration0 = us0;
+    it.level1    = level1;
+    it.duration1 = us1;
+    return it;
+}
+
+// ─── RMT receive ────────────────────────────────────────────────────────────
+
+/// Clear the RX ring and start receiving from its top. Call with the line
+/// high, so the first entry starts with a low, and with interrupts off
+/// (or from the ISR).
+static inline __attribute__((always_inline)) void rx_start() {
+    rmt_ll_rx_enable(&RMT, RX_LL, false);
+    for (uint32_t i = 0; i < RX_MEM_ITEMS; i++) RMTMEM.chan[RX_CH].data32[i].val = 0;
+    s_rx_index = 0;
+    s_phase    = RX_IDLE;
+    rmt_ll_rx_reset_pointer(&RMT, RX_LL);
+    rmt_ll_rx_enable(&RMT, RX_LL, true);
+    s_rx_stopped = false;
+}
+
+// ─── Receive interrupt ──────────────────────────────────────────────────────
+
+static inline __attribute__((always_inline)) void post(const BusEvent& ev) {
+    uint32_t head = s_event_head;
+    if (head - s_event_tail >= EVENT_RING_SIZE) {
+        s_isr_dropped++;
+        return;
+    }
+    s_events[head % EVENT_RING_SIZE] = ev;
+    s_event_head = head + 1;
+
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(s_task, &woken);
+    if (woken) portYIELD_FROM_ISR();
+}
+
+static inline __attribute__((always_inline)) void post(EventKind kind) {
+    BusEvent ev = {};
+    ev.kind = kind;
+    post(ev);
+}
+
+static inline __attribute__((always_inline)) bool is_listen(uint8_t cmd) {
+    return ((cmd >> 2) & 0x03) == ADB_CMD_LISTEN;
+}
+
+static inline __attribute__((always_inline)) void rx_error() {
+    s_isr_errors++;
+    s_phase = RX_IDLE;
+}
+
+/// Decode one receiver entry: `low` µs low, then `high` µs high. `now` is
+/// no later than the falling edge that ended it plus interrupt latency.
+static inline __attribute__((always_inline)) void rx_entry(uint32_t low, uint32_t high, uint32_t now) {
+    if (s_phase == RX_ECHO) {
+        if (--s_echo_left == 0) s_phase = RX_IDLE;
+        return;
+    }
+    if (low >= ADB_RESET_MIN_US) {
+        post(EventKind::RESET);
+        s_phase = RX_IDLE;
+        return;
+    }
+    if (low >= ADB_ATTN_MIN_US && low <= ADB_ATTN_MAX_US) {
+        s_phase   = RX_COMMAND;
+        s_nbits   = 0;
+        s_bits    = 0;
+        s_sync_us = high <= 255 ? (uint8_t)high : 0;
+        return;
+    }
+
+    switch (s_phase) {
+    case RX_COMMAND: {
+        if (low > ADB_BIT_CELL_US + ADB_TIMING_TOLERANCE_US) { rx_error(); return; }
+        s_lows[s_nbits] = (uint8_t)low;
+        s_bits = (s_bits << 1) | s_bit_timing.classify(low);
+        if (++s_nbits < 8) return;
+
+        // The host has just pulled the stop bit low: if a device other
+        // than the one addressed has data, hold it low for SRQ
+        uint8_t cmd  = (uint8_t)s_bits;
+        uint8_t addr = cmd >> 4;
+        bool srq = (addr == s_kbd_addr)   ? s_mouse_data
+                 : (addr == s_mouse_addr) ? s_kbd_data
+                 : (s_kbd_data || s_mouse_data);
+        if (srq) {
+            rmt_item32_t wave[1] = { item(0, ADB_SRQ_LOW_US, 1, 0) };
+            tx_send(wave, 1);
+            s_isr_srq++;
+        }
+
+        BusEvent ev = {};
+        ev.kind        = EventKind::COMMAND;
+        ev.cmd         = cmd;
+        ev.srq         = srq;
+        ev.sync_us     = s_sync_us;
+        for (int i = 0; i < 8; i++) ev.low_us[i] = s_lows[i];
+        ev.stop_end_us = now + (srq ? ADB_SRQ_LOW_US : ADB_STOP_LOW_US);
+        post(ev);
+
+        s_cmd         = cmd;
+        s_srq_pending = srq;
+        s_phase       = RX_STOP;
+        return;
+    }
+
+    case RX_STOP: {
+        // The stop bit, ended by our reply's start bit, the host's Listen
+        // data or its next command
+        BusEvent ev = {};
+        ev.kind = EventKind::STOP;
+        if (s_srq_pending) {
+            s_srq_pending = false;
+            if (low + ADB_TIMING_TOLERANCE_US < ADB_SRQ_LOW_US) {
+                // The host let go before our SRQ started: this entry was
+                // its own stop bit, and our SRQ low is the next one
+                s_isr_srq_late++;
+                return;
+            }
+            // Our SRQ ran ADB_SRQ_LOW_US from when the ISR started it, so
+            // the rest is how long after the falling edge that was
+            ev.srq        = true;
+            ev.srq_lat_us = low > ADB_SRQ_LOW_US ? low - ADB_SRQ_LOW_US : 0;
+        } else if (low > ADB_SRQ_LOW_US + ADB_TIMING_TOLERANCE_US) {
+            // A command's stop bit may be stretched by another device's SRQ
+            rx_error();
+            return;
+        }
+        ev.data = s_echo_left ? (uint16_t)high : 0;
+        post(ev);
+
+        s_nbits = 0;
+        s_bits  = 0;
+        s_phase = s_echo_left ? RX_ECHO : is_listen(s_cmd) ? RX_DATA : RX_IDLE;
+        return;
+    }
+
+    case RX_DATA: {
+        // Start bit ('1'), 16 data bits; the stop bit's entry only ends
+        // at the host's next command, so the word is complete before it
+        if (low > ADB_BIT_CELL_US + ADB_TIMING_TOLERANCE_US) { rx_error(); return; }
+        uint32_t bit = s_bit_timing.classify(low);
+        if (s_nbits++ == 0) {
+            if (!bit) rx_error();
+            return;
+        }
+        s_bits = (s_bits << 1) | bit;
+        if (s_nbits < 17) return;
+
+        BusEvent ev = {};
+        ev.kind = EventKind::LISTEN_DATA;
+        ev.data = (uint16_t)s_bits;
+        post(ev);
+        s_phase = RX_IDLE;
+        return;
+    }
+
+    default:
+        return;     // between transactions: the end of a Listen's stop bit
+    }
+}
+
+static void IRAM_ATTR rx_isr(void*) {
+    uint32_t now  = micros_now();
+    uint32_t mask = 1u << RX_LL;
+    bool ended = rmt_ll_get_rx_end_interrupt_status(&RMT) & mask;
+    if (rmt_ll_get_rx_thres_interrupt_status(&RMT) & mask) rmt_ll_clear_rx_thres_interrupt(&RMT, RX_LL);
+    if (ended) rmt_ll_clear_rx_end_interrupt(&RMT, RX_LL);
+
+    // Entries read are zeroed, so the first zero is where the receiver
+    // has got to. A real entry is never zero: its low lasts at least
+    // the filter.
+    while (true) {
+        rmt_item32_t it;
+        it.val = RMTMEM.chan[RX_CH].data32[s_rx_index].val;
+        if (!it.val) break;
+        RMTMEM.chan[RX_CH].data32[s_rx_index].val = 0;
+        s_rx_index = (s_rx_index + 1) % RX_MEM_ITEMS;
+        rx_entry(it.duration0, it.duration1, now);
+    }
+
+    if (ended) {
+        // No edge for ADB_BUS_B_RX_IDLE_US and the receiver has stopped.
+        // Restart it while the line is high; if it is held low, the task
+        // restarts it once the line is released.
+        if (gpio_ll_get_level(&GPIO, s_pin)) rx_start();
+        else s_rx_stopped = true;
+    }
+}
+
+// ─── Task side ──────────────────────────────────────────────────────────────
+
+/// Refresh what the ISR needs to decide SRQ on its own.
+static void publish_state() {
+    s_kbd_addr   = adb_keyboard::current_address(s_bus);
+    s_mouse_addr = adb_mouse::current_address(s_bus);
+    s_kbd_data   = adb_keyboard::has_data(s_bus);
+    s_mouse_data = adb_mouse::has_data(s_bus);
+}
+
+/// Start a Talk reply so its start bit falls ADB_TLT_US after stop_end_us.
+/// stop_end_us is in the future while the stop bit (or our SRQ in it) is
+/// still holding the line.
+/// @return false (nothing taken from the device) if it is already too late.
+static bool talk(bool is_kbd, uint8_t reg, bool srq, uint32_t stop_end_us) {
+    int32_t elapsed = (int32_t)(micros_now() - stop_end_us);
+    if (elapsed + (int32_t)ADB_BUS_B_TX_SETUP_US > (int32_t)ADB_TLT_MAX_US) {
+        metrics::inc(metrics::Counter::ADB_B_LATE);
+        return false;
+    }
+
+    uint16_t data;
+    bool has_response = is_kbd ? adb_keyboard::handle_talk(s_bus, reg, data)
+                               : adb_mouse::handle_talk(s_bus, reg, data);
+    if (!has_response) return false;
+
+    // Items 1..18: start bit, 16 data bits, stop bit, each low then high.
+    // The stop bit's high is the idle level, so its zero duration ends the
+    // waveform there.
+    rmt_item32_t wave[19];
+    uint32_t total = 0;
+    for (int i = 0; i < 18; i++) {
+        bool one = (i == 0) ? true : (i == 17) ? false : ((data >> (16 - i)) & 1);
+        uint32_t low  = one ? ADB_BIT_1_LOW_US  : ADB_BIT_0_LOW_US;
+        uint32_t high = (i == 17) ? 0 : one ? ADB_BIT_1_HIGH_US : ADB_BIT_0_HIGH_US;
+        wave[i + 1] = item(0, low, 1, high);
+        total += low + high;
+    }
+
+    // Item 0 is the lead-in. Starting the channel again while our SRQ is
+    // still going cuts it short, so then the lead-in holds the line low
+    // for the rest of the SRQ before releasing it for Tlt. The host's own
+    // stop bit needs no help: released is high, and its low wins.
+    portDISABLE_INTERRUPTS();
+    uint32_t start = micros_now();
+    elapsed = (int32_t)(start - stop_end_us);
+    uint32_t srq_rest = 0, lead;
+    if (srq && elapsed < 0) {
+        srq_rest = (uint32_t)-elapsed;
+        lead     = ADB_TLT_US;
+        wave[0]  = item(0, srq_rest, 1, lead);
+    } else {
+        lead    = (elapsed + (int32_t)ADB_BUS_B_TX_SETUP_US < (int32_t)ADB_TLT_US)
+                  ? (uint32_t)((int32_t)ADB_TLT_US - elapsed) : ADB_BUS_B_TX_SETUP_US;
+        wave[0] = item(1, lead / 2, 1, lead - lead / 2);
+    }
+    uint32_t first_edge = start + srq_rest + lead;
+    s_echo_left = 18;
+    tx_send(wave, 19);
+    portENABLE_INTERRUPTS();
+
+    metrics::inc(metrics::Counter::ADB_B_REPLIES);
+    if (is_kbd) adb_keyboard::trace_reply_sent(s_bus, first_edge + total);
+    else        adb_mouse::trace_reply_sent(s_bus, first_edge + total);
+#if ADB_DEBUG_VERBOSE
+    DLOG(ADB_TALK, is_kbd ? adb_keyboard::current_address(s_bus)
+                          : adb_mouse::current_address(s_bus), reg, data);
+#endif
+    return true;
+}
+
+/// Fold a command's low times into the host's bit timing.
+static void learn_bit_timing(const BusEvent& e) {
+    if (!s_bit_timing.learn_byte(e.low_us)) return;
+    if (e.sync_us > 0) s_bit_timing.learn_sync(e.sync_us);
+    metrics::set(metrics::Gauge::ADB_B_BIT_THRESHOLD, s_bit_timing.threshold_us());
+}
+
+static void handle_event(const BusEvent& e) {
+    if (e.kind == EventKind::RESET) {
+        adb_keyboard::handle_reset(s_bus);
+        adb_mouse::handle_reset(s_bus);
+        s_listen_kbd = s_listen_mouse = false;
+        DLOG(ADB_GLOBAL_RESET, 0);
+        return;
+    }
+    if (e.kind == EventKind::STOP) {
+        // Measured by the receiver: the Tlt our reply actually kept, and
+        // how long after the stop bit fell the ISR started our SRQ
+        if (e.data) metrics::record(metrics::Histogram::ADB_B_REPLY_TLT_US, e.data);
+        if (e.srq)  metrics::record(metrics::Histogram::ADB_B_SRQ_LAT_US, e.srq_lat_us);
+        return;
+    }
+    if (e.kind == EventKind::LISTEN_DATA) {
+        if (s_listen_kbd)   adb_keyboard::handle_listen(s_bus, s_listen_reg, e.data);
+        if (s_listen_mouse) adb_mouse::handle_listen(s_bus, s_listen_reg, e.data);
+        s_listen_kbd = s_listen_mouse = false;
+        return;
+    }
+
+    metrics::inc(metrics::Counter::ADB_B_POLLS);
+    host_presence::on_command(s_bus);
+    uint8_t address = (e.cmd >> 4) & 0x0F;
+    uint8_t command = (e.cmd >> 2) & 0x03;
+    uint8_t reg     = e.cmd & 0x03;
+    bool is_kbd   = (address == adb_keyboard::current_address(s_bus));
+    bool is_mouse = (address == adb_mouse::current_address(s_bus));
+    s_listen_kbd = s_listen_mouse = false;
+
+    if (is_kbd || is_mouse) {
+        switch (command) {
+            case ADB_CMD_TALK:
+                talk(is_kbd, reg, e.srq, e.stop_end_us);
+                break;
+            case ADB_CMD_LISTEN:
+                s_listen_kbd   = is_kbd;
+                s_listen_mouse = is_mouse;
+                s_listen_reg   = reg;
+                break;
+            case ADB_CMD_FLUSH:
+                if (is_kbd)   adb_keyboard::handle_flush(s_bus);
+                if (is_mouse) adb_mouse::handle_flush(s_bus);
+                break;
+            case ADB_CMD_RESET:
+                if (is_kbd)   adb_keyboard::handle_reset(s_bus);
+                if (is_mouse) adb_mouse::handle_reset(s_bus);
+                break;
+        }
+    }
+
+    // After the reply is on its way
+    learn_bit_timing(e);
+}
+
+void task_loop(int pin, uint8_t bus) {
+    s_pin  = (gpio_num_t)pin;
+    s_bus  = bus;
+    s_task = xTaskGetCurrentTaskHandle();
+    adb_keyboard::init(bus);
+    adb_mouse::init(bus);
+    publish_state();
+    metrics::set(metrics::Gauge::ADB_B_BIT_THRESHOLD, s_bit_timing.threshold_us());
+
+    // RMT RX at 1 µs per tick. Configured first: it sets the pin as an
+    // input, and the TX setup below makes it an output again.
+    rmt_config_t rx = RMT_DEFAULT_CONFIG_RX(s_pin, (rmt_channel_t)RX_CH);
+    rx.clk_div = 80;
+    rx.rx_config.filter_en           = true;
+    rx.rx_config.filter_ticks_thresh = RX_FILTER_CYCLES;
+    rx.rx_config.idle_threshold      = ADB_BUS_B_RX_IDLE_US;
+    rmt_config(&rx);
+
+    // RMT TX at 1 µs per tick, idling high (released)
+    rmt_config_t cfg = RMT_DEFAULT_CONFIG_TX(s_pin, (rmt_channel_t)CH);
+    cfg.clk_div = 80;
+    cfg.tx_config.idle_output_en = true;
+    cfg.tx_config.idle_level     = RMT_IDLE_LEVEL_HIGH;
+    cfg.tx_config.carrier_en     = false;
+    rmt_config(&cfg);
+
+    // rmt_config() leaves a push-pull output: make it open-drain and turn
+    // the input back on for the receiver
+    gpio_ll_od_enable(&GPIO, s_pin);
+    gpio_ll_input_enable(&GPIO, s_pin);
+
+    // The receiver's memory is a ring with an interrupt for every entry,
+    // and one at the end of a frame. The interrupt lands on this core.
+    rmt_set_memory_owner((rmt_channel_t)RX_CH, RMT_MEM_OWNER_RX);
+    rmt_ll_rx_enable_pingpong(&RMT, RX_LL, true);
+    rmt_set_rx_thr_intr_en((rmt_channel_t)RX_CH, true, 1);
+    rmt_set_rx_intr_en((rmt_channel_t)RX_CH, true);
+    rmt_isr_register(rx_isr, nullptr, ESP_INTR_FLAG_IRAM | ESP_INTR_FLAG_LEVEL3, nullptr);
+    s_rx_stopped = true;
+
+    Serial.printf("[BUSB] Bus %u on GPIO%d, RMT TX channel %d, RX channel %d, core %d\n",
+                  bus, pin, CH, RX_CH, xPortGetCoreID());
+
+    uint32_t seen_errors = 0, seen_srq = 0, seen_srq_late = 0, seen_dropped = 0;
+    while (true) {
+        // Receiver stopped with the line low (or not started yet): restart
+        // it once the line is released
+        if (s_rx_stopped && gpio_ll_get_level(&GPIO, s_pin)) {
+            portDISABLE_INTERRUPTS();
+            rx_start();
+            portENABLE_INTERRUPTS();
+        }
+
+        // Host gone: the devices are emptied once (host_presence), and the
+        // task only wakes for bus events or the occasional look at the counters
+        bool gone = host_presence::gone(bus);
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(gone ? HOST_ABSENT_WAKE_MS : ADB_BUS_B_IDLE_MS));
+
+        while (s_event_tail != s_event_head) {
+            BusEvent e = s_events[s_event_tail % EVENT_RING_SIZE];
+            s_event_tail = s_event_tail + 1;
+            handle_event(e);
+        }
+
+        adb_keyboard::process_queue(bus);
+        adb_mouse::process_queue(bus);
+        publish_state();
+
+        uint32_t errors = s_isr_errors, srq = s_isr_srq;
+        uint32_t srq_late = s_isr_srq_late, dropped = s_isr_dropped;
+        metrics::inc(metrics::Counter::ADB_B_DECODE_ERRORS, errors - seen_errors);
+        metrics::inc(metrics::Counter::ADB_B_SRQ, srq - seen_srq);
+        metrics::inc(metrics::Counter::ADB_B_SRQ_LATE, srq_late - seen_srq_late);
+        metrics::inc(metrics::Counter::ADB_B_DROPPED, dropped - seen_dropped);
+        seen_errors = errors;
+        seen_srq = srq;
+        seen_srq_late = srq_late;
+        seen_dropped = dropped;
+    }
+}
+
+} // namespace adb_rmt_bus
+
+#endif // ADB_BUS_B
@@ -1,10 +1,15 @@
 #include "ble_hid_host.h"
 #include "event_queue.h"
-#include "keycode_map.h"
+#include "host_presence.h"
+#include "input_stage.h"
+#include "metrics.h"
+#include "profiler.h"
+#include "seqlock.h"
 #include "config.h"
 
 #include <Arduino.h>
 #include <NimBLEDevice.h>
+#include <Preferences.h>
 #include <algorithm>
 
 namespace ble_hid_host {
@@ -14,16 +19,16 @@ static const NimBLEUUID HID_SERVICE_UUID("1812");
 static const NimBLEUUID HID_REPORT_UUID("2A4D");
 static const NimBLEUUID BOOT_KBD_INPUT_UUID("2A22");
 static const NimBLEUUID BOOT_MOUSE_INPUT_UUID("2A33");
+static const NimBLEUUID BOOT_KBD_OUTPUT_UUID("2A32");
+static const NimBLEUUID REPORT_REFERENCE_UUID("2908");
 static const NimBLEUUID REPORT_MAP_UUID("2A4B");
 
 // ─── Device tracking ────────────────────────────────────────────────────────
 
 struct BleDevice {
     NimBLEClient* client = nullptr;
-    DeviceStatus  status = { DeviceState::DISCONNECTED, {0}, false, false };
-    uint8_t       prev_keys[6] = {0};
-    uint8_t       prev_modifiers = 0;
-    bool          prev_buttons = false;
+    DeviceStatus  status = { DeviceState::DISCONNECTED, {0}, false, false, 0 };
+    Seqlock<DeviceStatus> published;   // status as seen by other tasks/cores
 
     // Reconnection state
     NimBLEAddress bonded_addr;
@@ -32,10 +37,29 @@ struct BleDevice {
     uint32_t      reconnect_next_ms = 0;
     uint32_t      reconnect_delay_ms = 0;
     int           reconnect_attempts = 0;
+    bool          boot_restore = false;   // restored from NVS, first attempt not yet made
+    uint32_t      ready_ms = 0;           // millis() when first CONNECTED since boot
+    bool          relaxed = false;        // idle connection parameters requested (host gone)
+    NimBLERemoteCharacteristic* led_report = nullptr;   // keyboard LED output report, if any
+    int16_t       leds_sent = -1;         // LED state last written to it (-1 = none yet)
 };
 
 static BleDevice s_keyboard;
 static BleDevice s_mouse;
+
+/// Publish a device's working status for get_*_status() readers.
+/// Writers (BLE task, NimBLE host callbacks) are all on Core 0.
+static void publish_status(BleDevice* device) {
+    device->published.write(device->status);
+}
+
+/// Refresh the negotiated connection interval — the peripheral may request
+/// a parameter update at any time after connecting.
+static void refresh_conn_interval(BleDevice* device) {
+    bool live = device->status.state == DeviceState::CONNECTED &&
+                device->client && device->client->isConnected();
+    device->status.conn_interval = live ? device->client->getConnInfo().getConnInterval() : 0;
+}
 static bool s_scanning = false;
 
 // Pending connection: scan callback stores address, task_loop connects
@@ -48,9 +72,10 @@ static void on_keyboard_report(NimBLERemoteCharacteristic* chr,
                                uint8_t* data, size_t length, bool is_notify);
 static void on_mouse_report(NimBLERemoteCharacteristic* chr,
                             uint8_t* data, size_t length, bool is_notify);
-static void start_scan();
+static void schedule_scan();
 static bool try_connect(const NimBLEAddress& addr, const char* name);
 static bool try_reconnect(BleDevice* device, const char* label);
+static void save_role(const BleDevice* device);
 static void handle_reconnection(BleDevice* device, const char* label);
 
 // ─── Client callbacks ───────────────────────────────────────────────────────
@@ -66,16 +91,19 @@ public:
         Serial.printf("[BLE] [%s] Connected to %s\n",
                       label, client->getPeerAddress().toString().c_str());
         device->status.state = DeviceState::DISCOVERING;
+        publish_status(device);
     }
 
     void onDisconnect(NimBLEClient* client, int reason) override {
         Serial.printf("[BLE] [%s] Disconnected from %s (reason=%d)\n",
                       label, device->status.name, reason);
 
-        // Clear input state
-        memset(device->prev_keys, 0, sizeof(device->prev_keys));
-        device->prev_modifiers = 0;
-        device->prev_buttons = false;
+        device->led_report = nullptr;
+
+        // Clear input state (ordered behind any reports still in the ring)
+        input_stage::post_reset(device == &s_keyboard
+                                ? input_stage::ReportKind::RESET_KEYBOARD
+                                : input_stage::ReportKind::RESET_MOUSE);
 
         // If we had a known device type, enter RECONNECTING — keep client & address
         if (device->status.is_keyboard || device->status.is_mouse) {
@@ -100,6 +128,7 @@ public:
             }
             device->client = nullptr;
         }
+        publish_status(device);
     }
 };
 
@@ -152,8 +181,13 @@ class ScanCallbacks : public NimBLEScanCallbacks {
         bool need_kbd   = (s_keyboard.status.state == DeviceState::DISCONNECTED);
         bool need_mouse = (s_mouse.status.state == DeviceState::DISCONNECTED);
         if (!need_kbd && !need_mouse) {
-            NimBLEDevice::getScan()->stop();
-            s_scanning = false;
+            // Keep the background scan alive while a bonded device is still
+            // being reconnected — its advertisement triggers the reconnect.
+            if (s_keyboard.status.state != DeviceState::RECONNECTING &&
+                s_mouse.status.state != DeviceState::RECONNECTING) {
+                NimBLEDevice::getScan()->stop();
+                s_scanning = false;
+            }
             return;
         }
 
@@ -234,6 +268,32 @@ static void detect_device_type(NimBLERemoteService* hid_service,
     }
 }
 
+/// The keyboard's LED output report: Boot Keyboard Output while reports
+/// come from Boot KBD Input, otherwise the HID Report whose Report
+/// Reference descriptor says Output (type 2). nullptr if it has neither.
+static NimBLERemoteCharacteristic* find_led_report(NimBLERemoteService* hid_service, bool boot) {
+    if (boot) {
+        NimBLERemoteCharacteristic* chr = hid_service->getCharacteristic(BOOT_KBD_OUTPUT_UUID);
+        if (chr && (chr->canWrite() || chr->canWriteNoResponse())) {
+            Serial.printf("[BLE] LED output: Boot KBD Output (handle=%d)\n", chr->getHandle());
+            return chr;
+        }
+    }
+    for (auto* chr : hid_service->getCharacteristics(false)) {
+        bool writable = chr->canWrite() || chr->canWriteNoResponse();
+        if (!writable || !(chr->getUUID() == HID_REPORT_UUID)) continue;
+        NimBLERemoteDescriptor* ref = chr->getDescriptor(REPORT_REFERENCE_UUID);
+        if (!ref) continue;
+        std::string value = ref->readValue();   // [report ID][report type]
+        if (value.length() >= 2 && (uint8_t)value[1] == 2) {
+            Serial.printf("[BLE] LED output: HID Report (handle=%d)\n", chr->getHandle());
+            return chr;
+        }
+    }
+    Serial.println("[BLE] No LED output report — keyboard LEDs won't follow the Mac");
+    return nullptr;
+}
+
 static bool try_connect(const NimBLEAddress& addr, const char* name) {
     bool need_kbd   = (s_keyboard.status.state == DeviceState::DISCONNECTED);
     bool need_mouse = (s_mouse.status.state == DeviceState::DISCONNECTED);
@@ -252,7 +312,8 @@ static bool try_connect(const NimBLEAddress& addr, const char* name) {
     }
     // Connect first with neutral callbacks — avoids corrupting kbd/mouse state
     client->setClientCallbacks(&s_neutral_callbacks, false);
-    client->setConnectionParams(12, 40, 0, 400);
+    client->setConnectionParams(BLE_CONN_MIN_INTERVAL, BLE_CONN_MAX_INTERVAL,
+                                BLE_CONN_LATENCY, BLE_CONN_TIMEOUT);
 
     Serial.printf("[BLE] Connecting to %s...\n", name);
 
@@ -325,6 +386,7 @@ static bool try_connect(const NimBLEAddress& addr, const char* name) {
     target->status.state = DeviceState::CONNECTING;
     strncpy(target->status.name, name, sizeof(target->status.name) - 1);
     target->client = client;
+    publish_status(target);   // discovery below blocks for a while
 
     // Ensure the connection is encrypted before subscribing.
     // HID devices require encryption for notifications to flow.
@@ -367,6 +429,7 @@ static bool try_connect(const NimBLEAddress& addr, const char* name) {
 
     auto cb_fn = assign_as_kbd ? on_keyboard_report : on_mouse_report;
     const char* type_str = assign_as_kbd ? "keyboard" : "mouse";
+    bool boot_input = false;   // keyboard reports come from Boot KBD Input
 
     if (assign_as_kbd) {
         // ── Keyboard subscription strategy ──
@@ -380,6 +443,7 @@ static bool try_connect(const NimBLEAddress& addr, const char* name) {
                 bool ok = boot_kbd->subscribe(!use_indicate, cb_fn);
                 if (ok) {
                     subscribed = true;
+                    boot_input = true;
                     Serial.printf("[BLE] Subscribed keyboard to Boot KBD Input (handle=%d)\n",
                                   boot_kbd->getHandle());
                 }
@@ -456,10 +520,15 @@ static bool try_connect(const NimBLEAddress& addr, const char* name) {
         }
 
         target->status.state = DeviceState::CONNECTED;
+        target->relaxed = false;
+        target->led_report = assign_as_kbd ? find_led_report(hid_service, boot_input) : nullptr;
+        target->leds_sent = -1;
         target->status.is_keyboard = assign_as_kbd;
         target->status.is_mouse = !assign_as_kbd;
         target->bonded_addr = client->getPeerAddress();
         target->reconnect_attempts = 0;
+        if (!target->ready_ms) target->ready_ms = millis();
+        save_role(target);
         Serial.printf("[BLE] %s ready: %s (conn handle=%d)\n",
                       target->status.is_keyboard ? "Keyboard" : "Mouse",
                       name, client->getConnHandle());
@@ -474,160 +543,30 @@ static bool try_connect(const NimBLEAddress& addr, const char* name) {
     return false;
 }
 
-// ─── Report parsing ─────────────────────────────────────────────────────────
-
-// Per-handle tracking: which characteristic handles are firing and how often
-static constexpr int MAX_TRACKED_HANDLES = 10;
-struct HandleStats {
-    uint16_t handle;
-    uint32_t count;
-};
-static HandleStats s_kbd_handle_stats[MAX_TRACKED_HANDLES] = {};
-static HandleStats s_mouse_handle_stats[MAX_TRACKED_HANDLES] = {};
-
-static void track_handle(HandleStats* stats, uint16_t handle) {
-    for (int i = 0; i < MAX_TRACKED_HANDLES; i++) {
-        if (stats[i].handle == handle) { stats[i].count++; return; }
-        if (stats[i].count == 0) { stats[i].handle = handle; stats[i].count = 1; return; }
-    }
-}
+// ─── Report capture ─────────────────────────────────────────────────────────
+// These run in the NimBLE host task. They only count, timestamp and copy the
+// raw report into the input stage ring — parsing happens in the input task.
 
-static volatile uint32_t s_ble_kbd_cb_count = 0;
-static volatile uint32_t s_ble_kbd_cb_used = 0;    // reports that passed length filter
-static volatile uint32_t s_ble_kbd_cb_dropped = 0;  // reports rejected by length filter
 static volatile uint32_t s_ble_kbd_last_ms = 0;     // millis() of last keyboard notification
 
 static void on_keyboard_report(NimBLERemoteCharacteristic* chr,
                                uint8_t* data, size_t length, bool is_notify) {
-    s_ble_kbd_cb_count++;
+    PROF_SCOPE(BLE_KBD_CB);
+    metrics::inc(metrics::Counter::BLE_KBD_NOTIFY);
     s_ble_kbd_last_ms = millis();
-    track_handle(s_kbd_handle_stats, chr->getHandle());
-
-    if (length < 8) {
-        s_ble_kbd_cb_dropped++;
-        return;
-    }
-    s_ble_kbd_cb_used++;
-
-    uint8_t modifiers = data[0];
-
-    // Process modifier key changes
-    uint8_t mod_diff = modifiers ^ s_keyboard.prev_modifiers;
-    if (mod_diff) {
-        for (int i = 0; i < keycode_map::MODIFIER_MAP_SIZE; i++) {
-            uint8_t mask = keycode_map::MODIFIER_MAP[i].usb_mask;
-            if (mod_diff & mask) {
-                KbdEvent evt;
-                evt.adb_keycode = keycode_map::MODIFIER_MAP[i].adb_keycode;
-                evt.released = !(modifiers & mask);
-                event_queue::send_kbd(evt);
-
-#if ADB_DEBUG_VERBOSE
-                Serial.printf("[BLE] Modifier %s: ADB=0x%02X\n",
-                              evt.released ? "up" : "down", evt.adb_keycode);
-#endif
-            }
-        }
-        s_keyboard.prev_modifiers = modifiers;
-    }
-
-    // Detect releases: keys in prev but not in current
-    for (int i = 0; i < 6; i++) {
-        uint8_t prev_key = s_keyboard.prev_keys[i];
-        if (prev_key == 0) continue;
-
-        bool still_pressed = false;
-        for (int j = 2; j < 8 && j < (int)length; j++) {
-            if (data[j] == prev_key) {
-                still_pressed = true;
-                break;
-            }
-        }
-
-        if (!still_pressed) {
-            uint8_t adb_code = keycode_map::usb_to_adb(prev_key);
-            if (adb_code != keycode_map::ADB_KEY_NONE) {
-                KbdEvent evt;
-                evt.adb_keycode = adb_code;
-                evt.released = true;
-                event_queue::send_kbd(evt);
-
-#if ADB_DEBUG_VERBOSE
-                Serial.printf("[BLE] Key up: USB=0x%02X ADB=0x%02X\n", prev_key, adb_code);
-#endif
-            }
-        }
-    }
-
-    // Detect presses: keys in current but not in prev
-    for (int j = 2; j < 8 && j < (int)length; j++) {
-        uint8_t cur_key = data[j];
-        if (cur_key == 0) continue;
-
-        bool was_pressed = false;
-        for (int i = 0; i < 6; i++) {
-            if (s_keyboard.prev_keys[i] == cur_key) {
-                was_pressed = true;
-                break;
-            }
-        }
-
-        if (!was_pressed) {
-            uint8_t adb_code = keycode_map::usb_to_adb(cur_key);
-            if (adb_code != keycode_map::ADB_KEY_NONE) {
-                KbdEvent evt;
-                evt.adb_keycode = adb_code;
-                evt.released = false;
-                event_queue::send_kbd(evt);
-
-#if ADB_DEBUG_VERBOSE
-                Serial.printf("[BLE] Key down: USB=0x%02X ADB=0x%02X\n", cur_key, adb_code);
-#endif
-            }
-        }
-    }
-
-    // Save current state for next diff
-    for (int i = 0; i < 6; i++) {
-        s_keyboard.prev_keys[i] = (i + 2 < (int)length) ? data[i + 2] : 0;
-    }
+    input_stage::post_report(input_stage::ReportKind::KEYBOARD,
+                             chr->getHandle(), data, length);
 }
 
-static volatile uint32_t s_ble_mouse_cb_count = 0;
 static volatile uint32_t s_ble_mouse_last_ms = 0;   // millis() of last mouse notification
 
 static void on_mouse_report(NimBLERemoteCharacteristic* chr,
                             uint8_t* data, size_t length, bool is_notify) {
-    s_ble_mouse_cb_count++;
+    PROF_SCOPE(BLE_MOUSE_CB);
+    metrics::inc(metrics::Counter::BLE_MOUSE_NOTIFY);
     s_ble_mouse_last_ms = millis();
-    track_handle(s_mouse_handle_stats, chr->getHandle());
-    if (length < 3) return;
-
-    MouseEvent evt;
-
-    if (length >= 5) {
-        // Report Protocol: 5-7 bytes
-        // [buttons] [X_lo] [X_hi] [Y_lo] [Y_hi] [scroll_lo] [scroll_hi]
-        evt.button = (data[0] & 0x01) != 0;
-        evt.dx = (int16_t)(data[1] | (data[2] << 8));
-        evt.dy = (int16_t)(data[3] | (data[4] << 8));
-    } else {
-        // Boot Protocol: 3 bytes [buttons] [dx_8bit] [dy_8bit]
-        evt.button = (data[0] & 0x01) != 0;
-        evt.dx = (int8_t)data[1];
-        evt.dy = (int8_t)data[2];
-    }
-
-    event_queue::send_mouse(evt);
-
-#if ADB_DEBUG_VERBOSE
-    if (evt.dx != 0 || evt.dy != 0 || evt.button != s_mouse.prev_buttons) {
-        Serial.printf("[BLE] Mouse: btn=%d dx=%d dy=%d\n",
-                      evt.button, evt.dx, evt.dy);
-    }
-#endif
-
-    s_mouse.prev_buttons = evt.button;
+    input_stage::post_report(input_stage::ReportKind::MOUSE,
+                             chr->getHandle(), data, length);
 }
 
 // ─── Reconnection ────────────────────────────────────────────────────────────
@@ -653,13 +592,22 @@ static bool try_reconnect(BleDevice* device, const char* label) {
     bool is_kbd = device->was_keyboard;
     ClientCallbacks* cb = is_kbd ? &s_kbd_callbacks : &s_mouse_callbacks;
     client->setClientCallbacks(cb, false);
-    client->setConnectionParams(12, 40, 0, 400);
+    client->setConnectionParams(BLE_CONN_MIN_INTERVAL, BLE_CONN_MAX_INTERVAL,
+                                BLE_CONN_LATENCY, BLE_CONN_TIMEOUT);
 
-    Serial.printf("[BLE] [%s] Reconnecting to %s (attempt %d)...\n",
-                  label, device->bonded_addr.toString().c_str(),
+    Serial.printf("[BLE] [%s] %s to %s (attempt %d)...\n",
+                  label, device->boot_restore ? "Direct-connecting" : "Reconnecting",
+                  device->bonded_addr.toString().c_str(),
                   device->reconnect_attempts + 1);
 
-    if (!client->connect(device->bonded_addr, BLE_RECONNECT_TIMEOUT_MS)) {
+    // First attempt after boot uses a short timeout so a sleeping keyboard
+    // does not hold up the mouse (attempts are sequential).
+    uint32_t timeout_ms = device->boot_restore ? BLE_BOOT_CONNECT_TIMEOUT_MS
+                                               : BLE_RECONNECT_TIMEOUT_MS;
+    device->boot_restore = false;
+    client->setConnectTimeout(timeout_ms);
+
+    if (!client->connect(device->bonded_addr)) {
         Serial.printf("[BLE] [%s] Reconnect failed\n", label);
         return false;
     }
@@ -689,6 +637,7 @@ static bool try_reconnect(BleDevice* device, const char* label) {
     const auto& reports = hid_service->getCharacteristics(true);
     auto cb_fn = is_kbd ? on_keyboard_report : on_mouse_report;
     bool subscribed = false;
+    bool boot_input = false;
 
     if (is_kbd) {
         // Keyboard: prefer Boot KBD Input, fall back to HID Report
@@ -696,6 +645,7 @@ static bool try_reconnect(BleDevice* device, const char* label) {
         if (boot_kbd && boot_kbd->canNotify()) {
             if (boot_kbd->subscribe(true, cb_fn)) {
                 subscribed = true;
+                boot_input = true;
                 Serial.printf("[BLE] [%s] Resubscribed to Boot KBD Input\n", label);
             }
         }
@@ -742,10 +692,14 @@ static bool try_reconnect(BleDevice* device, const char* label) {
 
     // Restore connected state — device type already known
     device->status.state = DeviceState::CONNECTED;
+    device->relaxed = false;
+    device->led_report = is_kbd ? find_led_report(hid_service, boot_input) : nullptr;
+    device->leds_sent = -1;
     device->status.is_keyboard = device->was_keyboard;
     device->status.is_mouse = device->was_mouse;
     device->reconnect_attempts = 0;
     device->bonded_addr = client->getPeerAddress();
+    if (!device->ready_ms) device->ready_ms = millis();
     Serial.printf("[BLE] [%s] Reconnected and ready\n", label);
     return true;
 }
@@ -785,21 +739,262 @@ static void handle_reconnection(BleDevice* device, const char* label) {
                   device->reconnect_attempts, BLE_RECONNECT_MAX_ATTEMPTS);
 }
 
-// ─── Scanning ───────────────────────────────────────────────────────────────
+// ─── Role persistence (NVS) ─────────────────────────────────────────────────
+// Remembers which bonded address was last the keyboard and which the mouse,
+// so boot can go straight to direct connection instead of scanning first.
+
+static const char* NVS_NAMESPACE = "ble-roles";
+
+struct RoleKeys {
+    const char* addr;
+    const char* type;
+    const char* name;
+};
+static const RoleKeys KBD_KEYS   = { "kbd_addr", "kbd_type", "kbd_name" };
+static const RoleKeys MOUSE_KEYS = { "mou_addr", "mou_type", "mou_name" };
+
+static const RoleKeys& role_keys(const BleDevice* device) {
+    return (device == &s_keyboard) ? KBD_KEYS : MOUSE_KEYS;
+}
+
+/// Store the device's address as the last-known keyboard/mouse.
+/// Skips the flash write if nothing changed.
+static void save_role(const BleDevice* device) {
+    const RoleKeys& keys = role_keys(device);
+    uint64_t addr = (uint64_t)device->bonded_addr;
+    uint8_t type = device->bonded_addr.getType();
+
+    Preferences prefs;
+    if (!prefs.begin(NVS_NAMESPACE, false)) return;
+    if (prefs.getULong64(keys.addr, 0) != addr || prefs.getUChar(keys.type, 0xFF) != type) {
+        prefs.putULong64(keys.addr, addr);
+        prefs.putUChar(keys.type, type);
+        prefs.putString(keys.name, device->status.name);
+        Serial.printf("[BLE] Saved %s role: %s\n",
+                      device == &s_keyboard ? "keyboard" : "mouse",
+                      device->bonded_addr.toString().c_str());
+    }
+    prefs.end();
+}
+
+/// Restore a slot from NVS into RECONNECTING with an immediate first attempt.
+/// @return true if the slot was restored.
+static bool restore_role(Preferences& prefs, BleDevice* device, const char* label) {
+    const RoleKeys& keys = role_keys(device);
+    uint64_t addr = prefs.getULong64(keys.addr, 0);
+    if (addr == 0) return false;
+
+    NimBLEAddress bonded(addr, prefs.getUChar(keys.type, 0));
+    if (!NimBLEDevice::isBonded(bonded)) {
+        Serial.printf("[BLE] [%s] Saved address %s is no longer bonded\n",
+                      label, bonded.toString().c_str());
+        return false;
+    }
+
+    bool is_kbd = (device == &s_keyboard);
+    device->bonded_addr = bonded;
+    device->was_keyboard = is_kbd;
+    device->was_mouse = !is_kbd;
+    device->reconnect_delay_ms = BLE_RECONNECT_INITIAL_MS;
+    device->reconnect_next_ms = millis();   // attempt right away
+    device->reconnect_attempts = 0;
+    device->boot_restore = true;
+    prefs.getString(keys.name, device->status.name, sizeof(device->status.name));
+    device->status.state = DeviceState::RECONNECTING;
+    publish_status(device);
+
+    Serial.printf("[BLE] [%s] Restored bonded %s (%s) — direct connect at boot\n",
+                  label, device->status.name, bonded.toString().c_str());
+    return true;
+}
+
+static void restore_roles() {
+    Preferences prefs;
+    if (!prefs.begin(NVS_NAMESPACE, true)) return;   // read-only; fails if never written
+    restore_role(prefs, &s_keyboard, "KBD");
+    restore_role(prefs, &s_mouse, "MOU");
+    prefs.end();
+}
+
+// ─── Scan scheduler ─────────────────────────────────────────────────────────
+// Picks the scan duty cycle from the slot states so scanning never competes
+// harder than necessary with a live device's connection events:
+//   DISCOVERY     nothing live, a slot is unknown  → aggressive active scan
+//   DISCOVERY_BG  a device is live, other unknown  → low-duty active scan
+//   RECONNECT     only bonded devices are missing  → accept-list only, passive, low duty
+//   OFF           every wanted device is connected (or mid-connection)
+
+struct ScanModeStats {
+    uint32_t entries;
+    uint32_t time_ms;
+    uint32_t kbd_jitter_samples;
+    uint64_t kbd_jitter_dev_sum;
+    uint32_t mouse_jitter_samples;
+    uint64_t mouse_jitter_dev_sum;
+};
+
+static constexpr int NUM_SCAN_MODES = 4;
+static ScanMode      s_scan_mode = ScanMode::OFF;
+static uint8_t       s_scan_reconnect_mask = 0;   // slots on the accept list (bit0 kbd, bit1 mouse)
+static uint32_t      s_scan_mode_since_ms = 0;
+static ScanModeStats s_scan_stats[NUM_SCAN_MODES] = {};
+
+/// Scan stats including the open stint, published for dump_scan_stats().
+struct ScanStatsView {
+    ScanMode      mode;
+    ScanModeStats stats[NUM_SCAN_MODES];
+};
+static Seqlock<ScanStatsView> s_scan_view;
+static input_stage::JitterStats s_kbd_jitter_mark   = {};
+static input_stage::JitterStats s_mouse_jitter_mark = {};
+
+static const char* scan_mode_str(ScanMode mode) {
+    switch (mode) {
+        case ScanMode::OFF:          return "OFF";
+        case ScanMode::DISCOVERY:    return "DISCOVERY";
+        case ScanMode::DISCOVERY_BG: return "DISCOVERY_BG";
+        case ScanMode::RECONNECT:    return "RECONNECT";
+        default: return "?";
+    }
+}
+
+static ScanMode desired_scan_mode() {
+    DeviceState kbd = s_keyboard.status.state;
+    DeviceState mou = s_mouse.status.state;
+    bool any_unknown = (kbd == DeviceState::DISCONNECTED || mou == DeviceState::DISCONNECTED);
+    bool any_live    = (kbd == DeviceState::CONNECTED || mou == DeviceState::CONNECTED);
+    bool any_reconn  = (kbd == DeviceState::RECONNECTING || mou == DeviceState::RECONNECTING);
+
+    // With no Mac polling, a new device can wait for the low-duty scan
+    if (any_unknown) {
+        return any_live || !host_presence::active() ? ScanMode::DISCOVERY_BG : ScanMode::DISCOVERY;
+    }
+    if (any_reconn)  return ScanMode::RECONNECT;
+    return ScanMode::OFF;
+}
+
+static uint8_t reconnect_mask() {
+    return (s_keyboard.status.state == DeviceState::RECONNECTING ? 0x01 : 0) |
+           (s_mouse.status.state == DeviceState::RECONNECTING ? 0x02 : 0);
+}
+
+/// Close out the current mode's residency time and notification jitter.
+/// @return mean mouse jitter (µs) over the closed stint, 0 if no samples.
+static uint32_t account_scan_mode(uint32_t now) {
+    ScanModeStats& st = s_scan_stats[(int)s_scan_mode];
+    st.time_ms += now - s_scan_mode_since_ms;
+    s_scan_mode_since_ms = now;
+
+    input_stage::JitterStats kj = input_stage::get_jitter(true);
+    input_stage::JitterStats mj = input_stage::get_jitter(false);
+    uint32_t mouse_samples = mj.samples - s_mouse_jitter_mark.samples;
+    uint64_t mouse_dev     = mj.abs_dev_sum_us - s_mouse_jitter_mark.abs_dev_sum_us;
+    st.kbd_jitter_samples   += kj.samples - s_kbd_jitter_mark.samples;
+    st.kbd_jitter_dev_sum   += kj.abs_dev_sum_us - s_kbd_jitter_mark.abs_dev_sum_us;
+    st.mouse_jitter_samples += mouse_samples;
+    st.mouse_jitter_dev_sum += mouse_dev;
+    s_kbd_jitter_mark = kj;
+    s_mouse_jitter_mark = mj;
+
+    return mouse_samples ? (uint32_t)(mouse_dev / mouse_samples) : 0;
+}
 
-static void start_scan() {
-    if (s_scanning) return;
+/// Publish the scan stats with the current mode's open stint folded in,
+/// without closing it (account_scan_mode() owns the stint boundaries).
+static void publish_scan_stats(uint32_t now) {
+    ScanStatsView view;
+    view.mode = s_scan_mode;
+    memcpy(view.stats, s_scan_stats, sizeof(view.stats));
+
+    ScanModeStats& st = view.stats[(int)s_scan_mode];
+    st.time_ms += now - s_scan_mode_since_ms;
+    input_stage::JitterStats kj = input_stage::get_jitter(true);
+    input_stage::JitterStats mj = input_stage::get_jitter(false);
+    st.kbd_jitter_samples   += kj.samples - s_kbd_jitter_mark.samples;
+    st.kbd_jitter_dev_sum   += kj.abs_dev_sum_us - s_kbd_jitter_mark.abs_dev_sum_us;
+    st.mouse_jitter_samples += mj.samples - s_mouse_jitter_mark.samples;
+    st.mouse_jitter_dev_sum += mj.abs_dev_sum_us - s_mouse_jitter_mark.abs_dev_sum_us;
+
+    s_scan_view.write(view);
+}
+
+/// Put exactly the RECONNECTING slots' bonded addresses on the controller's
+/// filter accept list. Must be called with scanning stopped.
+static void update_accept_list() {
+    BleDevice* devices[] = { &s_keyboard, &s_mouse };
+    for (BleDevice* device : devices) {
+        bool want   = (device->status.state == DeviceState::RECONNECTING);
+        bool listed = NimBLEDevice::onWhiteList(device->bonded_addr);
+        if (want && !listed) {
+            NimBLEDevice::whiteListAdd(device->bonded_addr);
+        } else if (!want && listed) {
+            NimBLEDevice::whiteListRemove(device->bonded_addr);
+        }
+    }
+}
 
+static void start_scan(ScanMode mode) {
     NimBLEScan* scan = NimBLEDevice::getScan();
     scan->setScanCallbacks(&s_scan_callbacks, false);  // false = don't delete
-    scan->setInterval(BLE_SCAN_INTERVAL_MS);
-    scan->setWindow(BLE_SCAN_WINDOW_MS);
-    scan->setActiveScan(true);
-    scan->setFilterPolicy(BLE_HCI_SCAN_FILT_NO_WL_INITA);  // detect directed ads from bonded RPAs
+
+    switch (mode) {
+        case ScanMode::DISCOVERY:
+            scan->setInterval(BLE_SCAN_INTERVAL_MS);
+            scan->setWindow(BLE_SCAN_WINDOW_MS);
+            scan->setActiveScan(true);
+            scan->setFilterPolicy(BLE_HCI_SCAN_FILT_NO_WL_INITA);  // detect directed ads from bonded RPAs
+            break;
+
+        case ScanMode::DISCOVERY_BG:
+            scan->setInterval(BLE_SCAN_BG_INTERVAL_MS);
+            scan->setWindow(BLE_SCAN_BG_WINDOW_MS);
+            scan->setActiveScan(true);
+            scan->setFilterPolicy(BLE_HCI_SCAN_FILT_NO_WL_INITA);
+            break;
+
+        case ScanMode::RECONNECT:
+            update_accept_list();
+            scan->setInterval(BLE_SCAN_RECONNECT_INTERVAL_MS);
+            scan->setWindow(BLE_SCAN_RECONNECT_WINDOW_MS);
+            scan->setActiveScan(false);  // advertisement alone triggers the reconnect
+            scan->setFilterPolicy(BLE_HCI_SCAN_FILT_USE_WL_INITA);
+            break;
+
+        case ScanMode::OFF:
+            return;
+    }
+
     scan->start(BLE_SCAN_DURATION_S, false);
     s_scanning = true;
+}
+
+/// Re-evaluate the scan mode and (re)start scanning if needed.
+/// Called from task_loop() every iteration.
+static void schedule_scan() {
+    ScanMode want = desired_scan_mode();
+    uint8_t mask = reconnect_mask();
+
+    if (want != s_scan_mode) {
+        ScanMode prev = s_scan_mode;
+        uint32_t prev_jitter = account_scan_mode(millis());
+        s_scan_mode = want;
+        s_scan_stats[(int)want].entries++;
+        Serial.printf("[SCAN] %s -> %s (mouse jitter during %s: %luus)\n",
+                      scan_mode_str(prev), scan_mode_str(want),
+                      scan_mode_str(prev), prev_jitter);
+        if (s_scanning) {
+            NimBLEDevice::getScan()->stop();
+            s_scanning = false;
+        }
+    } else if (want == ScanMode::RECONNECT && mask != s_scan_reconnect_mask && s_scanning) {
+        // Accept list contents changed — can only be edited while stopped
+        NimBLEDevice::getScan()->stop();
+        s_scanning = false;
+    }
+    s_scan_reconnect_mask = mask;
 
-    Serial.println("[BLE] Scanning for HID devices...");
+    if (s_scan_mode == ScanMode::OFF || s_scanning || s_pending_connect) return;
+    start_scan(s_scan_mode);
 }
 
 // ─── Public interface ───────────────────────────────────────────────────────
@@ -810,7 +1005,113 @@ void init() {
     NimBLEDevice::setPower(ESP_PWR_LVL_P9);
 
     Serial.println("[BLE] NimBLE initialized");
-    start_scan();
+
+    // Bonded keyboard/mouse from the last session go straight to direct
+    // connection; only an unknown slot needs a discovery scan.
+    restore_roles();
+    schedule_scan();
+}
+
+// ─── Host presence ──────────────────────────────────────────────────────────
+// With no Mac polling, live links move to the idle connection parameters:
+// longer interval plus peripheral latency, so neither side's radio wakes
+// for events that carry nothing. The first poll asks for the fast set back.
+
+static bool s_resume_pending = false;   // active again, links not all fast yet
+
+/// Ask a live link for the parameter set the pipeline mode wants.
+static void apply_conn_mode(BleDevice* device, const char* label) {
+    if (device->status.state != DeviceState::CONNECTED ||
+        !device->client || !device->client->isConnected()) return;
+    bool relax = !host_presence::active();
+    if (device->relaxed == relax) return;
+
+    if (relax) {
+        device->client->updateConnParams(BLE_CONN_IDLE_MIN_INTERVAL, BLE_CONN_IDLE_MAX_INTERVAL,
+                                         BLE_CONN_IDLE_LATENCY, BLE_CONN_IDLE_TIMEOUT);
+    } else {
+        device->client->updateConnParams(BLE_CONN_MIN_INTERVAL, BLE_CONN_MAX_INTERVAL,
+                                         BLE_CONN_LATENCY, BLE_CONN_TIMEOUT);
+    }
+    device->relaxed = relax;
+    metrics::inc(metrics::Counter::BLE_CONN_UPDATES);
+    Serial.printf("[BLE] [%s] Requested %s connection parameters\n",
+                  label, relax ? "idle" : "fast");
+}
+
+/// Follow the pipeline mode. After the host returns, host.resume_ms is the
+/// time from its first poll until every live link is back on a fast interval.
+static void follow_host_mode() {
+    if (host_presence::update()) s_resume_pending = host_presence::active();
+
+    apply_conn_mode(&s_keyboard, "KBD");
+    apply_conn_mode(&s_mouse, "MOU");
+
+    if (!s_resume_pending) return;
+    bool any_live = false, all_fast = true;
+    const BleDevice* devices[] = { &s_keyboard, &s_mouse };
+    for (const BleDevice* device : devices) {
+        if (device->status.conn_interval == 0) continue;
+        any_live = true;
+        if (device->status.conn_interval > BLE_CONN_MAX_INTERVAL) all_fast = false;
+    }
+    if (!all_fast) return;
+    // No live links: nothing was relaxed, so nothing to measure
+    if (any_live) {
+        metrics::record(metrics::Histogram::HOST_RESUME_MS,
+                        millis() - host_presence::active_since_ms());
+    }
+    s_resume_pending = false;
+}
+
+// ─── Keyboard LEDs ──────────────────────────────────────────────────────────
+// The bus engines post each Listen R2 LED change on event_queue's LED
+// channel; here they are coalesced per bus, and the focused Mac's state is
+// written to the keyboard's output report — without response, so the BLE
+// task never waits a connection event for it. A new keyboard connection or
+// a KVM focus switch rewrites the state. led.sync_us runs from the oldest
+// change not yet written to the write.
+
+static uint8_t  s_bus_leds[ADB_BUS_COUNT] = {};   // latest state each Mac wrote
+static bool     s_leds_pending   = false;         // focused bus changed since the last write
+static uint32_t s_leds_posted_us = 0;             // oldest such change
+
+static void sync_leds() {
+    uint8_t focus = event_queue::focus();
+    for (uint8_t bus = 0; bus < ADB_BUS_COUNT; bus++) {
+        LedEvent evt;
+        bool any = false;
+        while (event_queue::receive_leds(bus, evt)) {
+            if (any) metrics::inc(metrics::Counter::LED_COALESCED);
+            any = true;
+            s_bus_leds[bus] = evt.leds;
+            if (bus == focus && !s_leds_pending) {
+                s_leds_pending   = true;
+                s_leds_posted_us = evt.t_posted_us;
+            }
+        }
+    }
+
+    BleDevice* kbd = &s_keyboard;
+    if (kbd->status.state != DeviceState::CONNECTED || !kbd->led_report ||
+        !kbd->client || !kbd->client->isConnected()) return;
+
+    uint8_t leds = s_bus_leds[focus];
+    if (kbd->leds_sent == leds) {
+        s_leds_pending = false;
+        return;
+    }
+    bool response = !kbd->led_report->canWriteNoResponse();
+    if (!kbd->led_report->writeValue(&leds, 1, response)) {
+        metrics::inc(metrics::Counter::LED_WRITE_FAIL);
+        return;   // retried next iteration
+    }
+    kbd->leds_sent = leds;
+    metrics::inc(metrics::Counter::LED_WRITES);
+    if (s_leds_pending) {
+        metrics::record(metrics::Histogram::LED_SYNC_US, micros() - s_leds_posted_us);
+        s_leds_pending = false;
+    }
 }
 
 void task_loop() {
@@ -822,11 +1123,10 @@ void task_loop() {
             s_pending_connect = false;
             try_connect(s_pending_addr, s_pending_name);
 
-            // Resume scanning if we still need devices
+            // Pause before re-scan if we still need devices
             if (s_keyboard.status.state == DeviceState::DISCONNECTED ||
                 s_mouse.status.state == DeviceState::DISCONNECTED) {
-                vTaskDelay(pdMS_TO_TICKS(2000));  // pause before re-scan
-                start_scan();
+                vTaskDelay(pdMS_TO_TICKS(2000));
             }
         }
 
@@ -861,24 +1161,29 @@ void task_loop() {
         handle_reconnection(&s_keyboard, "KBD");
         handle_reconnection(&s_mouse, "MOU");
 
-        // Check for DISCONNECTED devices (not RECONNECTING) and restart scanning
-        if (!s_scanning && !s_pending_connect) {
-            if (s_keyboard.status.state == DeviceState::DISCONNECTED ||
-                s_mouse.status.state == DeviceState::DISCONNECTED) {
-                start_scan();
-            }
-        }
+        // Pick the scan mode for the current slot states. A connect attempt
+        // stops any running scan, so this also restarts it between attempts.
+        schedule_scan();
+
+        // Publish everything this iteration changed for Core 1 / OLED readers
+        refresh_conn_interval(&s_keyboard);
+        refresh_conn_interval(&s_mouse);
+        follow_host_mode();
+        sync_leds();
+        publish_status(&s_keyboard);
+        publish_status(&s_mouse);
+        publish_scan_stats(millis());
 
         vTaskDelay(pdMS_TO_TICKS(100));
     }
 }
 
 DeviceStatus get_keyboard_status() {
-    return s_keyboard.status;
+    return s_keyboard.published.read();
 }
 
 DeviceStatus get_mouse_status() {
-    return s_mouse.status;
+    return s_mouse.published.read();
 }
 
 bool keyboard_connected() {
@@ -889,41 +1194,59 @@ bool mouse_connected() {
     return s_mouse.status.state == DeviceState::CONNECTED;
 }
 
-uint32_t get_mouse_cb_count() {
-    return s_ble_mouse_cb_count;
+uint32_t get_kbd_last_ms() {
+    return s_ble_kbd_last_ms;
 }
 
-uint32_t get_kbd_cb_count() {
-    return s_ble_kbd_cb_count;
+uint32_t get_mouse_last_ms() {
+    return s_ble_mouse_last_ms;
 }
 
-uint32_t get_kbd_cb_used() {
-    return s_ble_kbd_cb_used;
+uint32_t get_kbd_ready_ms() {
+    return s_keyboard.ready_ms;
 }
 
-uint32_t get_kbd_cb_dropped() {
-    return s_ble_kbd_cb_dropped;
+uint32_t get_mouse_ready_ms() {
+    return s_mouse.ready_ms;
 }
 
-uint32_t get_kbd_last_ms() {
-    return s_ble_kbd_last_ms;
+ScanMode get_scan_mode() {
+    return s_scan_mode;
 }
 
-uint32_t get_mouse_last_ms() {
-    return s_ble_mouse_last_ms;
+void dump_scan_stats() {
+    static ScanStatsView view;   // static — keeps the caller's stack small
+    view = s_scan_view.read();
+    Serial.printf("[SCAN] mode:%s\n", scan_mode_str(view.mode));
+    for (int i = 0; i < NUM_SCAN_MODES; i++) {
+        const ScanModeStats& st = view.stats[i];
+        if (!st.entries && !st.time_ms) continue;
+        Serial.printf("[SCAN]   %-12s n:%lu t:%lus kJit:%luus(%lu) mJit:%luus(%lu)\n",
+                      scan_mode_str((ScanMode)i), st.entries, st.time_ms / 1000,
+                      st.kbd_jitter_samples ? (uint32_t)(st.kbd_jitter_dev_sum / st.kbd_jitter_samples) : 0,
+                      st.kbd_jitter_samples,
+                      st.mouse_jitter_samples ? (uint32_t)(st.mouse_jitter_dev_sum / st.mouse_jitter_samples) : 0,
+                      st.mouse_jitter_samples);
+    }
 }
 
-void dump_handle_stats() {
-    Serial.print("[DIAG] KBD handles: ");
-    for (int i = 0; i < MAX_TRACKED_HANDLES && s_kbd_handle_stats[i].count; i++) {
-        Serial.printf("h%d=%lu ", s_kbd_handle_stats[i].handle, s_kbd_handle_stats[i].count);
+void forget_devices() {
+    Preferences prefs;
+    if (prefs.begin(NVS_NAMESPACE, false)) {
+        prefs.clear();
+        prefs.end();
     }
-    Serial.println();
-    Serial.print("[DIAG] MOU handles: ");
-    for (int i = 0; i < MAX_TRACKED_HANDLES && s_mouse_handle_stats[i].count; i++) {
-        Serial.printf("h%d=%lu ", s_mouse_handle_stats[i].handle, s_mouse_handle_stats[i].count);
+
+    BleDevice* devices[] = { &s_keyboard, &s_mouse };
+    for (BleDevice* device : devices) {
+        if (device->status.state == DeviceState::RECONNECTING) {
+            device->status.state = DeviceState::DISCONNECTED;
+            device->status.name[0] = '\0';
+            device->boot_restore = false;
+            publish_status(device);
+        }
     }
-    Serial.println();
+    Serial.println("[BLE] Forgot saved keyboard/mouse roles");
 }
 
 } // namespace ble_hid_host
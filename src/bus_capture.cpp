@@ -0,0 +1,125 @@
+#include "bus_capture.h"
+#include "adb_platform.h"
+#include "spsc_ring.h"
+#include "metrics.h"
+#include "config.h"
+
+#include <Arduino.h>
+
+using namespace adb_platform;
+
+namespace bus_capture {
+
+// ─── Edge ring ──────────────────────────────────────────────────────────────
+
+// Entry: (timestamp_us << 1) | level after the edge.
+// Producer: capture loop (Core 1). Consumer: streamer task (Core 0).
+static SpscRing<uint32_t, BUS_CAPTURE_RING_SIZE> s_ring;
+static volatile bool s_overflowed = false;   // set by producer, cleared by consumer
+
+// ─── Capture (Core 1) ───────────────────────────────────────────────────────
+
+void capture_loop() {
+    Serial.println("[CAP] Bus capture started on core " + String(xPortGetCoreID()));
+
+    // The loop below never blocks, so IDLE1 would trip the task watchdog
+    disableCore1WDT();
+
+    // First entry records the starting level (not a real edge)
+    bool level = read_pin();
+    s_ring.push((micros_now() << 1) | level);
+
+    while (true) {
+        bool cur = read_pin();
+        if (cur == level) continue;
+
+        uint32_t t = micros_now();
+        level = cur;
+
+        uint32_t* slot = s_ring.claim();
+        if (slot) {
+            *slot = (t << 1) | level;
+            s_ring.commit();
+        } else {
+            s_overflowed = true;
+            metrics::inc(metrics::Counter::CAPTURE_DROPPED);
+        }
+    }
+}
+
+// ─── Streaming (Core 0) ─────────────────────────────────────────────────────
+
+static size_t put_varint(uint8_t* out, uint32_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        out[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    out[n++] = (uint8_t)v;
+    return n;
+}
+
+/// Encode up to BUS_CAPTURE_FRAME_EDGES edges from the ring into one frame.
+/// A frame ends early if the levels stop alternating (edges were dropped).
+/// @return frame length in bytes.
+static size_t build_frame(uint8_t* frame) {
+    uint32_t first = *s_ring.front();
+    s_ring.pop();
+
+    uint8_t flags = (first & 1) ? CAPTURE_FLAG_LEVEL : 0;
+    if (s_overflowed) {
+        s_overflowed = false;
+        flags |= CAPTURE_FLAG_OVERFLOW;
+    }
+
+    uint32_t t0 = (first >> 1) & CAPTURE_TIME_MASK;
+    size_t len = 0;
+    frame[len++] = CAPTURE_FRAME_SYNC0;
+    frame[len++] = CAPTURE_FRAME_SYNC1;
+    frame[len++] = 0;   // edge count, filled in below
+    frame[len++] = flags;
+    for (int b = 0; b < 4; b++) frame[len++] = (t0 >> (8 * b)) & 0xFF;
+
+    uint32_t count = 1;
+    uint32_t prev = first;
+    const uint32_t* next;
+    while (count < BUS_CAPTURE_FRAME_EDGES && (next = s_ring.front()) != nullptr) {
+        uint32_t entry = *next;
+        if ((entry & 1) == (prev & 1)) break;   // gap in the edge sequence
+
+        uint32_t delta = ((entry >> 1) - (prev >> 1)) & CAPTURE_TIME_MASK;
+        len += put_varint(frame + len, delta);
+        s_ring.pop();
+        prev = entry;
+        count++;
+    }
+    frame[2] = (uint8_t)count;
+
+    uint8_t x = 0;
+    for (size_t i = 2; i < len; i++) x ^= frame[i];
+    frame[len++] = x;
+
+    metrics::inc(metrics::Counter::CAPTURE_EDGES, count);
+    return len;
+}
+
+void stream_task_loop() {
+    Serial.println("[CAP] Streamer started on core " + String(xPortGetCoreID()));
+
+    static uint8_t frame[8 + 5 * BUS_CAPTURE_FRAME_EDGES + 1];
+
+    while (true) {
+        metrics::set_max(metrics::Gauge::CAPTURE_RING_HWM, s_ring.size());
+
+        if (s_ring.empty()) {
+            vTaskDelay(pdMS_TO_TICKS(BUS_CAPTURE_FLUSH_MS));
+            continue;
+        }
+
+        // Serial.write() may block on the UART — fine here, Core 1 keeps capturing
+        size_t len = build_frame(frame);
+        Serial.write(frame, len);
+    }
+}
+
+} // namespace bus_capture
@@ -0,0 +1,134 @@
+#include "deferred_log.h"
+#include "spsc_ring.h"
+#include "metrics.h"
+#include "config.h"
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <hal/cpu_hal.h>
+
+namespace deferred_log {
+
+// ─── Token table ────────────────────────────────────────────────────────────
+
+static const char* const s_formats[] = {
+#define LOG_TOKEN_FORMAT(id, fmt) fmt,
+    LOG_TOKEN_LIST(LOG_TOKEN_FORMAT)
+#undef LOG_TOKEN_FORMAT
+};
+
+// ─── Per-core rings ─────────────────────────────────────────────────────────
+
+// Producers: any task or ISR on the ring's core — serialized by masking
+// interrupts around claim/commit, so the ring stays single-producer.
+// Consumer: the log task on Core 0.
+static SpscRing<Record, LOG_RING_SIZE> s_rings[2];
+
+void init() {
+    // Rings are statically zeroed — nothing to allocate.
+}
+
+// ─── Producer side ──────────────────────────────────────────────────────────
+
+void IRAM_ATTR write(Token token, uint8_t nargs, const uint32_t* args) {
+    uint32_t start = cpu_hal_get_cycle_count();
+    int core = xPortGetCoreID();
+    if (nargs > LOG_MAX_ARGS) nargs = LOG_MAX_ARGS;
+
+    // Interrupts masked for the claim/fill/commit only (bounded: one fixed-size
+    // record copy, no loops over caller data beyond LOG_MAX_ARGS words).
+    uint32_t irq = portSET_INTERRUPT_MASK_FROM_ISR();
+
+    Record* rec = s_rings[core].claim();
+    if (rec) {
+        rec->timestamp_us = (uint32_t)esp_timer_get_time();
+        rec->token = (uint16_t)token;
+        rec->core  = (uint8_t)core;
+        rec->nargs = nargs;
+        for (uint8_t i = 0; i < nargs; i++) {
+            rec->args[i] = args[i];
+        }
+        s_rings[core].commit();
+        metrics::inc(metrics::Counter::LOG_RECORDS);
+    } else {
+        metrics::inc(metrics::Counter::LOG_DROPPED);
+    }
+
+    // Worst-case cost per core (each gauge is written only from its core)
+    metrics::set_max(core ? metrics::Gauge::LOG_CYCLES_MAX_CORE1
+                          : metrics::Gauge::LOG_CYCLES_MAX_CORE0,
+                     cpu_hal_get_cycle_count() - start);
+
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(irq);
+}
+
+// ─── Consumer side ──────────────────────────────────────────────────────────
+
+#if ADB_LOG_BINARY
+static void emit(const Record& rec) {
+    uint8_t frame[2 + 8 + 4 * LOG_MAX_ARGS + 1];
+    size_t n = 0;
+    frame[n++] = LOG_FRAME_SYNC0;
+    frame[n++] = LOG_FRAME_SYNC1;
+    frame[n++] = rec.token & 0xFF;
+    frame[n++] = rec.token >> 8;
+    frame[n++] = rec.core;
+    frame[n++] = rec.nargs;
+    for (int b = 0; b < 4; b++) frame[n++] = (rec.timestamp_us >> (8 * b)) & 0xFF;
+    for (uint8_t i = 0; i < rec.nargs; i++) {
+        for (int b = 0; b < 4; b++) frame[n++] = (rec.args[i] >> (8 * b)) & 0xFF;
+    }
+    uint8_t x = 0;
+    for (size_t i = 2; i < n; i++) x ^= frame[i];
+    frame[n++] = x;
+    Serial.write(frame, n);
+}
+#else
+static void emit(const Record& rec) {
+    if (rec.token >= (uint16_t)Token::COUNT) return;
+    static_assert(LOG_MAX_ARGS == 4, "emit() passes exactly four arguments");
+    uint32_t a[LOG_MAX_ARGS] = {0};
+    for (uint8_t i = 0; i < rec.nargs; i++) a[i] = rec.args[i];
+    // Unused trailing arguments are ignored by printf
+    char line[128];
+    snprintf(line, sizeof(line), s_formats[rec.token],
+             (unsigned long)a[0], (unsigned long)a[1],
+             (unsigned long)a[2], (unsigned long)a[3]);
+    Serial.println(line);
+}
+#endif
+
+/// Emit the oldest pending record across both cores.
+/// @return false if both rings are empty.
+static bool drain_one() {
+    const Record* r0 = s_rings[0].front();
+    const Record* r1 = s_rings[1].front();
+    if (!r0 && !r1) return false;
+
+    int core;
+    if (!r0)      core = 1;
+    else if (!r1) core = 0;
+    else          core = ((int32_t)(r1->timestamp_us - r0->timestamp_us) < 0) ? 1 : 0;
+
+    emit(*s_rings[core].front());
+    s_rings[core].pop();
+    return true;
+}
+
+void task_loop() {
+    uint32_t reported_drops = 0;
+
+    while (true) {
+        while (drain_one()) {}
+
+        uint32_t drops = metrics::read(metrics::Counter::LOG_DROPPED);
+        if (drops != reported_drops) {
+            Serial.printf("[LOG] %lu records dropped (ring full)\n", drops - reported_drops);
+            reported_drops = drops;
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(LOG_DRAIN_INTERVAL_MS));
+    }
+}
+
+} // namespace deferred_log
@@ -1,46 +1,119 @@
 #include "event_queue.h"
+#include "host_presence.h"
+#include "metrics.h"
+#include "spsc_ring.h"
 #include "config.h"
 
+#include <Arduino.h>
+
 namespace event_queue {
 
-static QueueHandle_t s_kbd_queue   = nullptr;
-static QueueHandle_t s_mouse_queue = nullptr;
+static QueueHandle_t s_kbd_queue[ADB_BUS_COUNT]   = {};
+static QueueHandle_t s_mouse_queue[ADB_BUS_COUNT] = {};
+static volatile uint8_t s_focus = 0;    // written by the input task, read anywhere
+static SpscRing<LedEvent, LED_QUEUE_SIZE> s_led_ring[ADB_BUS_COUNT];
 
 void init() {
-    s_kbd_queue   = xQueueCreate(KBD_QUEUE_SIZE,   sizeof(KbdEvent));
-    s_mouse_queue = xQueueCreate(MOUSE_QUEUE_SIZE, sizeof(MouseEvent));
+    for (int bus = 0; bus < ADB_BUS_COUNT; bus++) {
+        s_kbd_queue[bus]   = xQueueCreate(KBD_QUEUE_SIZE,   sizeof(KbdEvent));
+        s_mouse_queue[bus] = xQueueCreate(MOUSE_QUEUE_SIZE, sizeof(MouseEvent));
+    }
+}
+
+QueueHandle_t kbd_queue(uint8_t bus) {
+    return s_kbd_queue[bus];
+}
+
+QueueHandle_t mouse_queue(uint8_t bus) {
+    return s_mouse_queue[bus];
 }
 
-QueueHandle_t kbd_queue() {
-    return s_kbd_queue;
+uint8_t focus() {
+    return s_focus;
 }
 
-QueueHandle_t mouse_queue() {
-    return s_mouse_queue;
+void set_focus(uint8_t bus) {
+    if (bus < ADB_BUS_COUNT) s_focus = bus;
 }
 
 bool send_kbd(const KbdEvent& evt) {
-    return xQueueSend(s_kbd_queue, &evt, 0) == pdTRUE;
+    return send_kbd(s_focus, evt);
+}
+
+bool send_kbd(uint8_t bus, const KbdEvent& evt) {
+    // Nobody polling: the keys would only replay when the Mac wakes
+    if (!host_presence::present(bus)) {
+        metrics::inc(metrics::Counter::HOST_DISCARDED);
+        return true;
+    }
+    KbdEvent stamped = evt;
+    stamped.t_queued_us = micros();
+    if (xQueueSend(s_kbd_queue[bus], &stamped, 0) != pdTRUE) {
+        metrics::inc(metrics::Counter::KBD_QUEUE_DROPS);
+        return false;
+    }
+    metrics::set_max(kbd_hwm_gauge(bus), uxQueueMessagesWaiting(s_kbd_queue[bus]));
+    metrics::record(metrics::Histogram::KBD_NOTIFY_TO_QUEUE_US,
+                    stamped.t_queued_us - stamped.t_capture_us);
+    return true;
 }
 
 bool send_mouse(const MouseEvent& evt) {
-    return xQueueSend(s_mouse_queue, &evt, 0) == pdTRUE;
+    return send_mouse(s_focus, evt);
+}
+
+bool send_mouse(uint8_t bus, const MouseEvent& evt) {
+    if (!host_presence::present(bus)) {
+        metrics::inc(metrics::Counter::HOST_DISCARDED);
+        return true;
+    }
+    MouseEvent stamped = evt;
+    stamped.t_queued_us = micros();
+    if (xQueueSend(s_mouse_queue[bus], &stamped, 0) != pdTRUE) {
+        metrics::inc(metrics::Counter::MOUSE_QUEUE_DROPS);
+        return false;
+    }
+    metrics::set_max(mouse_hwm_gauge(bus), uxQueueMessagesWaiting(s_mouse_queue[bus]));
+    metrics::record(metrics::Histogram::MOUSE_NOTIFY_TO_QUEUE_US,
+                    stamped.t_queued_us - stamped.t_capture_us);
+    return true;
+}
+
+bool receive_kbd(uint8_t bus, KbdEvent& evt) {
+    return xQueueReceive(s_kbd_queue[bus], &evt, 0) == pdTRUE;
+}
+
+bool receive_mouse(uint8_t bus, MouseEvent& evt) {
+    return xQueueReceive(s_mouse_queue[bus], &evt, 0) == pdTRUE;
+}
+
+bool kbd_pending(uint8_t bus) {
+    return uxQueueMessagesWaiting(s_kbd_queue[bus]) > 0;
+}
+
+bool mouse_pending(uint8_t bus) {
+    return uxQueueMessagesWaiting(s_mouse_queue[bus]) > 0;
 }
 
-bool receive_kbd(KbdEvent& evt) {
-    return xQueueReceive(s_kbd_queue, &evt, 0) == pdTRUE;
+metrics::Gauge kbd_hwm_gauge(uint8_t bus) {
+    return bus ? metrics::Gauge::KBD_QUEUE_HWM_B : metrics::Gauge::KBD_QUEUE_HWM;
 }
 
-bool receive_mouse(MouseEvent& evt) {
-    return xQueueReceive(s_mouse_queue, &evt, 0) == pdTRUE;
+metrics::Gauge mouse_hwm_gauge(uint8_t bus) {
+    return bus ? metrics::Gauge::MOUSE_QUEUE_HWM_B : metrics::Gauge::MOUSE_QUEUE_HWM;
 }
 
-bool kbd_pending() {
-    return uxQueueMessagesWaiting(s_kbd_queue) > 0;
+bool post_leds(uint8_t bus, const LedEvent& evt) {
+    if (!s_led_ring[bus].push(evt)) {
+        metrics::inc(metrics::Counter::LED_DROPPED);
+        return false;
+    }
+    metrics::inc(metrics::Counter::LED_POSTED);
+    return true;
 }
 
-bool mouse_pending() {
-    return uxQueueMessagesWaiting(s_mouse_queue) > 0;
+bool receive_leds(uint8_t bus, LedEvent& evt) {
+    return s_led_ring[bus].pop(evt);
 }
 
 } // namespace event_queue
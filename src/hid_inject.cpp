@@ -0,0 +1,158 @@
+#include "hid_inject.h"
+#include "input_stage.h"
+#include "serial_console.h"
+#include "metrics.h"
+#include "config.h"
+
+#include <Arduino.h>
+
+#if ADB_HID_INJECT
+
+namespace hid_inject {
+
+// ─── Frame parser (serial reader task only) ─────────────────────────────────
+
+// RESYNC: after a bad frame, skip to the next sync byte so the rest of it
+// never reaches the console as text (a 0x0A/0x0D payload byte would end a
+// command line). A quiet line ends it too.
+enum Phase : uint8_t { IDLE, SYNC1, SEQ, KIND, LEN, PAYLOAD, CHECK, RESYNC };
+
+static uint8_t s_phase = IDLE;
+static uint8_t s_seq   = 0;
+static uint8_t s_kind  = 0;
+static uint8_t s_len   = 0;
+static uint8_t s_pos   = 0;
+static uint8_t s_xor   = 0;
+static uint8_t s_payload[HID_FRAME_MAX_PAYLOAD];
+
+static bool    s_have_seq = false;
+static uint8_t s_next_seq = 0;
+
+static void bad_frame() {
+    metrics::inc(metrics::Counter::HID_INJECT_BAD);
+    s_phase = RESYNC;
+}
+
+static void deliver() {
+    // Frames the link lost show up as a jump in seq
+    if (s_have_seq && s_seq != s_next_seq) {
+        metrics::inc(metrics::Counter::HID_INJECT_SEQ_LOST, (uint8_t)(s_seq - s_next_seq));
+    }
+    s_have_seq = true;
+    s_next_seq = s_seq + 1;
+    metrics::inc(metrics::Counter::HID_INJECT_FRAMES);
+
+    using input_stage::ReportKind;
+    switch (s_kind) {
+        case HID_FRAME_KEYBOARD:
+            input_stage::post_injected(ReportKind::KEYBOARD, s_payload, s_len);
+            break;
+        case HID_FRAME_MOUSE:
+            input_stage::post_injected(ReportKind::MOUSE, s_payload, s_len);
+            break;
+        case HID_FRAME_RESET_KBD:
+            input_stage::post_injected(ReportKind::RESET_KEYBOARD, nullptr, 0);
+            break;
+        case HID_FRAME_RESET_MOUSE:
+            input_stage::post_injected(ReportKind::RESET_MOUSE, nullptr, 0);
+            break;
+    }
+}
+
+/// Run one byte through the frame parser.
+/// @return false if it isn't part of a frame (console input).
+static bool parse(uint8_t byte) {
+    switch (s_phase) {
+        case IDLE:
+            if (byte != HID_FRAME_SYNC0) return false;
+            s_phase = SYNC1;
+            return true;
+        case RESYNC:
+            if (byte == HID_FRAME_SYNC0) s_phase = SYNC1;
+            return true;
+        case SYNC1:
+            // Not a frame after all; the lone sync byte is lost
+            if (byte != HID_FRAME_SYNC1) {
+                s_phase = IDLE;
+                return false;
+            }
+            s_phase = SEQ;
+            return true;
+        case SEQ:
+            s_seq   = byte;
+            s_xor   = byte;
+            s_phase = KIND;
+            return true;
+        case KIND:
+            if (byte > HID_FRAME_RESET_MOUSE) {
+                bad_frame();
+                return true;
+            }
+            s_kind  = byte;
+            s_xor  ^= byte;
+            s_phase = LEN;
+            return true;
+        case LEN:
+            if (byte > HID_FRAME_MAX_PAYLOAD) {
+                bad_frame();
+                return true;
+            }
+            s_len   = byte;
+            s_pos   = 0;
+            s_xor  ^= byte;
+            s_phase = byte ? PAYLOAD : CHECK;
+            return true;
+        case PAYLOAD:
+            s_payload[s_pos++] = byte;
+            s_xor ^= byte;
+            if (s_pos == s_len) s_phase = CHECK;
+            return true;
+        case CHECK:
+            if (byte != s_xor) {
+                bad_frame();
+                return true;
+            }
+            deliver();
+            s_phase = IDLE;
+            return true;
+    }
+    return false;
+}
+
+// ─── Serial reader task ─────────────────────────────────────────────────────
+
+void task_loop() {
+    Serial.printf("[INJECT] Serial reader started on core %d (%d baud)\n",
+                  xPortGetCoreID(), HID_INJECT_BAUD);
+
+    uint32_t last_byte_ms = 0;
+    while (true) {
+        int ch;
+        while (serial_console::accepting() && (ch = Serial.read()) >= 0) {
+            last_byte_ms = millis();
+            uint8_t byte = (uint8_t)ch;
+            // Paste mode: everything is text, frame bytes included
+            if (serial_console::raw_mode() || !parse(byte)) {
+                serial_console::feed(byte);
+            }
+        }
+        serial_console::service();
+
+        // A frame cut short by the link would otherwise eat the next one.
+        // Its late tail is skipped; a further quiet spell ends the skipping.
+        if (s_phase != IDLE && millis() - last_byte_ms > HID_INJECT_FRAME_TIMEOUT_MS) {
+            if (s_phase == RESYNC) {
+                s_phase = IDLE;
+            } else {
+                bad_frame();
+                last_byte_ms = millis();
+            }
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(HID_INJECT_POLL_MS));
+    }
+}
+
+} // namespace hid_inject
+
+#endif // ADB_HID_INJECT
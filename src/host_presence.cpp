@@ -0,0 +1,94 @@
+#include "host_presence.h"
+#include "adb_keyboard.h"
+#include "adb_mouse.h"
+#include "metrics.h"
+#include "config.h"
+
+#include <Arduino.h>
+
+namespace host_presence {
+
+// ─── Per-bus state (written by that bus's engine) ───────────────────────────
+
+// millis() of the last command, and of the first one after an absence.
+// Starting at 0 gives a host HOST_ABSENT_MS after boot to show up.
+static volatile uint32_t s_last_cmd_ms[ADB_BUS_COUNT] = {};
+static volatile uint32_t s_found_ms[ADB_BUS_COUNT]    = {};
+static bool              s_discarded[ADB_BUS_COUNT]   = {};  // devices emptied this absence
+
+void on_command(uint8_t bus) {
+    uint32_t now = millis();
+    if (now - s_last_cmd_ms[bus] >= HOST_ABSENT_MS) s_found_ms[bus] = now;
+    s_last_cmd_ms[bus] = now;
+}
+
+bool present(uint8_t bus) {
+    return millis() - s_last_cmd_ms[bus] < HOST_ABSENT_MS;
+}
+
+bool gone(uint8_t bus) {
+    if (present(bus)) {
+        s_discarded[bus] = false;
+        return false;
+    }
+    if (!s_discarded[bus]) {
+        s_discarded[bus] = true;
+        adb_keyboard::discard(bus);
+        adb_mouse::discard(bus);
+    }
+    return true;
+}
+
+// ─── Pipeline mode (BLE task) ───────────────────────────────────────────────
+
+static bool     s_active       = true;
+static uint32_t s_since_ms     = 0;     // start of the current mode
+static uint32_t s_accounted_ms = 0;     // residency counted up to here
+static uint32_t s_active_since = 0;
+
+bool active() {
+    return s_active;
+}
+
+uint32_t active_since_ms() {
+    return s_active_since;
+}
+
+bool update() {
+    uint32_t now = millis();
+    bool any = false;
+    uint32_t found = 0;
+    for (uint8_t bus = 0; bus < ADB_BUS_COUNT; bus++) {
+        if (!present(bus)) continue;
+        // The bus that came back first
+        if (!any || (int32_t)(s_found_ms[bus] - found) < 0) found = s_found_ms[bus];
+        any = true;
+    }
+
+    metrics::inc(s_active ? metrics::Counter::HOST_ACTIVE_TIME_MS
+                          : metrics::Counter::HOST_ABSENT_TIME_MS,
+                 now - s_accounted_ms);
+    s_accounted_ms = now;
+
+    bool changed = (any != s_active);
+    uint32_t stint_ms = now - s_since_ms;
+    s_active = any;
+    metrics::set(metrics::Gauge::HOST_ACTIVE, any);
+    if (!changed) return false;
+
+    s_since_ms = now;
+    if (any) {
+        s_active_since = found;
+        metrics::inc(metrics::Counter::HOST_FOUND);
+        metrics::record(metrics::Histogram::HOST_AWAY_S, stint_ms / 1000);
+        Serial.printf("[HOST] Mac polling again after %lu.%lus away — low-latency mode\n",
+                      stint_ms / 1000, (stint_ms % 1000) / 100);
+    } else {
+        metrics::inc(metrics::Counter::HOST_LOST);
+        Serial.printf("[HOST] No poll for %lums — Mac asleep or off, low-power mode\n",
+                      HOST_ABSENT_MS);
+    }
+    return true;
+}
+
+} // namespace host_presence
@@ -0,0 +1,443 @@
+#include "input_stage.h"
+#include "event_queue.h"
+#include "keycode_map.h"
+#include "spsc_ring.h"
+#include "seqlock.h"
+#include "metrics.h"
+#include "config.h"
+
+#include <Arduino.h>
+
+namespace input_stage {
+
+// ─── Ring and task ──────────────────────────────────────────────────────────
+
+// Producer: NimBLE host task (notification and disconnect callbacks).
+// Consumer: input task.
+static SpscRing<RawReport, INPUT_RING_SIZE> s_ring;
+#if ADB_HID_INJECT
+// Producer: serial reader task (hid_inject). Consumer: input task.
+static SpscRing<RawReport, INPUT_RING_SIZE> s_injected_ring;
+#endif
+static TaskHandle_t s_task = nullptr;
+
+// ─── Parser state ───────────────────────────────────────────────────────────
+
+static uint8_t s_prev_keys[6]   = {0};
+static uint8_t s_prev_modifiers = 0;
+static bool    s_prev_buttons   = false;
+
+#if ADB_BUS_B
+// Keys held when the KVM hotkey moved the focus. Their presses went to the
+// old bus (which got a release at the switch), so their releases must not
+// reach the new one.
+static uint8_t s_swallow_keys[6]   = {0};
+static uint8_t s_swallow_modifiers = 0;
+#endif
+
+// ─── Diagnostics ────────────────────────────────────────────────────────────
+// Counters and stage timings live in the metrics registry (INPUT_*).
+
+// Notification inter-arrival jitter (input task only).
+// Mean interval is an EWMA with alpha = 1/16, kept ×16 for precision.
+// The accumulators are published through a seqlock so get_jitter() never
+// sees a sample count that doesn't match the 64-bit sum.
+struct JitterTracker {
+    uint32_t last_us;
+    uint32_t mean_x16;
+    JitterStats totals;
+    Seqlock<JitterStats> published;
+};
+static JitterTracker s_kbd_jitter;
+static JitterTracker s_mouse_jitter;
+
+static void track_jitter(JitterTracker& jt, uint32_t timestamp_us) {
+    uint32_t interval = timestamp_us - jt.last_us;
+    bool had_last = jt.last_us != 0;
+    jt.last_us = timestamp_us;
+    if (!had_last || interval > INPUT_JITTER_GAP_US) return;
+
+    if (jt.mean_x16 == 0) {
+        jt.mean_x16 = interval << 4;   // seed with first interval
+        return;
+    }
+    uint32_t mean = jt.mean_x16 >> 4;
+    uint32_t dev = (interval > mean) ? interval - mean : mean - interval;
+    jt.mean_x16 = jt.mean_x16 - (jt.mean_x16 >> 4) + interval;
+    jt.totals.abs_dev_sum_us += dev;
+    jt.totals.samples++;
+    jt.published.write(jt.totals);
+}
+
+// Per-handle tracking: which characteristic handles are firing and how often
+static constexpr int MAX_TRACKED_HANDLES = 10;
+struct HandleStats {
+    uint16_t handle;
+    uint32_t count;
+};
+static HandleStats s_kbd_handle_stats[MAX_TRACKED_HANDLES] = {};
+static HandleStats s_mouse_handle_stats[MAX_TRACKED_HANDLES] = {};
+
+static void track_handle(HandleStats* stats, uint16_t handle) {
+    for (int i = 0; i < MAX_TRACKED_HANDLES; i++) {
+        if (stats[i].handle == handle) { stats[i].count++; return; }
+        if (stats[i].count == 0) { stats[i].handle = handle; stats[i].count = 1; return; }
+    }
+}
+
+// ─── KVM focus (input task context) ─────────────────────────────────────────
+
+#if ADB_BUS_B
+static bool report_has_key(const uint8_t* data, size_t length, uint8_t usage) {
+    for (int j = 2; j < 8 && j < (int)length; j++) {
+        if (data[j] == usage) return true;
+    }
+    return false;
+}
+
+/// KVM_HOTKEY_MODIFIERS held and KVM_HOTKEY_USAGE newly pressed?
+static bool is_hotkey(const uint8_t* data, size_t length) {
+    if ((data[0] & KVM_HOTKEY_MODIFIERS) != KVM_HOTKEY_MODIFIERS) return false;
+    if (!report_has_key(data, length, KVM_HOTKEY_USAGE)) return false;
+    for (int i = 0; i < 6; i++) {
+        if (s_prev_keys[i] == KVM_HOTKEY_USAGE) return false;
+    }
+    return true;
+}
+
+/// Release everything held on the focused bus, then hand input to the
+/// other one. The report that triggered the switch becomes the baseline,
+/// so nothing held now is pressed on the new bus.
+static void switch_focus(const uint8_t* data, size_t length, uint32_t t_capture_us) {
+    uint8_t old_bus = event_queue::focus();
+
+    KbdEvent evt;
+    evt.t_capture_us = t_capture_us;
+    evt.released = true;
+    for (int i = 0; i < keycode_map::MODIFIER_MAP_SIZE; i++) {
+        if (s_prev_modifiers & keycode_map::MODIFIER_MAP[i].usb_mask) {
+            evt.adb_keycode = keycode_map::MODIFIER_MAP[i].adb_keycode;
+            event_queue::send_kbd(old_bus, evt);
+        }
+    }
+    for (int i = 0; i < 6; i++) {
+        uint8_t adb_code = s_prev_keys[i] ? keycode_map::usb_to_adb(s_prev_keys[i])
+                                          : keycode_map::ADB_KEY_NONE;
+        if (adb_code != keycode_map::ADB_KEY_NONE) {
+            evt.adb_keycode = adb_code;
+            event_queue::send_kbd(old_bus, evt);
+        }
+    }
+    if (s_prev_buttons) {
+        MouseEvent up;
+        up.dx = 0;
+        up.dy = 0;
+        up.button = false;
+        up.t_capture_us = t_capture_us;
+        event_queue::send_mouse(old_bus, up);
+        s_prev_buttons = false;
+    }
+
+    event_queue::set_focus(old_bus ^ 1);
+    metrics::inc(metrics::Counter::KVM_SWITCHES);
+    metrics::set(metrics::Gauge::KVM_FOCUS, old_bus ^ 1);
+
+    s_prev_modifiers = s_swallow_modifiers = data[0];
+    for (int i = 0; i < 6; i++) {
+        s_prev_keys[i] = s_swallow_keys[i] = (i + 2 < (int)length) ? data[i + 2] : 0;
+    }
+    Serial.printf("[KVM] Focus -> bus %c\n", (old_bus ^ 1) ? 'B' : 'A');
+}
+
+/// Drop a release (and forget the key) if it was held across a switch.
+static bool swallow_release(uint8_t usage) {
+    for (int i = 0; i < 6; i++) {
+        if (s_swallow_keys[i] == usage) {
+            s_swallow_keys[i] = 0;
+            return true;
+        }
+    }
+    return false;
+}
+#endif
+
+// ─── Report parsing (input task context) ────────────────────────────────────
+
+static void parse_keyboard_report(const uint8_t* data, size_t length, uint32_t t_capture_us) {
+    if (length < 8) {
+        metrics::inc(metrics::Counter::INPUT_KBD_SHORT);
+        return;
+    }
+    metrics::inc(metrics::Counter::INPUT_KBD_USED);
+
+    uint8_t modifiers = data[0];
+
+#if ADB_BUS_B
+    if (is_hotkey(data, length)) {
+        switch_focus(data, length, t_capture_us);
+        return;
+    }
+    // Modifiers held across a switch stay silent, release included
+    uint8_t mod_diff = (modifiers ^ s_prev_modifiers) & ~s_swallow_modifiers;
+    s_swallow_modifiers &= modifiers;
+    s_prev_modifiers = modifiers;
+#else
+    // Process modifier key changes
+    uint8_t mod_diff = modifiers ^ s_prev_modifiers;
+#endif
+    if (mod_diff) {
+        for (int i = 0; i < keycode_map::MODIFIER_MAP_SIZE; i++) {
+            uint8_t mask = keycode_map::MODIFIER_MAP[i].usb_mask;
+            if (mod_diff & mask) {
+                KbdEvent evt;
+                evt.t_capture_us = t_capture_us;
+                evt.adb_keycode = keycode_map::MODIFIER_MAP[i].adb_keycode;
+                evt.released = !(modifiers & mask);
+                event_queue::send_kbd(evt);
+
+#if ADB_DEBUG_VERBOSE
+                Serial.printf("[INPUT] Modifier %s: ADB=0x%02X\n",
+                              evt.released ? "up" : "down", evt.adb_keycode);
+#endif
+            }
+        }
+        s_prev_modifiers = modifiers;
+    }
+
+    // Detect releases: keys in prev but not in current
+    for (int i = 0; i < 6; i++) {
+        uint8_t prev_key = s_prev_keys[i];
+        if (prev_key == 0) continue;
+
+        bool still_pressed = false;
+        for (int j = 2; j < 8 && j < (int)length; j++) {
+            if (data[j] == prev_key) {
+                still_pressed = true;
+                break;
+            }
+        }
+
+#if ADB_BUS_B
+        if (!still_pressed && swallow_release(prev_key)) continue;
+#endif
+        if (!still_pressed) {
+            uint8_t adb_code = keycode_map::usb_to_adb(prev_key);
+            if (adb_code != keycode_map::ADB_KEY_NONE) {
+                KbdEvent evt;
+                evt.t_capture_us = t_capture_us;
+                evt.adb_keycode = adb_code;
+                evt.released = true;
+                event_queue::send_kbd(evt);
+
+#if ADB_DEBUG_VERBOSE
+                Serial.printf("[INPUT] Key up: USB=0x%02X ADB=0x%02X\n", prev_key, adb_code);
+#endif
+            }
+        }
+    }
+
+    // Detect presses: keys in current but not in prev
+    for (int j = 2; j < 8 && j < (int)length; j++) {
+        uint8_t cur_key = data[j];
+        if (cur_key == 0) continue;
+
+        bool was_pressed = false;
+        for (int i = 0; i < 6; i++) {
+            if (s_prev_keys[i] == cur_key) {
+                was_pressed = true;
+                break;
+            }
+        }
+
+        if (!was_pressed) {
+            uint8_t adb_code = keycode_map::usb_to_adb(cur_key);
+            if (adb_code != keycode_map::ADB_KEY_NONE) {
+                KbdEvent evt;
+                evt.t_capture_us = t_capture_us;
+                evt.adb_keycode = adb_code;
+                evt.released = false;
+                event_queue::send_kbd(evt);
+
+#if ADB_DEBUG_VERBOSE
+                Serial.printf("[INPUT] Key down: USB=0x%02X ADB=0x%02X\n", cur_key, adb_code);
+#endif
+            }
+        }
+    }
+
+    // Save current state for next diff
+    for (int i = 0; i < 6; i++) {
+        s_prev_keys[i] = (i + 2 < (int)length) ? data[i + 2] : 0;
+    }
+}
+
+static void parse_mouse_report(const uint8_t* data, size_t length, uint32_t t_capture_us) {
+    if (length < 3) {
+        metrics::inc(metrics::Counter::INPUT_MOUSE_SHORT);
+        return;
+    }
+
+    MouseEvent evt;
+    evt.t_capture_us = t_capture_us;
+
+    if (length >= 5) {
+        // Report Protocol: 5-7 bytes
+        // [buttons] [X_lo] [X_hi] [Y_lo] [Y_hi] [scroll_lo] [scroll_hi]
+        evt.button = (data[0] & 0x01) != 0;
+        evt.dx = (int16_t)(data[1] | (data[2] << 8));
+        evt.dy = (int16_t)(data[3] | (data[4] << 8));
+    } else {
+        // Boot Protocol: 3 bytes [buttons] [dx_8bit] [dy_8bit]
+        evt.button = (data[0] & 0x01) != 0;
+        evt.dx = (int8_t)data[1];
+        evt.dy = (int8_t)data[2];
+    }
+
+    event_queue::send_mouse(evt);
+
+#if ADB_DEBUG_VERBOSE
+    if (evt.dx != 0 || evt.dy != 0 || evt.button != s_prev_buttons) {
+        Serial.printf("[INPUT] Mouse: btn=%d dx=%d dy=%d\n",
+                      evt.button, evt.dx, evt.dy);
+    }
+#endif
+
+    s_prev_buttons = evt.button;
+}
+
+static void process_report(const RawReport& rpt) {
+    switch (rpt.kind) {
+        case ReportKind::KEYBOARD:
+            track_handle(s_kbd_handle_stats, rpt.handle);
+            track_jitter(s_kbd_jitter, rpt.timestamp_us);
+            parse_keyboard_report(rpt.data, rpt.length, rpt.timestamp_us);
+            break;
+
+        case ReportKind::MOUSE:
+            track_handle(s_mouse_handle_stats, rpt.handle);
+            track_jitter(s_mouse_jitter, rpt.timestamp_us);
+            parse_mouse_report(rpt.data, rpt.length, rpt.timestamp_us);
+            break;
+
+        case ReportKind::RESET_KEYBOARD:
+            memset(s_prev_keys, 0, sizeof(s_prev_keys));
+            s_prev_modifiers = 0;
+#if ADB_BUS_B
+            memset(s_swallow_keys, 0, sizeof(s_swallow_keys));
+            s_swallow_modifiers = 0;
+#endif
+            s_kbd_jitter.last_us = 0;
+            s_kbd_jitter.mean_x16 = 0;
+            break;
+
+        case ReportKind::RESET_MOUSE:
+            s_prev_buttons = false;
+            s_mouse_jitter.last_us = 0;
+            s_mouse_jitter.mean_x16 = 0;
+            break;
+    }
+}
+
+// ─── Public interface ───────────────────────────────────────────────────────
+
+void init() {
+    memset(s_prev_keys, 0, sizeof(s_prev_keys));
+    s_prev_modifiers = 0;
+    s_prev_buttons = false;
+}
+
+/// Copy a report into `ring`. Each ring has its own producer task and its
+/// own high-water gauge, so every gauge keeps a single writer.
+static bool post_to(SpscRing<RawReport, INPUT_RING_SIZE>& ring, metrics::Gauge hwm,
+                    ReportKind kind, uint16_t handle, const uint8_t* data, size_t length) {
+    uint32_t start = ESP.getCycleCount();
+
+    RawReport* slot = ring.claim();
+    if (!slot) {
+        metrics::inc(metrics::Counter::INPUT_RING_FULL);
+        return false;
+    }
+
+    if (length > INPUT_REPORT_MAX_LEN) {
+        length = INPUT_REPORT_MAX_LEN;
+        metrics::inc(metrics::Counter::INPUT_TRUNCATED);
+    }
+    slot->timestamp_us = micros();
+    slot->handle = handle;
+    slot->kind = kind;
+    slot->length = (uint8_t)length;
+    if (length) memcpy(slot->data, data, length);
+    ring.commit();
+
+    metrics::set_max(hwm, ring.size());
+
+    if (s_task) xTaskNotifyGive(s_task);
+
+    metrics::record(metrics::Histogram::INPUT_CAPTURE_CYCLES, ESP.getCycleCount() - start);
+    return true;
+}
+
+bool post_report(ReportKind kind, uint16_t handle,
+                 const uint8_t* data, size_t length) {
+    return post_to(s_ring, metrics::Gauge::INPUT_RING_HWM, kind, handle, data, length);
+}
+
+void post_reset(ReportKind kind) {
+    post_report(kind, 0, nullptr, 0);
+}
+
+#if ADB_HID_INJECT
+bool post_injected(ReportKind kind, const uint8_t* data, size_t length) {
+    return post_to(s_injected_ring, metrics::Gauge::INPUT_INJECT_RING_HWM,
+                   kind, INJECTED_HANDLE, data, length);
+}
+#endif
+
+static void drain(SpscRing<RawReport, INPUT_RING_SIZE>& ring) {
+    const RawReport* rpt;
+    while ((rpt = ring.front()) != nullptr) {
+        uint32_t wait_us = micros() - rpt->timestamp_us;
+        uint32_t start = ESP.getCycleCount();
+
+        process_report(*rpt);
+        ring.pop();
+
+        metrics::inc(metrics::Counter::INPUT_REPORTS);
+        metrics::record(metrics::Histogram::INPUT_WAIT_US, wait_us);
+        metrics::record(metrics::Histogram::INPUT_PARSE_CYCLES, ESP.getCycleCount() - start);
+    }
+}
+
+void task_loop() {
+    Serial.println("[INPUT] Task loop started on core " + String(xPortGetCoreID()));
+    s_task = xTaskGetCurrentTaskHandle();
+
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        drain(s_ring);
+#if ADB_HID_INJECT
+        drain(s_injected_ring);
+#endif
+    }
+}
+
+JitterStats get_jitter(bool keyboard) {
+    const JitterTracker& jt = keyboard ? s_kbd_jitter : s_mouse_jitter;
+    return jt.published.read();
+}
+
+void dump_handle_stats() {
+    Serial.print("[DIAG] KBD handles: ");
+    for (int i = 0; i < MAX_TRACKED_HANDLES && s_kbd_handle_stats[i].count; i++) {
+        Serial.printf("h%d=%lu ", s_kbd_handle_stats[i].handle, s_kbd_handle_stats[i].count);
+    }
+    Serial.println();
+    Serial.print("[DIAG] MOU handles: ");
+    for (int i = 0; i < MAX_TRACKED_HANDLES && s_mouse_handle_stats[i].count; i++) {
+        Serial.printf("h%d=%lu ", s_mouse_handle_stats[i].handle, s_mouse_handle_stats[i].count);
+    }
+    Serial.println();
+}
+
+} // namespace input_stage
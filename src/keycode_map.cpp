@@ -210,4 +210,30 @@ uint8_t usb_to_adb(uint8_t usb_keycode) {
     return USB_TO_ADB[usb_keycode];
 }
 
+// ADB 7-bit keycode → key name (Apple Extended Keyboard legends).
+// nullptr = no key at that code.
+static const char* const ADB_KEY_NAMES[128] = {
+    /* 0x00 */ "A", "S", "D", "F", "H", "G", "Z", "X",
+    /* 0x08 */ "C", "V", "ISO-Section", "B", "Q", "W", "E", "R",
+    /* 0x10 */ "Y", "T", "1", "2", "3", "4", "6", "5",
+    /* 0x18 */ "=", "9", "7", "-", "8", "0", "]", "O",
+    /* 0x20 */ "U", "[", "I", "P", "Return", "L", "J", "'",
+    /* 0x28 */ "K", ";", "\\", ",", "/", "N", "M", ".",
+    /* 0x30 */ "Tab", "Space", "`", "Delete", nullptr, "Escape", "Control", "Command",
+    /* 0x38 */ "Shift", "CapsLock", "Option", "Left", "Right", "Down", "Up", nullptr,
+    /* 0x40 */ nullptr, "KP.", nullptr, "KP*", nullptr, "KP+", nullptr, "Clear",
+    /* 0x48 */ nullptr, nullptr, nullptr, "KP/", "KPEnter", nullptr, "KP-", nullptr,
+    /* 0x50 */ nullptr, "KP=", "KP0", "KP1", "KP2", "KP3", "KP4", "KP5",
+    /* 0x58 */ "KP6", "KP7", nullptr, "KP8", "KP9", nullptr, nullptr, nullptr,
+    /* 0x60 */ "F5", "F6", "F7", "F3", "F8", "F9", nullptr, "F11",
+    /* 0x68 */ nullptr, "F13", nullptr, "F14", nullptr, "F10", nullptr, "F12",
+    /* 0x70 */ nullptr, "F15", "Help", "Home", "PageUp", "FwdDelete", "F4", "End",
+    /* 0x78 */ "F2", "PageDown", "F1", "RShift", "ROption", "RControl", nullptr, "Power",
+};
+
+const char* adb_key_name(uint8_t adb_keycode) {
+    if (adb_keycode >= 128) return nullptr;
+    return ADB_KEY_NAMES[adb_keycode];
+}
+
 } // namespace keycode_map
@@ -3,21 +3,72 @@
 #include "config.h"
 #include "event_queue.h"
 #include "adb_protocol.h"
+#include "adb_platform.h"
 #include "ble_hid_host.h"
+#include "input_stage.h"
+#include "adb_keyboard.h"
 #include "adb_mouse.h"
 #include "oled_display.h"
+#include "deferred_log.h"
+#include "metrics.h"
+#include "bus_capture.h"
+#include "serial_console.h"
+#include "text_inject.h"
+#if ADB_HID_INJECT
+#include "hid_inject.h"
+#endif
+#if ADB_BUS_B
+#include "adb_rmt_bus.h"
+#endif
 
 // ─── Task Handles ───────────────────────────────────────────────────────────
 static TaskHandle_t s_adb_task  = nullptr;
 static TaskHandle_t s_ble_task  = nullptr;
+static TaskHandle_t s_input_task = nullptr;
 static TaskHandle_t s_oled_task = nullptr;
+static TaskHandle_t s_log_task  = nullptr;
+static TaskHandle_t s_type_task = nullptr;
+#if ADB_CORE1_ISOLATION
+static TaskHandle_t s_status_task = nullptr;
+#endif
+#if ADB_BUS_CAPTURE
+static TaskHandle_t s_capture_task = nullptr;
+#endif
+#if ADB_BUS_B
+static TaskHandle_t s_bus_b_task = nullptr;
+#endif
+#if ADB_HID_INJECT
+static TaskHandle_t s_inject_task = nullptr;
+#endif
+
+static metrics::Snapshot s_snap;    // static — too large for the loop stack
+
+/// Sample task stack watermarks and heap into their gauges.
+static void sample_system_gauges() {
+    metrics::set(metrics::Gauge::STACK_FREE_ADB,   uxTaskGetStackHighWaterMark(s_adb_task));
+    metrics::set(metrics::Gauge::STACK_FREE_BLE,   uxTaskGetStackHighWaterMark(s_ble_task));
+    metrics::set(metrics::Gauge::STACK_FREE_INPUT, uxTaskGetStackHighWaterMark(s_input_task));
+    metrics::set(metrics::Gauge::STACK_FREE_OLED,  uxTaskGetStackHighWaterMark(s_oled_task));
+    metrics::set(metrics::Gauge::STACK_FREE_LOG,   uxTaskGetStackHighWaterMark(s_log_task));
+    metrics::set(metrics::Gauge::STACK_FREE_LOOP,  uxTaskGetStackHighWaterMark(nullptr));
+    metrics::set(metrics::Gauge::HEAP_FREE,        ESP.getFreeHeap());
+    metrics::set(metrics::Gauge::HEAP_MIN_FREE,    ESP.getMinFreeHeap());
+}
 
 // ─── Task Functions ─────────────────────────────────────────────────────────
 
 /// ADB protocol loop — runs on Core 1 (timing-critical).
 /// Listens for host commands on the ADB bus and responds as keyboard/mouse.
 static void adb_task_func(void* param) {
-#if ADB_BUS_MONITOR
+    // Pin access (and the self-test timing it) belongs to this core
+    adb_platform::bind_core();
+#if ADB_SELF_TEST
+    adb_protocol::self_test();
+#endif
+
+#if ADB_BUS_CAPTURE
+    bus_capture::capture_loop();
+#elif ADB_BUS_MONITOR
     adb_protocol::bus_monitor();
 #else
     adb_protocol::bus_loop();
@@ -25,6 +76,23 @@ static void adb_task_func(void* param) {
     // Never reaches here
 }
 
+#if ADB_BUS_B
+/// Second ADB bus — runs on Core 0, served by RMT receive and transmit.
+static void bus_b_task_func(void* param) {
+    adb_rmt_bus::task_loop(ADB_BUS_B_PIN, 1);
+    // Never reaches here
+}
+#endif
+
+#if ADB_BUS_CAPTURE
+/// Capture streamer — runs on Core 0.
+/// Drains the edge ring filled by the ADB task to Serial as binary frames.
+static void capture_task_func(void* param) {
+    bus_capture::stream_task_loop();
+    // Never reaches here
+}
+#endif
+
 /// BLE HID host loop — runs on Core 0.
 /// Scans for and connects to BLE keyboards and mice.
 static void ble_task_func(void* param) {
@@ -32,6 +100,36 @@ static void ble_task_func(void* param) {
     // Never reaches here
 }
 
+/// Input processing loop — runs on Core 0.
+/// Parses raw HID reports captured by the NimBLE callbacks.
+static void input_task_func(void* param) {
+    input_stage::task_loop();
+    // Never reaches here
+}
+
+/// Text injection — runs on Core 0.
+/// Types console text into the focused Mac through the keyboard queue.
+static void type_task_func(void* param) {
+    text_inject::task_loop();
+    // Never reaches here
+}
+
+#if ADB_HID_INJECT
+/// Serial reader — runs on Core 0.
+/// Decodes injected HID report frames; passes console input through.
+static void inject_task_func(void* param) {
+    hid_inject::task_loop();
+    // Never reaches here
+}
+#endif
+
+/// Deferred log drain — runs on Core 0.
+/// Formats and transmits records logged from either core.
+static void log_task_func(void* param) {
+    deferred_log::task_loop();
+    // Never reaches here
+}
+
 /// OLED display loop — runs on Core 0.
 /// Updates the status display at 4Hz.
 static void oled_task_func(void* param) {
@@ -39,10 +137,152 @@ static void oled_task_func(void* param) {
     // Never reaches here
 }
 
-// ─── Arduino entry points ───────────────────────────────────────────────────
+/// Print p50/p99/max (µs) of each latency stage for one device.
+static void print_latency(const char* label, const metrics::Snapshot& m,
+                          metrics::Histogram notify_q, metrics::Histogram q_buf,
+                          metrics::Histogram buf_wire, metrics::Histogram total) {
+    const metrics::Histogram stages[] = { notify_q, q_buf, buf_wire, total };
+    const char* const names[] = { "notify>q", "q>buf", "buf>wire", "total" };
 
-void setup() {
+    Serial.printf("[LAT] %s n=%lu", label, m.get(total).count);
+    for (int i = 0; i < 4; i++) {
+        const metrics::HistogramSnapshot& hs = m.get(stages[i]);
+        Serial.printf(" %s:%lu/%lu/%lu", names[i],
+                      metrics::percentile(stages[i], hs, 500),
+                      metrics::percentile(stages[i], hs, 990),
+                      hs.max);
+    }
+    Serial.println(" us (p50/p99/max)");
+}
+
+/// Print ADB bus timing p50/p99 and decode failure counts.
+static void print_bus_timing(const metrics::Snapshot& m) {
+    using metrics::Histogram;
+    using metrics::Counter;
+    const Histogram hists[] = {
+        Histogram::ADB_ATTN_US, Histogram::ADB_SYNC_US,
+        Histogram::ADB_BIT0_LOW_US, Histogram::ADB_BIT1_LOW_US,
+        Histogram::ADB_HOST_TLT_US, Histogram::ADB_REPLY_TLT_US,
+    };
+    const char* const names[] = { "attn", "sync", "bit0", "bit1", "hostTlt", "replyTlt" };
+
+    Serial.print("[BUS]");
+    for (int i = 0; i < 6; i++) {
+        const metrics::HistogramSnapshot& hs = m.get(hists[i]);
+        Serial.printf(" %s:%lu/%lu", names[i],
+                      metrics::percentile(hists[i], hs, 500),
+                      metrics::percentile(hists[i], hs, 990));
+    }
+    Serial.printf(" (p50/p99 us) thr:%lu(1:%lu 0:%lu) err attn:%lu sync:%lu edge:%lu glitch:%lu long:%lu lnodata:%lu lstart:%lu\n",
+                  m.get(metrics::Gauge::ADB_BIT_THRESHOLD),
+                  m.get(metrics::Gauge::ADB_BIT1_EST_US), m.get(metrics::Gauge::ADB_BIT0_EST_US),
+                  m.get(Counter::ADB_ERR_ATTN_RANGE), m.get(Counter::ADB_ERR_SYNC_TIMEOUT),
+                  m.get(Counter::ADB_ERR_BIT_NO_EDGE), m.get(Counter::ADB_ERR_BIT_GLITCH),
+                  m.get(Counter::ADB_ERR_BIT_LONG_LOW), m.get(Counter::ADB_ERR_LISTEN_NO_DATA),
+                  m.get(Counter::ADB_ERR_LISTEN_START));
+
+    const metrics::HistogramSnapshot& stall = m.get(Histogram::ADB_CORE1_STALL_US);
+    Serial.printf("[CORE1] isolation:%s tick:%lu foreign:%lu yields:%lu missed:%lu stall:%lu/%lu/%luus (p50/p99/max)\n",
+                  ADB_CORE1_ISOLATION ? "on" : "off",
+                  m.get(Counter::ADB_CORE1_TICK_IRQ), m.get(Counter::ADB_CORE1_FOREIGN_IRQ),
+                  m.get(Counter::ADB_IDLE_YIELDS), m.get(Counter::ADB_YIELD_MISSED),
+                  metrics::percentile(Histogram::ADB_CORE1_STALL_US, stall, 500),
+                  metrics::percentile(Histogram::ADB_CORE1_STALL_US, stall, 990),
+                  stall.max);
+
+    const metrics::HistogramSnapshot& err = m.get(Histogram::ADB_PRED_ERR_US);
+    Serial.printf("[PRED] %s period:%luus burst:%lu err:%lu/%luus early:%lu jobs:%lu overrun:%lu collide:%lu\n",
+                  m.get(metrics::Gauge::ADB_PRED_LOCKED) ? "locked" : "learning",
+                  m.get(metrics::Gauge::ADB_POLL_PERIOD_US), m.get(metrics::Gauge::ADB_POLL_BURST),
+                  metrics::percentile(Histogram::ADB_PRED_ERR_US, err, 500),
+                  metrics::percentile(Histogram::ADB_PRED_ERR_US, err, 990),
+                  m.get(Counter::ADB_PRED_EARLY), m.get(Counter::ADB_JOB_RUNS),
+                  m.get(Counter::ADB_JOB_OVERRUNS), m.get(Counter::ADB_JOB_COLLISIONS));
+
+    // Shared-bus health: replies lost to another device, polls sat out,
+    // and the addresses enumeration left the devices at
+    Serial.printf("[COLL] collisions:%lu backoff:%lu moves:%lu held:%lu addr kbd:%u mouse:%u\n",
+                  m.get(Counter::ADB_COLLISIONS), m.get(Counter::ADB_COLLISION_BACKOFF),
+                  m.get(Counter::ADB_ADDR_MOVES), m.get(Counter::ADB_ADDR_HELD),
+                  adb_keyboard::current_address(0), adb_mouse::current_address(0));
+
+#if ADB_BUS_B
+    // Second bus: polls seen, replies started, replies given up as too
+    // late to meet Tlt, SRQ interrupt latency against the 65µs stop bit,
+    // and which Mac has the keyboard and mouse
+    const metrics::HistogramSnapshot& tlt_b = m.get(Histogram::ADB_B_REPLY_TLT_US);
+    const metrics::HistogramSnapshot& srq_b = m.get(Histogram::ADB_B_SRQ_LAT_US);
+    Serial.printf("[KVM] focus:%c switches:%lu B polls:%lu replies:%lu late:%lu err:%lu srq:%lu "
+                  "srqlate:%lu drop:%lu tlt:%lu/%luus srqlat:%lu/%luus thr:%lu addr kbd:%u mouse:%u\n",
+                  event_queue::focus() ? 'B' : 'A', m.get(Counter::KVM_SWITCHES),
+                  m.get(Counter::ADB_B_POLLS), m.get(Counter::ADB_B_REPLIES),
+                  m.get(Counter::ADB_B_LATE), m.get(Counter::ADB_B_DECODE_ERRORS),
+                  m.get(Counter::ADB_B_SRQ), m.get(Counter::ADB_B_SRQ_LATE),
+                  m.get(Counter::ADB_B_DROPPED),
+                  metrics::percentile(Histogram::ADB_B_REPLY_TLT_US, tlt_b, 500), tlt_b.max,
+                  metrics::percentile(Histogram::ADB_B_SRQ_LAT_US, srq_b, 990), srq_b.max,
+                  m.get(metrics::Gauge::ADB_B_BIT_THRESHOLD),
+                  adb_keyboard::current_address(1), adb_mouse::current_address(1));
+#endif
+
+#if ADB_ATTN_IRQ
+    // margin: how much shorter than the shortest legal attention pulse the
+    // worst wake so far was — at or below 0, pulses end before the task runs
+    const metrics::HistogramSnapshot& wake = m.get(Histogram::ADB_WAKE_US);
+    Serial.printf("[WAKE] irq:%lu late:%lu timeouts:%lu latency:%lu/%lu/%luus (p50/p99/max) margin:%ldus\n",
+                  m.get(Counter::ADB_WAKE_IRQ), m.get(Counter::ADB_WAKE_LATE),
+                  m.get(Counter::ADB_WAKE_TIMEOUTS),
+                  metrics::percentile(Histogram::ADB_WAKE_US, wake, 500),
+                  metrics::percentile(Histogram::ADB_WAKE_US, wake, 990),
+                  wake.max, (long)ADB_ATTN_MIN_US - (long)wake.max);
+#endif
+}
+
+/// Console wake period: short while text is pasted or typed, so the UART
+/// buffer never fills and XON goes out as soon as the ring drains.
+static uint32_t console_poll_ms() {
+#if ADB_HID_INJECT
+    return CONSOLE_POLL_INTERVAL_MS;    // the serial reader task owns input
+#else
+    return (serial_console::raw_mode() || text_inject::busy())
+        ? CONSOLE_PASTE_POLL_MS : CONSOLE_POLL_INTERVAL_MS;
+#endif
+}
+
+#if ADB_CORE1_ISOLATION
+static void status_tick();
+
+/// Status and console loop — runs on Core 0 in place of loop().
+static void status_task_func(void* param) {
+    while (true) {
+        status_tick();
+        vTaskDelay(pdMS_TO_TICKS(console_poll_ms()));
+    }
+}
+#endif
+
+// ─── Startup ────────────────────────────────────────────────────────────────
+
+/// Bring up every module and start the tasks. Drivers allocate their
+/// interrupt on the core that installs them, so with ADB_CORE1_ISOLATION
+/// this runs in a Core 0 task rather than in setup() on Core 1.
+static void init_system() {
+#if ADB_HID_INJECT
+    // Report frames arrive in bursts at the sender's rate
+    Serial.setRxBufferSize(HID_INJECT_RX_BUFFER);
+#else
+    // A paste keeps arriving between console polls
+    Serial.setRxBufferSize(CONSOLE_RX_BUFFER);
+#endif
+#if ADB_BUS_CAPTURE
+    // Edge frames need headroom over the status text sharing the port
+    Serial.setTxBufferSize(BUS_CAPTURE_TX_BUFFER);
+    Serial.begin(BUS_CAPTURE_BAUD);
+#elif ADB_HID_INJECT
+    Serial.begin(HID_INJECT_BAUD);
+#else
     Serial.begin(SERIAL_BAUD);
+#endif
     delay(1000);  // wait for serial monitor
 
     Serial.println();
@@ -53,13 +293,18 @@ void setup() {
     Serial.printf("  CPU: %d MHz\n", getCpuFrequencyMhz());
     Serial.printf("  Free heap: %d bytes\n", ESP.getFreeHeap());
     Serial.printf("  ADB pin: GPIO%d\n", ADB_DATA_PIN);
+#if ADB_BUS_B
+    Serial.printf("  ADB bus B pin: GPIO%d\n", ADB_BUS_B_PIN);
+#endif
     Serial.println();
 
     // ─── Initialize modules ─────────────────────────────────────────────
 
-    // 1. Event queues (must be first — other modules push to them)
+    // 1. Event queues, input ring and log rings (must be first — other modules push to them)
     Serial.println("[INIT] Creating event queues...");
     event_queue::init();
+    input_stage::init();
+    deferred_log::init();
 
     // 2. OLED display (includes Vext power-on)
     Serial.println("[INIT] Initializing OLED...");
@@ -69,16 +314,11 @@ void setup() {
     Serial.println("[INIT] Initializing ADB protocol...");
     adb_protocol::init();
 
-#if ADB_SELF_TEST
-    // 4. Run ADB timing self-test
-    adb_protocol::self_test();
-#endif
-
-    // 5. BLE HID host (NimBLE)
+    // 4. BLE HID host (NimBLE)
     Serial.println("[INIT] Initializing BLE...");
     ble_hid_host::init();
 
-    // 6. Bond clear check — hold BOOT button at startup to erase all BLE bonds
+    // 5. Bond clear check — hold BOOT button at startup to erase all BLE bonds
     pinMode(BOND_CLEAR_PIN, INPUT_PULLUP);
     if (digitalRead(BOND_CLEAR_PIN) == LOW) {
         int num_bonds = NimBLEDevice::getNumBonds();
@@ -101,6 +341,7 @@ void setup() {
 
         if (held) {
             NimBLEDevice::deleteAllBonds();
+            ble_hid_host::forget_devices();
             Serial.printf("[INIT] Bonds cleared! (was: %d bonded devices)\n", num_bonds);
             oled_display::show_message("Bonds cleared!", nullptr);
             delay(1500);
@@ -135,6 +376,41 @@ void setup() {
         0  // Core 0
     );
 
+    // Core 0: HID report parsing (fed by NimBLE callbacks)
+    xTaskCreatePinnedToCore(
+        input_task_func,
+        "Input",
+        INPUT_TASK_STACK_SIZE,
+        nullptr,
+        INPUT_TASK_PRIORITY,
+        &s_input_task,
+        0  // Core 0
+    );
+
+#if ADB_HID_INJECT
+    // Core 0: serial reader (injected HID reports + console input)
+    xTaskCreatePinnedToCore(
+        inject_task_func,
+        "Inject",
+        HID_INJECT_TASK_STACK_SIZE,
+        nullptr,
+        HID_INJECT_TASK_PRIORITY,
+        &s_inject_task,
+        0  // Core 0
+    );
+#endif
+
+    // Core 0: text injection (below input, so live keys keep flowing)
+    xTaskCreatePinnedToCore(
+        type_task_func,
+        "Type",
+        TYPE_TASK_STACK_SIZE,
+        nullptr,
+        TYPE_TASK_PRIORITY,
+        &s_type_task,
+        0  // Core 0
+    );
+
     // Core 0: OLED display (lowest priority)
     xTaskCreatePinnedToCore(
         oled_task_func,
@@ -146,44 +422,239 @@ void setup() {
         0  // Core 0
     );
 
+    // Core 0: deferred log drain (lowest priority)
+    xTaskCreatePinnedToCore(
+        log_task_func,
+        "Log",
+        LOG_TASK_STACK_SIZE,
+        nullptr,
+        LOG_TASK_PRIORITY,
+        &s_log_task,
+        0  // Core 0
+    );
+
+#if ADB_CORE1_ISOLATION
+    // Core 0: serial status and console (the loop() work, moved off Core 1)
+    xTaskCreatePinnedToCore(
+        status_task_func,
+        "Status",
+        STATUS_TASK_STACK_SIZE,
+        nullptr,
+        STATUS_TASK_PRIORITY,
+        &s_status_task,
+        0  // Core 0
+    );
+#endif
+
+#if ADB_BUS_B
+    // Core 0: second ADB bus (above BLE — its replies have a Tlt deadline)
+    xTaskCreatePinnedToCore(
+        bus_b_task_func,
+        "ADB-B",
+        ADB_BUS_B_TASK_STACK_SIZE,
+        nullptr,
+        ADB_BUS_B_TASK_PRIORITY,
+        &s_bus_b_task,
+        0  // Core 0
+    );
+#endif
+
+#if ADB_BUS_CAPTURE
+    // Core 0: capture streamer (above OLED/log so frames keep up)
+    xTaskCreatePinnedToCore(
+        capture_task_func,
+        "Capture",
+        CAPTURE_TASK_STACK_SIZE,
+        nullptr,
+        CAPTURE_TASK_PRIORITY,
+        &s_capture_task,
+        0  // Core 0
+    );
+#endif
+
     Serial.println("[INIT] All tasks started");
     Serial.printf("[INIT] Free heap after init: %d bytes\n", ESP.getFreeHeap());
     Serial.println();
 }
 
-void loop() {
-    // All work is done in FreeRTOS tasks.
-    // Arduino loop() runs on Core 1 at priority 1, below ADB task.
-    // Use it for periodic serial status output.
-
+/// Console input, the boot latency report and the 5 s STATUS block. Runs
+/// from the Status task on Core 0 (ADB_CORE1_ISOLATION) or from loop().
+static void status_tick() {
     static uint32_t last_status = 0;
+    static uint32_t last_export = 0;
+    static uint32_t last_oled_bytes = 0;
+#if ADB_GLITCH_FILTER
+    static uint32_t last_glitches = 0;
+#endif
+#if ADB_HID_INJECT
+    static uint32_t last_frames = 0;
+#endif
+    static bool boot_reported = false;
     uint32_t now = millis();
 
+#if !ADB_HID_INJECT
+    serial_console::poll();     // with injection the serial reader task owns input
+#endif
+
+    // One-shot boot latency report: reset → BLE link ready → first key on ADB
+    if (!boot_reported && adb_keyboard::get_first_key_ms()) {
+        boot_reported = true;
+        Serial.printf("[BOOT] kbd ready:%lums mouse ready:%lums first key delivered:%lums\n",
+                      ble_hid_host::get_kbd_ready_ms(),
+                      ble_hid_host::get_mouse_ready_ms(),
+                      adb_keyboard::get_first_key_ms());
+    }
+
     if ((now - last_status) >= 5000) {
         last_status = now;
+        sample_system_gauges();
+        metrics::snapshot(s_snap);
+        const metrics::Snapshot& m = s_snap;
+        using metrics::Counter;
+        using metrics::Gauge;
+        using metrics::Histogram;
 
         uint32_t kbd_age = ble_hid_host::get_kbd_last_ms() ?
             (now - ble_hid_host::get_kbd_last_ms()) : 0;
         uint32_t mou_age = ble_hid_host::get_mouse_last_ms() ?
             (now - ble_hid_host::get_mouse_last_ms()) : 0;
 
-        Serial.printf("[STATUS] KBD:%s MOU:%s adbPoll:%lu adbResp:%lu kCb:%lu(used:%lu drop:%lu) mCb:%lu mEvt:%lu heap:%d\n",
+        Serial.printf("[STATUS] KBD:%s MOU:%s adbPoll:%lu adbResp:%lu kCb:%lu(used:%lu drop:%lu) mCb:%lu mEvt:%lu heap:%lu\n",
                       ble_hid_host::keyboard_connected() ? "OK" : "--",
                       ble_hid_host::mouse_connected() ? "OK" : "--",
-                      adb_protocol::get_poll_count(),
-                      adb_protocol::get_response_count(),
-                      ble_hid_host::get_kbd_cb_count(),
-                      ble_hid_host::get_kbd_cb_used(),
-                      ble_hid_host::get_kbd_cb_dropped(),
-                      ble_hid_host::get_mouse_cb_count(),
-                      adb_mouse::get_queue_events(),
-                      ESP.getFreeHeap());
-        Serial.printf("[STATUS] kAge:%lums mAge:%lums kQ:%d mQ:%d\n",
+                      m.get(Counter::ADB_POLLS),
+                      m.get(Counter::ADB_TALK_REPLIES),
+                      m.get(Counter::BLE_KBD_NOTIFY),
+                      m.get(Counter::INPUT_KBD_USED),
+                      m.get(Counter::INPUT_KBD_SHORT),
+                      m.get(Counter::BLE_MOUSE_NOTIFY),
+                      m.get(Counter::ADB_MOUSE_EVENTS),
+                      m.get(Gauge::HEAP_FREE));
+        Serial.printf("[STATUS] kAge:%lums mAge:%lums kQ:%d(hwm:%lu drop:%lu) mQ:%d(hwm:%lu drop:%lu)\n",
                       kbd_age, mou_age,
-                      uxQueueMessagesWaiting(event_queue::kbd_queue()),
-                      uxQueueMessagesWaiting(event_queue::mouse_queue()));
-        ble_hid_host::dump_handle_stats();
+                      uxQueueMessagesWaiting(event_queue::kbd_queue(event_queue::focus())),
+                      m.get(event_queue::kbd_hwm_gauge(event_queue::focus())),
+                      m.get(Counter::KBD_QUEUE_DROPS),
+                      uxQueueMessagesWaiting(event_queue::mouse_queue(event_queue::focus())),
+                      m.get(event_queue::mouse_hwm_gauge(event_queue::focus())),
+                      m.get(Counter::MOUSE_QUEUE_DROPS));
+
+        // Host presence: share of time a Mac was polling, and how long the
+        // BLE links took to be fast again after it came back
+        uint32_t active_ms = m.get(Counter::HOST_ACTIVE_TIME_MS);
+        uint32_t absent_ms = m.get(Counter::HOST_ABSENT_TIME_MS);
+        const metrics::HistogramSnapshot& resume = m.get(Histogram::HOST_RESUME_MS);
+        Serial.printf("[HOST] %s found:%lu lost:%lu active:%lu%% absent:%lus resume:%lu/%lums "
+                      "discarded:%lu conn_upd:%lu\n",
+                      m.get(Gauge::HOST_ACTIVE) ? "active" : "absent",
+                      m.get(Counter::HOST_FOUND), m.get(Counter::HOST_LOST),
+                      active_ms + absent_ms ? (uint32_t)(100ULL * active_ms / (active_ms + absent_ms)) : 0,
+                      absent_ms / 1000,
+                      metrics::percentile(Histogram::HOST_RESUME_MS, resume, 500), resume.max,
+                      m.get(Counter::HOST_DISCARDED), m.get(Counter::BLE_CONN_UPDATES));
+
+        // Keyboard LEDs: changes the Macs posted, written to the keyboard
+        // (fewer when coalesced), and post-to-write latency
+        const metrics::HistogramSnapshot& led = m.get(Histogram::LED_SYNC_US);
+        Serial.printf("[LED] posted:%lu coalesced:%lu drop:%lu writes:%lu fail:%lu sync:%lu/%luus (p50/max)\n",
+                      m.get(Counter::LED_POSTED), m.get(Counter::LED_COALESCED),
+                      m.get(Counter::LED_DROPPED), m.get(Counter::LED_WRITES),
+                      m.get(Counter::LED_WRITE_FAIL),
+                      metrics::percentile(Histogram::LED_SYNC_US, led, 500), led.max);
+
+        const metrics::HistogramSnapshot& cap   = m.get(Histogram::INPUT_CAPTURE_CYCLES);
+        const metrics::HistogramSnapshot& wait  = m.get(Histogram::INPUT_WAIT_US);
+        const metrics::HistogramSnapshot& parse = m.get(Histogram::INPUT_PARSE_CYCLES);
+        Serial.printf("[INPUT] rpt:%lu full:%lu trunc:%lu hwm:%lu/%lu "
+                      "capture:%lu/%lucyc wait:%lu/%luus parse:%lu/%lucyc (avg/max)\n",
+                      m.get(Counter::INPUT_REPORTS), m.get(Counter::INPUT_RING_FULL),
+                      m.get(Counter::INPUT_TRUNCATED), m.get(Gauge::INPUT_RING_HWM), INPUT_RING_SIZE,
+                      cap.avg(), cap.max, wait.avg(), wait.max, parse.avg(), parse.max);
+        print_bus_timing(m);
+#if ADB_GLITCH_FILTER
+        uint32_t glitches = m.get(Counter::ADB_GLITCHES_FILTERED);
+        Serial.printf("[GLITCH] filtered:%lu (%lu/s) width:<=%luus confirm:%lu\n",
+                      glitches, (glitches - last_glitches) / 5,
+                      ADB_GLITCH_US, ADB_GLITCH_CONFIRM_SAMPLES);
+        last_glitches = glitches;
+#endif
+#if ADB_HID_INJECT
+        uint32_t frames = m.get(Counter::HID_INJECT_FRAMES);
+        Serial.printf("[INJECT] frames:%lu (%lu/s) bad:%lu lost:%lu hwm:%lu/%lu\n",
+                      frames, (frames - last_frames) / 5,
+                      m.get(Counter::HID_INJECT_BAD), m.get(Counter::HID_INJECT_SEQ_LOST),
+                      m.get(Gauge::INPUT_INJECT_RING_HWM), INPUT_RING_SIZE);
+        last_frames = frames;
+#endif
+        print_latency("kbd", m,
+                      Histogram::KBD_NOTIFY_TO_QUEUE_US, Histogram::KBD_QUEUE_TO_BUFFER_US,
+                      Histogram::KBD_BUFFER_TO_WIRE_US, Histogram::KBD_END_TO_END_US);
+        print_latency("mouse", m,
+                      Histogram::MOUSE_NOTIFY_TO_QUEUE_US, Histogram::MOUSE_QUEUE_TO_BUFFER_US,
+                      Histogram::MOUSE_BUFFER_TO_WIRE_US, Histogram::MOUSE_END_TO_END_US);
+        ble_hid_host::dump_scan_stats();
+        Serial.printf("[LOG] rec:%lu drop:%lu worst-case c0:%lucyc c1:%lucyc\n",
+                      m.get(Counter::LOG_RECORDS), m.get(Counter::LOG_DROPPED),
+                      m.get(Gauge::LOG_CYCLES_MAX_CORE0), m.get(Gauge::LOG_CYCLES_MAX_CORE1));
+        input_stage::dump_handle_stats();
+
+        // I2C rate over the 5 s status interval; render is CPU time, flush is
+        // wall time (the OLED task sleeps while the I2C ISR moves the bytes)
+        uint32_t oled_bytes = m.get(Counter::OLED_I2C_BYTES);
+        const metrics::HistogramSnapshot& render = m.get(Histogram::OLED_RENDER_US);
+        const metrics::HistogramSnapshot& flush  = m.get(Histogram::OLED_FLUSH_US);
+        Serial.printf("[OLED] %s frames:%lu pages:%lu i2c:%luB/s err:%lu "
+                      "render:%lu/%luus flush:%lu/%luus (avg/max)\n",
+                      oled_display::full_refresh() ? "full" : "diff",
+                      m.get(Counter::OLED_FRAMES), m.get(Counter::OLED_PAGES_SENT),
+                      (oled_bytes - last_oled_bytes) / 5, m.get(Counter::OLED_I2C_ERRORS),
+                      render.avg(), render.max, flush.avg(), flush.max);
+        last_oled_bytes = oled_bytes;
+
+        if ((now - last_export) >= METRICS_EXPORT_INTERVAL_MS) {
+            last_export = now;
+            metrics::dump(m);
+        }
     }
+}
+
+// ─── Arduino entry points ───────────────────────────────────────────────────
+
+#if ADB_CORE1_ISOLATION
+/// Runs init_system() on Core 0, then exits.
+static void init_task_func(void* param) {
+    init_system();
+    vTaskDelete(nullptr);
+}
+#endif
+
+void setup() {
+#if ADB_CORE1_ISOLATION
+    // Everything — UART, I2C, NimBLE and the tasks — is brought up from
+    // Core 0 so no driver interrupt is allocated on the ADB core
+    xTaskCreatePinnedToCore(
+        init_task_func,
+        "Init",
+        INIT_TASK_STACK_SIZE,
+        nullptr,
+        INIT_TASK_PRIORITY,
+        nullptr,
+        0  // Core 0
+    );
+#else
+    init_system();
+#endif
+}
 
-    vTaskDelay(pdMS_TO_TICKS(1000));
+void loop() {
+#if ADB_CORE1_ISOLATION
+    // Status and console run in the Core 0 Status task. Remove the Arduino
+    // loop task so the ADB task (and the idle task) is all Core 1 runs.
+    vTaskDelete(nullptr);
+#else
+    // Arduino loop() runs on Core 1 at priority 1, below ADB task.
+    // Use it for periodic serial status output and console commands.
+    status_tick();
+    vTaskDelay(pdMS_TO_TICKS(console_poll_ms()));
+#endif
 }
@@ -0,0 +1,135 @@
+#include "metrics.h"
+#include "config.h"
+
+#include <Arduino.h>
+
+namespace metrics {
+
+// ─── Storage ────────────────────────────────────────────────────────────────
+
+namespace detail {
+CoreSlot g_cores[2] = {};
+volatile uint32_t g_gauges[NUM_GAUGES] = {};
+}
+
+static const char* const s_counter_names[] = {
+#define METRIC_NAME(id, name) name,
+    METRIC_COUNTER_LIST(METRIC_NAME)
+#undef METRIC_NAME
+};
+
+static const char* const s_gauge_names[] = {
+#define METRIC_NAME(id, name) name,
+    METRIC_GAUGE_LIST(METRIC_NAME)
+#undef METRIC_NAME
+};
+
+static const char* const s_histogram_names[] = {
+#define METRIC_NAME(id, name, scale, base, width) name,
+    METRIC_HISTOGRAM_LIST(METRIC_NAME)
+#undef METRIC_NAME
+};
+
+const char* name(Counter c)   { return s_counter_names[(uint32_t)c]; }
+const char* name(Gauge g)     { return s_gauge_names[(uint32_t)g]; }
+const char* name(Histogram h) { return s_histogram_names[(uint32_t)h]; }
+
+// ─── Snapshot ───────────────────────────────────────────────────────────────
+
+uint32_t read(Counter c) {
+    return detail::g_cores[0].counters[(uint32_t)c] + detail::g_cores[1].counters[(uint32_t)c];
+}
+
+void snapshot(Snapshot& out) {
+    out.taken_ms = millis();
+
+    for (uint32_t i = 0; i < NUM_COUNTERS; i++) {
+        out.counters[i] = detail::g_cores[0].counters[i] + detail::g_cores[1].counters[i];
+    }
+    for (uint32_t i = 0; i < NUM_GAUGES; i++) {
+        out.gauges[i] = detail::g_gauges[i];
+    }
+    for (uint32_t h = 0; h < NUM_HISTOGRAMS; h++) {
+        HistogramSnapshot& hs = out.histograms[h];
+        const detail::HistogramSlot& a = detail::g_cores[0].histograms[h];
+        const detail::HistogramSlot& b = detail::g_cores[1].histograms[h];
+        hs.count = 0;
+        for (uint32_t i = 0; i < METRICS_HIST_BUCKETS; i++) {
+            hs.buckets[i] = a.buckets[i] + b.buckets[i];
+            hs.count += hs.buckets[i];
+        }
+        hs.sum = a.sum + b.sum;
+        hs.max = (a.max > b.max) ? a.max : b.max;
+    }
+}
+
+// ─── Percentiles ────────────────────────────────────────────────────────────
+
+/// Smallest value that lands in bucket idx.
+static uint32_t bucket_lower(const HistogramSpec& spec, uint32_t idx) {
+    if (spec.scale == Scale::LINEAR) {
+        return spec.base + idx * spec.width;
+    }
+    if (idx < 2) return idx;
+    uint32_t msb = idx >> 1;
+    return (1u << msb) | ((idx & 1) << (msb - 1));
+}
+
+static uint32_t percentile(const HistogramSpec& spec, const uint32_t* buckets,
+                           uint32_t count, uint32_t max, uint32_t permille) {
+    if (count == 0) return 0;
+
+    uint32_t rank = (uint32_t)(((uint64_t)count * permille + 999) / 1000);
+    if (rank == 0) rank = 1;
+
+    uint32_t seen = 0;
+    for (uint32_t i = 0; i < METRICS_HIST_BUCKETS; i++) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            if (i == METRICS_HIST_BUCKETS - 1) return max;
+            uint32_t upper = bucket_lower(spec, i + 1) - 1;
+            return (upper < max) ? upper : max;
+        }
+    }
+    return max;
+}
+
+uint32_t percentile(Histogram h, const HistogramSnapshot& hs, uint32_t permille) {
+    return percentile(HISTOGRAM_SPECS[(uint32_t)h], hs.buckets, hs.count, hs.max, permille);
+}
+
+uint32_t log2_percentile(const uint32_t* buckets, uint32_t count, uint32_t max,
+                         uint32_t permille) {
+    static constexpr HistogramSpec LOG2_SPEC = { Scale::LOG2, 0, 0 };
+    return percentile(LOG2_SPEC, buckets, count, max, permille);
+}
+
+// ─── Serial exporter ────────────────────────────────────────────────────────
+
+void dump(const Snapshot& snap) {
+    Serial.print("[METRICS]");
+    for (uint32_t i = 0; i < NUM_COUNTERS; i++) {
+        Serial.printf(" %s=%lu", s_counter_names[i], snap.counters[i]);
+        if (i % 6 == 5 && i + 1 < NUM_COUNTERS) Serial.print("\n[METRICS]");
+    }
+    Serial.println();
+
+    Serial.print("[METRICS]");
+    for (uint32_t i = 0; i < NUM_GAUGES; i++) {
+        Serial.printf(" %s=%lu", s_gauge_names[i], snap.gauges[i]);
+        if (i % 6 == 5 && i + 1 < NUM_GAUGES) Serial.print("\n[METRICS]");
+    }
+    Serial.println();
+
+    for (uint32_t h = 0; h < NUM_HISTOGRAMS; h++) {
+        const HistogramSnapshot& hs = snap.histograms[h];
+        if (hs.count == 0) continue;
+        Serial.printf("[METRICS] %s n=%lu avg=%lu p50=%lu p99=%lu max=%lu\n",
+                      s_histogram_names[h], hs.count, hs.avg(),
+                      percentile((Histogram)h, hs, 500),
+                      percentile((Histogram)h, hs, 990),
+                      hs.max);
+    }
+}
+
+} // namespace metrics
@@ -1,8 +1,12 @@
 #include "oled_display.h"
 #include "ble_hid_host.h"
+#include "event_queue.h"
+#include "metrics.h"
 #include "config.h"
 
 #include <Arduino.h>
+#include <algorithm>
+#include <cstring>
 #include <Wire.h>
 #include <SSD1306Wire.h>
 
@@ -13,11 +17,32 @@ namespace oled_display {
 static SSD1306Wire* s_display = nullptr;
 static uint32_t s_last_update = 0;
 static bool     s_adb_active  = false;
-static uint32_t s_poll_count  = 0;
-static uint32_t s_event_count = 0;
-static uint32_t s_last_poll_count = 0;
-static uint32_t s_last_rate_time  = 0;
-static float    s_poll_rate       = 0;
+static metrics::Snapshot s_snap;    // static — too large for the task stack
+
+/// Dashboard pages, cycled with the BOOT button.
+enum class Page : uint8_t { STATUS, LATENCY, QUEUES, BUS, BLE, COUNT };
+static Page     s_page = Page::STATUS;
+
+// Per-second rates and latency history, sampled from successive snapshots
+struct Rates {
+    float polls;
+    float kbd_notify;
+    float mouse_notify;
+    float decode_errors;
+};
+static Rates    s_rates = {};
+static uint32_t s_last_rate_time = 0;
+static uint32_t s_prev_counters[metrics::NUM_COUNTERS] = {};
+static uint32_t s_prev_lat_buckets[METRICS_HIST_BUCKETS] = {};
+static uint32_t s_lat_p99[OLED_SPARK_SAMPLES] = {};   // µs per second, 0 = no input
+static uint32_t s_lat_head = 0;                       // next slot to write
+
+// Last bytes actually sent to the panel, page-major like the library's
+// framebuffer (buffer[page * OLED_WIDTH + x]). flush() diffs against this.
+constexpr uint32_t OLED_PAGES = OLED_HEIGHT / 8;
+static uint8_t  s_sent[OLED_PAGES][OLED_WIDTH];
+static bool     s_sent_valid   = false;   // false → next flush sends everything
+static bool     s_full_refresh = false;   // A/B switch: always send all pages
 
 // ─── Helpers ────────────────────────────────────────────────────────────────
 
@@ -33,6 +58,320 @@ static const char* state_str(ble_hid_host::DeviceState state) {
     }
 }
 
+static const char* scan_mode_str(ble_hid_host::ScanMode mode) {
+    switch (mode) {
+        case ble_hid_host::ScanMode::OFF:          return "off";
+        case ble_hid_host::ScanMode::DISCOVERY:    return "discovery";
+        case ble_hid_host::ScanMode::DISCOVERY_BG: return "discovery (bg)";
+        case ble_hid_host::ScanMode::RECONNECT:    return "reconnect";
+        default: return "?";
+    }
+}
+
+/// Decode failures, summed over every cause.
+static const metrics::Counter DECODE_ERRORS[] = {
+    metrics::Counter::ADB_ERR_ATTN_RANGE,
+    metrics::Counter::ADB_ERR_SYNC_TIMEOUT,
+    metrics::Counter::ADB_ERR_BIT_NO_EDGE,
+    metrics::Counter::ADB_ERR_BIT_GLITCH,
+    metrics::Counter::ADB_ERR_BIT_LONG_LOW,
+    metrics::Counter::ADB_ERR_LISTEN_NO_DATA,
+    metrics::Counter::ADB_ERR_LISTEN_START,
+};
+
+static uint32_t decode_errors(const uint32_t* counters) {
+    uint32_t sum = 0;
+    for (metrics::Counter c : DECODE_ERRORS) sum += counters[(uint32_t)c];
+    return sum;
+}
+
+/// Once a second: rates from counter deltas, and the p99 of just that
+/// second's end-to-end latencies (keyboard and mouse merged — both use the
+/// same LOG2 buckets) for the sparkline. Runs whatever page is showing so
+/// the history is complete when the latency page is selected.
+static void sample_interval(uint32_t now) {
+    uint32_t dt = now - s_last_rate_time;
+    if (dt < 1000) return;
+    s_last_rate_time = now;
+
+    const uint32_t* cur  = s_snap.counters;
+    const uint32_t* prev = s_prev_counters;
+    auto rate = [&](metrics::Counter c) {
+        return (float)(cur[(uint32_t)c] - prev[(uint32_t)c]) * 1000.0f / dt;
+    };
+    s_rates.polls         = rate(metrics::Counter::ADB_POLLS);
+    s_rates.kbd_notify    = rate(metrics::Counter::BLE_KBD_NOTIFY);
+    s_rates.mouse_notify  = rate(metrics::Counter::BLE_MOUSE_NOTIFY);
+    s_rates.decode_errors = (float)(decode_errors(cur) - decode_errors(prev)) * 1000.0f / dt;
+    memcpy(s_prev_counters, cur, sizeof(s_prev_counters));
+
+    const metrics::HistogramSnapshot& kl = s_snap.get(metrics::Histogram::KBD_END_TO_END_US);
+    const metrics::HistogramSnapshot& ml = s_snap.get(metrics::Histogram::MOUSE_END_TO_END_US);
+    metrics::HistogramSnapshot delta = {};
+    delta.max = std::max(kl.max, ml.max);   // cap only — the interval max isn't kept
+    for (uint32_t i = 0; i < METRICS_HIST_BUCKETS; i++) {
+        uint32_t merged = kl.buckets[i] + ml.buckets[i];
+        delta.buckets[i] = merged - s_prev_lat_buckets[i];
+        delta.count += delta.buckets[i];
+        s_prev_lat_buckets[i] = merged;
+    }
+    s_lat_p99[s_lat_head] = delta.count
+        ? metrics::percentile(metrics::Histogram::KBD_END_TO_END_US, delta, 990) : 0;
+    s_lat_head = (s_lat_head + 1) % OLED_SPARK_SAMPLES;
+}
+
+// ─── Pages ──────────────────────────────────────────────────────────────────
+// 128x64 with ArialMT_Plain_10: five text rows at y = 0, 13, 26, 39, 52.
+// Every page draws only from s_snap, s_rates and the published BLE status.
+
+/// Title row with the page number at the right edge.
+static void draw_title(const char* title) {
+    char num[8];
+    snprintf(num, sizeof(num), "%u/%u", (unsigned)s_page + 1, (unsigned)Page::COUNT);
+    s_display->drawString(0, 0, title);
+    s_display->setTextAlignment(TEXT_ALIGN_RIGHT);
+    s_display->drawString(OLED_WIDTH, 0, num);
+    s_display->setTextAlignment(TEXT_ALIGN_LEFT);
+    s_display->drawHorizontalLine(0, 12, OLED_WIDTH);
+}
+
+static void draw_status() {
+    auto kbd_status = ble_hid_host::get_keyboard_status();
+    auto mouse_status = ble_hid_host::get_mouse_status();
+    uint32_t polls  = s_snap.get(metrics::Counter::ADB_POLLS);
+    uint32_t events = s_snap.get(metrics::Counter::ADB_TALK_REPLIES);
+
+    // Line 1: Keyboard status
+    char line[64];
+    snprintf(line, sizeof(line), "KBD: [%s] %.16s",
+             state_str(kbd_status.state), kbd_status.name);
+    s_display->drawString(0, 0, line);
+
+    // Line 2: Mouse status
+    snprintf(line, sizeof(line), "MOU: [%s] %.16s",
+             state_str(mouse_status.state), mouse_status.name);
+    s_display->drawString(0, 13, line);
+
+    // Line 3: ADB bus status
+    snprintf(line, sizeof(line), "ADB: %s  Rate:%.0f/s",
+             s_adb_active ? "ACTIVE" : "idle", s_rates.polls);
+    s_display->drawString(0, 26, line);
+
+    // Line 4: Counters
+    snprintf(line, sizeof(line), "Polls:%lu Events:%lu", polls, events);
+    s_display->drawString(0, 39, line);
+
+    // Line 5: end-to-end latency p50/max (ms), BLE notify → ADB wire.
+    // p99 would push it past the 21 characters that fit; the latency
+    // page has it per second.
+    using metrics::Histogram;
+    const metrics::HistogramSnapshot& kl = s_snap.get(Histogram::KBD_END_TO_END_US);
+    const metrics::HistogramSnapshot& ml = s_snap.get(Histogram::MOUSE_END_TO_END_US);
+    snprintf(line, sizeof(line), "Lat K%lu/%lu M%lu/%lums",
+             metrics::percentile(Histogram::KBD_END_TO_END_US, kl, 500) / 1000,
+             kl.max / 1000,
+             metrics::percentile(Histogram::MOUSE_END_TO_END_US, ml, 500) / 1000,
+             ml.max / 1000);
+    s_display->drawString(0, 52, line);
+
+    // Activity indicator (small filled circle when ADB is active)
+    if (s_adb_active) {
+        s_display->fillCircle(122, 32, 4);
+    }
+}
+
+/// End-to-end p99 per second over the last OLED_SPARK_SAMPLES seconds,
+/// oldest on the left, scaled to the peak in the window.
+static void draw_latency() {
+    using metrics::Histogram;
+    const metrics::HistogramSnapshot& kl = s_snap.get(Histogram::KBD_END_TO_END_US);
+    const metrics::HistogramSnapshot& ml = s_snap.get(Histogram::MOUSE_END_TO_END_US);
+
+    uint32_t peak = 0;
+    for (uint32_t v : s_lat_p99) peak = std::max(peak, v);
+
+    char line[32];
+    snprintf(line, sizeof(line), "Lat p99/s  pk %lums", peak / 1000);
+    draw_title(line);
+    snprintf(line, sizeof(line), "K %lums  M %lums  (all)",
+             metrics::percentile(Histogram::KBD_END_TO_END_US, kl, 990) / 1000,
+             metrics::percentile(Histogram::MOUSE_END_TO_END_US, ml, 990) / 1000);
+    s_display->drawString(0, 13, line);
+
+    constexpr int TOP = 28;
+    constexpr int HEIGHT = OLED_HEIGHT - TOP;
+    s_display->drawHorizontalLine(0, OLED_HEIGHT - 1, OLED_WIDTH);
+    if (peak == 0) return;
+
+    int x0 = OLED_WIDTH - (int)OLED_SPARK_SAMPLES;
+    for (uint32_t i = 0; i < OLED_SPARK_SAMPLES; i++) {
+        uint32_t v = s_lat_p99[(s_lat_head + i) % OLED_SPARK_SAMPLES];
+        if (v == 0) continue;
+        int h = (int)(((uint64_t)v * (HEIGHT - 1) + peak - 1) / peak);
+        s_display->drawVerticalLine(x0 + (int)i, OLED_HEIGHT - 1 - h, h);
+    }
+}
+
+static void draw_queues() {
+    draw_title("Queues now/hwm/drop");
+
+    char line[40];
+    snprintf(line, sizeof(line), "KBD   %u/%lu/%lu  of %d",
+             (unsigned)uxQueueMessagesWaiting(event_queue::kbd_queue(event_queue::focus())),
+             s_snap.get(event_queue::kbd_hwm_gauge(event_queue::focus())),
+             s_snap.get(metrics::Counter::KBD_QUEUE_DROPS), KBD_QUEUE_SIZE);
+    s_display->drawString(0, 13, line);
+    snprintf(line, sizeof(line), "MOU   %u/%lu/%lu  of %d",
+             (unsigned)uxQueueMessagesWaiting(event_queue::mouse_queue(event_queue::focus())),
+             s_snap.get(event_queue::mouse_hwm_gauge(event_queue::focus())),
+             s_snap.get(metrics::Counter::MOUSE_QUEUE_DROPS), MOUSE_QUEUE_SIZE);
+    s_display->drawString(0, 26, line);
+    snprintf(line, sizeof(line), "Ring  hwm %lu/%d  full %lu",
+             s_snap.get(metrics::Gauge::INPUT_RING_HWM), INPUT_RING_SIZE,
+             s_snap.get(metrics::Counter::INPUT_RING_FULL));
+    s_display->drawString(0, 39, line);
+    snprintf(line, sizeof(line), "Log   drop %lu",
+             s_snap.get(metrics::Counter::LOG_DROPPED));
+    s_display->drawString(0, 52, line);
+}
+
+/// Decode error rate, then the reply Tlt histogram: one bar per LINEAR
+/// bucket (ADB_REPLY_TLT_US), scaled to the fullest bucket.
+static void draw_bus() {
+    using metrics::Histogram;
+    draw_title("ADB bus");
+
+    char line[40];
+    snprintf(line, sizeof(line), "Poll %.0f/s  Err %.1f/s",
+             s_rates.polls, s_rates.decode_errors);
+    s_display->drawString(0, 13, line);
+
+    const metrics::HistogramSnapshot& tlt = s_snap.get(Histogram::ADB_REPLY_TLT_US);
+    snprintf(line, sizeof(line), "Tlt %lu/%lu/%luus",
+             metrics::percentile(Histogram::ADB_REPLY_TLT_US, tlt, 500),
+             metrics::percentile(Histogram::ADB_REPLY_TLT_US, tlt, 990),
+             tlt.max);
+    s_display->drawString(0, 26, line);
+
+    constexpr int TOP = 40;
+    constexpr int HEIGHT = OLED_HEIGHT - TOP;
+    constexpr int BAR = OLED_WIDTH / METRICS_HIST_BUCKETS;
+    uint32_t fullest = 0;
+    for (uint32_t n : tlt.buckets) fullest = std::max(fullest, n);
+    s_display->drawHorizontalLine(0, OLED_HEIGHT - 1, OLED_WIDTH);
+    if (fullest == 0) return;
+
+    for (uint32_t i = 0; i < METRICS_HIST_BUCKETS; i++) {
+        uint32_t n = tlt.buckets[i];
+        if (n == 0) continue;
+        int h = (int)(((uint64_t)n * (HEIGHT - 1) + fullest - 1) / fullest);
+        s_display->fillRect((int)i * BAR, OLED_HEIGHT - 1 - h, BAR - 1, h);
+    }
+}
+
+/// Notification rate and negotiated connection interval per device.
+static void draw_ble() {
+    draw_title("BLE");
+
+    auto kbd_status = ble_hid_host::get_keyboard_status();
+    auto mouse_status = ble_hid_host::get_mouse_status();
+
+    // Interval is in 1.25 ms units: ×125 gives hundredths of a ms
+    char line[40];
+    uint32_t ki = kbd_status.conn_interval * 125u;
+    uint32_t mi = mouse_status.conn_interval * 125u;
+    snprintf(line, sizeof(line), "KBD [%s] %.0f/s  %lu.%02lums",
+             state_str(kbd_status.state), s_rates.kbd_notify, ki / 100, ki % 100);
+    s_display->drawString(0, 13, line);
+    snprintf(line, sizeof(line), "MOU [%s] %.0f/s  %lu.%02lums",
+             state_str(mouse_status.state), s_rates.mouse_notify, mi / 100, mi % 100);
+    s_display->drawString(0, 26, line);
+    snprintf(line, sizeof(line), "Scan: %s",
+             scan_mode_str(ble_hid_host::get_scan_mode()));
+    s_display->drawString(0, 39, line);
+}
+
+// ─── Dirty-page flush ───────────────────────────────────────────────────────
+// The SSD1306 runs in horizontal addressing mode (set by the library's init),
+// so a column/page window followed by data bytes fills that window in order.
+// Each changed page gets its own window covering the first..last changed
+// column — typically a few digits of a counter rather than the whole frame.
+//
+// Arduino-ESP32's Wire is interrupt-driven: endTransmission() queues the
+// transfer and blocks the calling task on its completion, so Core 0 runs the
+// BLE and input tasks while the bytes are on the bus. The S3 I2C controller
+// has no DMA; keeping each transaction to one page window bounds how long
+// any single transfer holds the bus.
+
+/// One I2C transaction: control byte + payload. Returns bytes on the wire
+/// (address byte included), or 0 on a NACK / bus error.
+static uint32_t i2c_send(uint8_t control, const uint8_t* data, uint32_t len) {
+    Wire.beginTransmission(OLED_ADDR);
+    Wire.write(control);
+    Wire.write(data, len);
+    if (Wire.endTransmission() != 0) return 0;
+    return len + 2;
+}
+
+/// Send columns [first, last] of one page. Returns bytes on the wire, 0 on error.
+static uint32_t send_window(uint32_t page, uint32_t first, uint32_t last,
+                            const uint8_t* row) {
+    const uint8_t window[] = {
+        0x21, (uint8_t)first, (uint8_t)last,    // COLUMNADDR
+        0x22, (uint8_t)page,  (uint8_t)page,    // PAGEADDR
+    };
+    uint32_t total = i2c_send(0x00, window, sizeof(window));
+    if (total == 0) return 0;
+
+    for (uint32_t x = first; x <= last; x += OLED_I2C_CHUNK) {
+        uint32_t n = last + 1 - x;
+        if (n > OLED_I2C_CHUNK) n = OLED_I2C_CHUNK;
+        uint32_t sent = i2c_send(0x40, row + x, n);
+        if (sent == 0) return 0;
+        total += sent;
+    }
+    return total;
+}
+
+/// Push the library framebuffer to the panel, sending only the changed
+/// column range of each changed page.
+static void flush() {
+    const uint8_t* fb = s_display->buffer;
+    bool full = s_full_refresh || !s_sent_valid;
+    uint32_t bytes = 0;
+    uint32_t pages = 0;
+
+    for (uint32_t page = 0; page < OLED_PAGES; page++) {
+        const uint8_t* row  = fb + page * OLED_WIDTH;
+        uint8_t*       sent = s_sent[page];
+
+        uint32_t first = 0;
+        uint32_t last  = OLED_WIDTH - 1;
+        if (!full) {
+            while (first < (uint32_t)OLED_WIDTH && row[first] == sent[first]) first++;
+            if (first == (uint32_t)OLED_WIDTH) continue;   // page unchanged
+            while (row[last] == sent[last]) last--;
+        }
+
+        uint32_t n = send_window(page, first, last, row);
+        if (n == 0) {
+            // Panel state unknown — resend everything next frame
+            s_sent_valid = false;
+            metrics::inc(metrics::Counter::OLED_I2C_ERRORS);
+            metrics::inc(metrics::Counter::OLED_I2C_BYTES, bytes);
+            metrics::inc(metrics::Counter::OLED_PAGES_SENT, pages);
+            return;
+        }
+        memcpy(sent + first, row + first, last + 1 - first);
+        bytes += n;
+        pages++;
+    }
+
+    s_sent_valid = true;
+    metrics::inc(metrics::Counter::OLED_I2C_BYTES, bytes);
+    metrics::inc(metrics::Counter::OLED_PAGES_SENT, pages);
+}
+
 // ─── Public interface ───────────────────────────────────────────────────────
 
 void init() {
@@ -59,7 +398,7 @@ void init() {
     s_display->drawString(64, 10, "BLE-ADB Bridge");
     s_display->drawString(64, 30, "Heltec V3");
     s_display->drawString(64, 45, "Initializing...");
-    s_display->display();
+    flush();
 
     s_last_update = millis();
     s_last_rate_time = millis();
@@ -67,57 +406,52 @@ void init() {
 
 void update() {
     uint32_t now = millis();
-
-    // Calculate poll rate (polls per second)
-    uint32_t dt = now - s_last_rate_time;
-    if (dt >= 1000) {
-        s_poll_rate = (float)(s_poll_count - s_last_poll_count) * 1000.0f / dt;
-        s_last_poll_count = s_poll_count;
-        s_last_rate_time = now;
-    }
-
-    auto kbd_status = ble_hid_host::get_keyboard_status();
-    auto mouse_status = ble_hid_host::get_mouse_status();
+    uint32_t render_start = micros();
+    metrics::snapshot(s_snap);
+    sample_interval(now);
 
     s_display->clear();
     s_display->setTextAlignment(TEXT_ALIGN_LEFT);
 
-    // Line 1: Keyboard status
-    char line[64];
-    snprintf(line, sizeof(line), "KBD: [%s] %.16s",
-             state_str(kbd_status.state), kbd_status.name);
-    s_display->drawString(0, 0, line);
-
-    // Line 2: Mouse status
-    snprintf(line, sizeof(line), "MOU: [%s] %.16s",
-             state_str(mouse_status.state), mouse_status.name);
-    s_display->drawString(0, 14, line);
-
-    // Line 3: ADB bus status
-    snprintf(line, sizeof(line), "ADB: %s  Rate:%.0f/s",
-             s_adb_active ? "ACTIVE" : "idle", s_poll_rate);
-    s_display->drawString(0, 28, line);
-
-    // Line 4: Counters
-    snprintf(line, sizeof(line), "Polls:%lu Events:%lu",
-             s_poll_count, s_event_count);
-    s_display->drawString(0, 42, line);
-
-    // Activity indicator (small filled circle when ADB is active)
-    if (s_adb_active) {
-        s_display->fillCircle(122, 32, 4);
-        s_adb_active = false;  // auto-clear, must be set each cycle
+    switch (s_page) {
+        case Page::STATUS:  draw_status();  break;
+        case Page::LATENCY: draw_latency(); break;
+        case Page::QUEUES:  draw_queues();  break;
+        case Page::BUS:     draw_bus();     break;
+        case Page::BLE:     draw_ble();     break;
+        default: break;
     }
+    s_adb_active = false;  // auto-clear, must be set each cycle
+
+    uint32_t flush_start = micros();
+    flush();
+    uint32_t flush_end = micros();
 
-    s_display->display();
+    metrics::inc(metrics::Counter::OLED_FRAMES);
+    metrics::record(metrics::Histogram::OLED_RENDER_US, flush_start - render_start);
+    metrics::record(metrics::Histogram::OLED_FLUSH_US, flush_end - flush_start);
 }
 
 void task_loop() {
     Serial.println("[OLED] Task loop started on core " + String(xPortGetCoreID()));
 
+    // Start from the current level so a BOOT press held through the
+    // bond-clear window doesn't flip the page on startup
+    bool was_pressed = digitalRead(BOND_CLEAR_PIN) == LOW;
+
     while (true) {
-        update();
-        vTaskDelay(pdMS_TO_TICKS(OLED_UPDATE_INTERVAL_MS));
+        bool pressed = digitalRead(BOND_CLEAR_PIN) == LOW;
+        bool next = pressed && !was_pressed;
+        was_pressed = pressed;
+
+        if (next) {
+            s_page = (Page)(((uint8_t)s_page + 1) % (uint8_t)Page::COUNT);
+        }
+        if (next || millis() - s_last_update >= OLED_UPDATE_INTERVAL_MS) {
+            s_last_update = millis();
+            update();
+        }
+        vTaskDelay(pdMS_TO_TICKS(OLED_BUTTON_POLL_MS));
     }
 }
 
@@ -125,14 +459,6 @@ void set_adb_active(bool active) {
     s_adb_active = active;
 }
 
-void inc_poll_count() {
-    s_poll_count++;
-}
-
-void inc_event_count() {
-    s_event_count++;
-}
-
 void show_message(const char* line1, const char* line2) {
     if (!s_display) return;
     s_display->clear();
@@ -141,8 +467,16 @@ void show_message(const char* line1, const char* line2) {
     if (line2) {
         s_display->drawString(64, 36, line2);
     }
-    s_display->display();
+    flush();
     s_display->setTextAlignment(TEXT_ALIGN_LEFT);  // restore for update()
 }
 
+void set_full_refresh(bool full) {
+    s_full_refresh = full;
+}
+
+bool full_refresh() {
+    return s_full_refresh;
+}
+
 } // namespace oled_display
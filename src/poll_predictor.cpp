@@ -0,0 +1,104 @@
+#include "poll_predictor.h"
+#include "poll_cadence.h"
+#include "adb_platform.h"
+#include "metrics.h"
+#include "config.h"
+
+#include <Arduino.h>
+
+namespace poll_predictor {
+
+// ─── Predictor state (Core 1 only) ──────────────────────────────────────────
+
+static PollCadence s_cadence;
+
+bool locked() {
+    return s_cadence.locked();
+}
+
+void on_attention(uint32_t t_us) {
+    PollCadence::Attention a = s_cadence.on_attention(t_us);
+    if (!a.new_burst) return;
+
+    if (a.scored) {
+        metrics::record(metrics::Histogram::ADB_PRED_ERR_US, a.err_us < 0 ? -a.err_us : a.err_us);
+        if (a.err_us < -(int32_t)ADB_JOB_GUARD_US) {
+            metrics::inc(metrics::Counter::ADB_PRED_EARLY);   // a job could have been in the way
+        }
+    }
+
+    metrics::set(metrics::Gauge::ADB_POLL_PERIOD_US, s_cadence.period_us());
+    metrics::set(metrics::Gauge::ADB_POLL_BURST, s_cadence.burst());
+    metrics::set(metrics::Gauge::ADB_PRED_LOCKED, s_cadence.locked() ? 1 : 0);
+}
+
+void on_transaction_end(uint32_t t_us) {
+    s_cadence.on_transaction_end(t_us);
+}
+
+uint32_t idle_budget_us(uint32_t now_us) {
+    return s_cadence.idle_budget_us(now_us);
+}
+
+// ─── Idle-gap jobs ──────────────────────────────────────────────────────────
+
+struct Job {
+    const char* name;
+    JobFn       fn;
+    uint32_t    cost_us;    // declared worst case
+    uint32_t    max_us;     // recent worst case: jumps to a longer run, decays
+};
+
+static Job      s_jobs[ADB_IDLE_JOBS_MAX];
+static uint32_t s_num_jobs = 0;
+static uint32_t s_next_job = 0;     // round-robin start
+
+void add_job(const char* name, JobFn fn, uint32_t cost_us) {
+    if (s_num_jobs >= ADB_IDLE_JOBS_MAX) {
+        Serial.printf("[ADB] Idle job table full — '%s' not added\n", name);
+        return;
+    }
+    s_jobs[s_num_jobs++] = Job{ name, fn, cost_us, 0 };
+}
+
+void run_idle_jobs() {
+    if (s_num_jobs == 0) return;
+
+    uint32_t now = adb_platform::micros_now();
+    uint32_t budget = idle_budget_us(now);
+    if (budget == 0) return;
+    uint32_t deadline = now + budget;
+
+    for (uint32_t i = 0; i < s_num_jobs; i++) {
+        Job& job = s_jobs[(s_next_job + i) % s_num_jobs];
+        uint32_t cost = job.max_us > job.cost_us ? job.max_us : job.cost_us;
+
+        uint32_t start = adb_platform::micros_now();
+        if ((int32_t)(deadline - start) < (int32_t)cost) {
+            // Doesn't fit — try a smaller one. Let a stretched run (an
+            // interrupt landed in it) wear off, or the job could be shut
+            // out of every window shorter than the outlier for good.
+            job.max_us -= job.max_us >> ADB_JOB_DECAY_SHIFT;
+            continue;
+        }
+        if (!adb_platform::read_pin()) return;                       // host already started
+
+        job.fn();
+
+        uint32_t end = adb_platform::micros_now();
+        uint32_t run = end - start;
+        job.max_us = run > job.max_us ? run
+                                       : job.max_us - ((job.max_us - run) >> ADB_JOB_DECAY_SHIFT);
+        metrics::inc(metrics::Counter::ADB_JOB_RUNS);
+        if ((int32_t)(end - deadline) > 0) {
+            metrics::inc(metrics::Counter::ADB_JOB_OVERRUNS);
+        }
+        if (!adb_platform::read_pin()) {
+            metrics::inc(metrics::Counter::ADB_JOB_COLLISIONS);
+            return;
+        }
+    }
+    s_next_job = (s_next_job + 1) % s_num_jobs;
+}
+
+} // namespace poll_predictor
@@ -0,0 +1,62 @@
+#include "profiler.h"
+#include "metrics.h"
+#include "config.h"
+
+#include <Arduino.h>
+
+namespace profiler {
+
+// ─── Storage ────────────────────────────────────────────────────────────────
+
+namespace detail {
+ZoneSlot g_zones[NUM_ZONES] = {};
+}
+
+static const char* const s_zone_names[] = {
+#define PROF_NAME(id, name) name,
+    PROF_ZONE_LIST(PROF_NAME)
+#undef PROF_NAME
+};
+
+const char* name(Zone z) { return s_zone_names[(uint32_t)z]; }
+
+// ─── Reporting ──────────────────────────────────────────────────────────────
+
+static uint32_t percentile(const detail::ZoneSlot& s, uint32_t permille) {
+    return metrics::log2_percentile(s.buckets, s.count, s.max, permille);
+}
+
+void report() {
+#if !ADB_PROFILE
+    Serial.println("[PROF] Profiler not compiled in (build with ADB_PROFILE=1)");
+#else
+    uint32_t mhz = getCpuFrequencyMhz();
+    Serial.printf("[PROF] %-16s %8s %7s %7s %7s %7s %8s  (cycles @ %lu MHz)\n",
+                  "zone", "n", "min", "avg", "p50", "p99", "max", (unsigned long)mhz);
+
+    for (uint32_t z = 0; z < NUM_ZONES; z++) {
+        // Copy first so one line is self-consistent
+        uint32_t irq = portSET_INTERRUPT_MASK_FROM_ISR();
+        detail::ZoneSlot s = detail::g_zones[z];
+        portCLEAR_INTERRUPT_MASK_FROM_ISR(irq);
+        if (s.count == 0) continue;
+
+        uint32_t avg = (uint32_t)(s.sum / s.count);
+        Serial.printf("[PROF] %-16s %8lu %7lu %7lu %7lu %7lu %8lu  max=%luus\n",
+                      s_zone_names[z], s.count, s.min, avg,
+                      percentile(s, 500), percentile(s, 990), s.max,
+                      s.max / mhz);
+    }
+#endif
+}
+
+void reset() {
+    for (uint32_t z = 0; z < NUM_ZONES; z++) {
+        uint32_t irq = portSET_INTERRUPT_MASK_FROM_ISR();
+        detail::g_zones[z] = detail::ZoneSlot{};
+        portCLEAR_INTERRUPT_MASK_FROM_ISR(irq);
+    }
+    Serial.println("[PROF] Reset");
+}
+
+} // namespace profiler
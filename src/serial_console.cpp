@@ -0,0 +1,169 @@
+#include "serial_console.h"
+#include "metrics.h"
+#include "profiler.h"
+#include "oled_display.h"
+#include "text_inject.h"
+#include "flow_control.h"
+#include "config.h"
+
+#include <Arduino.h>
+#include <cstdlib>
+#include <cstring>
+
+namespace serial_console {
+
+// ─── Commands ───────────────────────────────────────────────────────────────
+
+static void cmd_help(const char* args);
+
+static void cmd_metrics(const char* args) {
+    static metrics::Snapshot snap;   // static — too large for the caller's stack
+    metrics::snapshot(snap);
+    metrics::dump(snap);
+}
+
+static void cmd_prof(const char* args) {
+    if (strcmp(args, "reset") == 0) {
+        profiler::reset();
+    } else {
+        profiler::report();
+    }
+}
+
+static void cmd_oled(const char* args) {
+    if (strcmp(args, "full") == 0) {
+        oled_display::set_full_refresh(true);
+    } else if (strcmp(args, "diff") == 0) {
+        oled_display::set_full_refresh(false);
+    }
+    Serial.printf("[CON] OLED refresh: %s\n",
+                  oled_display::full_refresh() ? "full frame" : "changed pages only");
+}
+
+static bool    s_paste = false;  // raw input goes to text_inject until TYPE_END
+static XonXoff s_flow(TYPE_XOFF_FREE, TYPE_XON_FREE);
+
+/// Tell the sender to pause or resume as the text ring fills and drains.
+static void flow_update() {
+    uint8_t ctl = s_flow.update(text_inject::space());
+    if (ctl) Serial.write(ctl);
+}
+
+static void cmd_type(const char* args) {
+    static const uint8_t end = TYPE_END;
+    size_t len = strlen(args);
+    if (text_inject::space() < len + 1) {
+        Serial.printf("[CON] Type buffer full — %u bytes free, line needs %u\n",
+                      (unsigned)text_inject::space(), (unsigned)(len + 1));
+        return;
+    }
+    text_inject::write((const uint8_t*)args, len);
+    text_inject::write(&end, 1);
+}
+
+static void cmd_paste(const char* args) {
+    s_paste = true;
+    Serial.println("[CON] Paste mode — send the text with XON/XOFF flow control, end with Ctrl-D");
+}
+
+static void cmd_pace(const char* args) {
+    if (*args) text_inject::set_pace_ms((uint32_t)strtoul(args, nullptr, 10));
+    Serial.printf("[CON] Type pace: %lums per character%s\n",
+                  text_inject::pace_ms(), text_inject::pace_ms() ? "" : " (bus rate)");
+}
+
+struct Command {
+    const char* name;
+    void (*handler)(const char* args);
+    const char* help;
+};
+
+static const Command s_commands[] = {
+    { "help",    cmd_help,    "list commands" },
+    { "metrics", cmd_metrics, "dump the metrics registry" },
+    { "prof",    cmd_prof,    "hot-path cycle profile ('prof reset' clears)" },
+    { "oled",    cmd_oled,    "OLED refresh mode ('oled full' / 'oled diff')" },
+    { "type",    cmd_type,    "type the rest of the line into the Mac" },
+    { "paste",   cmd_paste,   "type everything sent until Ctrl-D into the Mac" },
+    { "pace",    cmd_pace,    "pause after each typed character ('pace <ms>', 0 = bus rate)" },
+};
+
+static void cmd_help(const char* args) {
+    for (const Command& c : s_commands) {
+        Serial.printf("[CON] %-8s %s\n", c.name, c.help);
+    }
+}
+
+// ─── Line input ─────────────────────────────────────────────────────────────
+
+static char     s_line[CONSOLE_LINE_MAX];
+static uint32_t s_len = 0;
+static bool     s_overlong = false;
+
+static void run_line(char* line) {
+    char* args = strchr(line, ' ');
+    if (args) {
+        *args++ = '\0';
+        while (*args == ' ') args++;
+    } else {
+        args = line + strlen(line);
+    }
+
+    for (const Command& c : s_commands) {
+        if (strcmp(line, c.name) == 0) {
+            c.handler(args);
+            return;
+        }
+    }
+    Serial.printf("[CON] Unknown command '%s' (try 'help')\n", line);
+}
+
+void feed(uint8_t byte) {
+    if (s_paste) {
+        text_inject::write(&byte, 1);
+        flow_update();
+        if (byte == TYPE_END) {
+            s_paste = false;
+            Serial.println("[CON] Paste mode ended");
+        }
+        return;
+    }
+
+    if (byte == '\r' || byte == '\n') {
+        if (s_overlong) {
+            Serial.println("[CON] Line too long — ignored");
+        } else if (s_len > 0) {
+            s_line[s_len] = '\0';
+            run_line(s_line);
+        }
+        s_len = 0;
+        s_overlong = false;
+    } else if (s_len < CONSOLE_LINE_MAX - 1) {
+        s_line[s_len++] = (char)byte;
+    } else {
+        s_overlong = true;
+    }
+}
+
+bool raw_mode() {
+    return s_paste;
+}
+
+bool accepting() {
+    return !s_paste || text_inject::space() > 1;
+}
+
+void service() {
+    if (s_flow.stopped()) flow_update();
+}
+
+void poll() {
+    while (accepting() && Serial.available() > 0) {
+        int ch = Serial.read();
+        if (ch < 0) break;
+        feed((uint8_t)ch);
+    }
+    service();
+}
+
+} // namespace serial_console
@@ -0,0 +1,143 @@
+#include "text_inject.h"
+#include "text_encoder.h"
+#include "event_queue.h"
+#include "adb_keyboard.h"
+#include "spsc_ring.h"
+#include "metrics.h"
+#include "config.h"
+
+#include <Arduino.h>
+
+namespace text_inject {
+
+// ─── Ring and task ──────────────────────────────────────────────────────────
+
+// Producer: console (status task, or the Inject task with ADB_HID_INJECT).
+// Consumer: type task.
+static SpscRing<uint8_t, TYPE_BUF_SIZE> s_text;
+static TaskHandle_t      s_task    = nullptr;
+static volatile uint32_t s_pace_ms = TYPE_PACE_MS;
+static volatile bool     s_busy    = false;
+
+// ─── Public interface ───────────────────────────────────────────────────────
+
+size_t write(const uint8_t* data, size_t length) {
+    size_t accepted = 0;
+    while (accepted < length) {
+        if (data[accepted] != TYPE_END && space() <= 1) break;
+        if (!s_text.push(data[accepted])) break;
+        accepted++;
+    }
+    if (accepted < length) {
+        metrics::inc(metrics::Counter::TYPE_DROPPED, length - accepted);
+    }
+    if (accepted) {
+        s_busy = true;
+        if (s_task) xTaskNotifyGive(s_task);
+    }
+    return accepted;
+}
+
+size_t space() {
+    return s_text.capacity() - s_text.size();
+}
+
+void set_pace_ms(uint32_t ms) {
+    s_pace_ms = ms;
+}
+
+uint32_t pace_ms() {
+    return s_pace_ms;
+}
+
+bool busy() {
+    return s_busy;
+}
+
+// ─── Type task ──────────────────────────────────────────────────────────────
+
+/// Push one encoded event to `bus`.
+/// @return false if the queue had no room (retry later).
+static bool send_event(uint8_t bus, uint8_t adb_event) {
+    KbdEvent evt;
+    evt.adb_keycode  = adb_event & 0x7F;
+    evt.released     = (adb_event & TextEncoder::RELEASE) != 0;
+    evt.t_capture_us = micros();
+    return event_queue::send_kbd(bus, evt);
+}
+
+void task_loop() {
+    Serial.println("[TYPE] Task loop started on core " + String(xPortGetCoreID()));
+    s_task = xTaskGetCurrentTaskHandle();
+
+    TextEncoder encoder;
+    uint8_t  staged[TextEncoder::MAX_EVENTS];
+    int      staged_count = 0;
+    int      staged_next  = 0;
+    bool     typing   = false;
+    bool     ended    = false;     // TYPE_END reached; waiting for the wire
+    uint8_t  bus      = 0;
+    uint32_t start_ms = 0;
+    uint32_t resume_ms = 0;        // pace: no new character before this
+
+    while (true) {
+        if (!typing) {
+            if (s_text.empty()) {
+                s_busy = false;
+                ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+                continue;
+            }
+            // A run of text goes to the bus that had focus when it started
+            typing   = true;
+            ended    = false;
+            bus      = event_queue::focus();
+            start_ms = millis();
+            resume_ms = start_ms;  // a stale pace deadline would read as 24.8 days ahead
+            encoder.reset();
+        }
+
+        // Top up to TYPE_QUEUE_DEPTH events in flight (queued or in the
+        // keyboard's buffer): staged events first, then more text
+        QueueHandle_t queue = event_queue::kbd_queue(bus);
+        while (uxQueueMessagesWaiting(queue) + adb_keyboard::buffered(bus) < TYPE_QUEUE_DEPTH) {
+            if (staged_next < staged_count) {
+                if (!send_event(bus, staged[staged_next])) break;
+                staged_next++;
+                continue;
+            }
+            if (ended || (int32_t)(millis() - resume_ms) < 0) break;
+
+            uint8_t byte;
+            if (!s_text.pop(byte)) break;
+            staged_next = 0;
+            if (byte == TYPE_END) {
+                staged_count = encoder.finish(staged);
+                ended = true;
+            } else {
+                staged_count = encoder.feed(byte, staged);
+                if (staged_count && s_pace_ms) resume_ms = millis() + s_pace_ms;
+            }
+        }
+
+        // Done once the last key has left the keyboard. has_data() reads
+        // Core 1's buffer indices without a lock — fine for waiting on it
+        // to settle.
+        if (ended && staged_next >= staged_count && !adb_keyboard::has_data(bus)) {
+            uint32_t elapsed_ms = millis() - start_ms;
+            uint32_t chars = encoder.chars();
+            uint32_t cps = elapsed_ms ? (uint32_t)((uint64_t)chars * 1000 / elapsed_ms) : 0;
+            metrics::inc(metrics::Counter::TYPE_CHARS, chars);
+            metrics::inc(metrics::Counter::TYPE_UNMAPPED, encoder.unmapped());
+            metrics::set(metrics::Gauge::TYPE_CPS, cps);
+            Serial.printf("[TYPE] %lu chars in %lu.%03lus — %lu cps (unmapped:%lu pace:%lums)\n",
+                          chars, elapsed_ms / 1000, elapsed_ms % 1000, cps,
+                          encoder.unmapped(), (uint32_t)s_pace_ms);
+            typing = false;
+            continue;
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(TYPE_POLL_MS));
+    }
+}
+
+} // namespace text_inject
@@ -0,0 +1,120 @@
+// Host-side simulation of the ADB command-byte decoder against skewed hosts.
+//
+// Generates command bytes as a host with the given '1'/'0' low times, sync
+// time and jitter would send them, measures each bit cell's low time the
+// way receive_bit() does (whole microseconds), and decodes every byte twice:
+// with the fixed ADB_BIT_THRESHOLD_US split, and with the firmware's
+// adaptive BitTiming (include/bit_timing.h), which learns from every byte
+// it decodes exactly as the bus loop does. Prints the decode success rate
+// of both per host profile, plus where the adaptive estimates settled.
+//
+// Build:  g++ -std=c++11 -O2 -Iinclude -o adb_bit_sim tools/adb_bit_sim.cpp
+// Usage:  ./adb_bit_sim [commands-per-profile] [seed]
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "config.h"
+#include "bit_timing.h"
+
+// ─── Host profiles ──────────────────────────────────────────────────────────
+
+struct HostProfile {
+    const char* name;
+    double bit1_us;      // '1' low time
+    double bit0_us;      // '0' low time
+    double sync_us;      // sync high time
+    double jitter_us;    // uniform ± on every interval
+    double drift_us;     // added to all three by the end of the run
+};
+
+static const HostProfile s_profiles[] = {
+    { "nominal",     35, 65, 65,  3,  0 },
+    { "fast",        28, 50, 52,  4,  0 },
+    { "slow",        47, 78, 78,  4,  0 },
+    { "short-gap",   44, 64, 65,  5,  0 },
+    { "noisy",       35, 65, 65, 12,  0 },
+    { "drifting",    35, 65, 65,  4, 12 },
+};
+
+// ─── Deterministic PRNG (xorshift32) ────────────────────────────────────────
+
+static uint32_t s_rng = 1;
+
+static uint32_t rng() {
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+/// Uniform in [-1, 1].
+static double rng_unit() {
+    return (double)(rng() % 20001) / 10000.0 - 1.0;
+}
+
+/// A measured interval: nominal + jitter, truncated to whole µs like
+/// micros_now() deltas.
+static uint32_t measure(double nominal, double jitter) {
+    double v = nominal + jitter * rng_unit();
+    return v < 0 ? 0 : (uint32_t)v;
+}
+
+/// Mostly Talk R0 to the keyboard and mouse, as a Mac polls; the rest random.
+static uint8_t next_command() {
+    switch (rng() % 8) {
+        case 0: case 1: case 2: return 0x2C;    // Talk R0, addr 2
+        case 3: case 4: case 5: return 0x3C;    // Talk R0, addr 3
+        default:                return (uint8_t)rng();
+    }
+}
+
+// ─── Run ────────────────────────────────────────────────────────────────────
+
+int main(int argc, char** argv) {
+    uint32_t n = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 0) : 100000;
+    uint32_t seed = argc > 2 ? (uint32_t)strtoul(argv[2], nullptr, 0) : 1;
+
+    printf("%-10s %6s %6s %6s %5s | %8s %8s | %4s %5s %5s %7s\n",
+           "profile", "bit1", "bit0", "sync", "jit", "fixed", "adaptive",
+           "thr", "est1", "est0", "reject");
+
+    for (const HostProfile& p : s_profiles) {
+        s_rng = seed ? seed : 1;
+        BitTiming timing;
+        uint32_t ok_fixed = 0, ok_adaptive = 0, rejects = 0;
+
+        for (uint32_t i = 0; i < n; i++) {
+            double drift = p.drift_us * i / n;
+            uint8_t sent = next_command();
+
+            uint32_t sync = measure(p.sync_us + drift, p.jitter_us);
+            uint8_t lows[8];
+            int fixed = 0, adaptive = 0;
+            for (int b = 7; b >= 0; b--) {
+                bool one = (sent >> b) & 1;
+                uint32_t low = measure((one ? p.bit1_us : p.bit0_us) + drift, p.jitter_us);
+                lows[7 - b] = low > 0xFF ? 0xFF : (uint8_t)low;
+                fixed    |= (low < ADB_BIT_THRESHOLD_US ? 1 : 0) << b;
+                adaptive |= timing.classify(low) << b;
+            }
+            if (fixed == sent) ok_fixed++;
+            if (adaptive == sent) ok_adaptive++;
+
+            // The bus loop learns from every command it decodes
+            if (timing.learn_byte(lows)) {
+                timing.learn_sync(sync);
+            } else {
+                rejects++;
+            }
+        }
+
+        printf("%-10s %6.0f %6.0f %6.0f %5.0f | %7.3f%% %7.3f%% | %4lu %5lu %5lu %7lu\n",
+               p.name, p.bit1_us, p.bit0_us, p.sync_us, p.jitter_us,
+               100.0 * ok_fixed / n, 100.0 * ok_adaptive / n,
+               (unsigned long)timing.threshold_us(), (unsigned long)timing.bit1_us(),
+               (unsigned long)timing.bit0_us(), (unsigned long)rejects);
+    }
+    return 0;
+}
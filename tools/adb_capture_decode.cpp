@@ -0,0 +1,392 @@
+// Host-side decoder for the bridge's logic-analyzer capture (ADB_BUS_CAPTURE=1).
+//
+// Reads a raw serial capture from a file or stdin, rebuilds the ADB line's
+// edge timeline from the binary frames described in include/bus_capture.h,
+// and prints one annotated line per bus transaction: reset, attention/sync
+// timing, command, SRQ, Tlt and the data cells — with keyboard keycodes
+// named through the firmware's reverse keycode map and mouse / register 3
+// fields unpacked. Bytes outside frames (plain Serial output) pass through.
+// Optionally writes every edge to a VCD file for a waveform viewer.
+//
+// Build:  g++ -std=c++11 -O2 -Iinclude -o adb_capture_decode
+//             tools/adb_capture_decode.cpp src/keycode_map.cpp
+// Usage:  ./adb_capture_decode capture.bin
+//         ./adb_capture_decode --vcd bus.vcd capture.bin
+//         cat /dev/ttyUSB0 | ./adb_capture_decode
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "config.h"
+#include "bus_capture.h"
+#include "keycode_map.h"
+
+// ─── Edge timeline ──────────────────────────────────────────────────────────
+
+struct Edge {
+    uint64_t t_us;    // unwrapped capture time
+    bool     level;   // line level after the edge
+};
+
+static std::vector<Edge> s_edges;     // edges not yet consumed by the decoder
+static uint64_t s_epoch     = 0;      // unwrapped time of the last frame start
+static uint32_t s_last_t0   = 0;
+static bool     s_have_time = false;
+static uint32_t s_frames    = 0;
+static uint32_t s_bad_frames = 0;
+static uint32_t s_overflows = 0;
+
+static FILE* s_vcd = nullptr;
+static bool  s_vcd_level_known = false;
+
+static void vcd_header() {
+    fprintf(s_vcd, "$timescale 1us $end\n");
+    fprintf(s_vcd, "$scope module adb $end\n");
+    fprintf(s_vcd, "$var wire 1 ! data $end\n");
+    fprintf(s_vcd, "$upscope $end\n");
+    fprintf(s_vcd, "$enddefinitions $end\n");
+}
+
+static void add_edge(uint64_t t, bool level) {
+    s_edges.push_back(Edge{t, level});
+    if (s_vcd) {
+        fprintf(s_vcd, "#%llu\n%c!\n", (unsigned long long)t, level ? '1' : '0');
+        s_vcd_level_known = true;
+    }
+}
+
+static uint32_t le32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/// Read one LEB128 varint. Returns bytes used, 0 if malformed,
+/// or -1 if the buffer ends first.
+static int get_varint(const uint8_t* p, size_t len, uint32_t& out) {
+    out = 0;
+    for (int i = 0; i < 5; i++) {
+        if ((size_t)i >= len) return -1;
+        out |= (uint32_t)(p[i] & 0x7F) << (7 * i);
+        if (!(p[i] & 0x80)) return i + 1;
+    }
+    return 0;
+}
+
+/// Try to decode a frame at buf[0]. Returns bytes consumed, 0 if the bytes
+/// are not a valid frame, or -1 if more input is needed.
+static long decode_frame(const uint8_t* buf, size_t len) {
+    if (len < 2) return -1;
+    if (buf[0] != CAPTURE_FRAME_SYNC0 || buf[1] != CAPTURE_FRAME_SYNC1) return 0;
+    if (len < 8) return -1;
+
+    uint8_t n     = buf[2];
+    uint8_t flags = buf[3];
+    if (n == 0 || n > BUS_CAPTURE_FRAME_EDGES || (flags & ~0x03)) return 0;
+
+    uint32_t deltas[BUS_CAPTURE_FRAME_EDGES];
+    size_t pos = 8;
+    for (uint8_t i = 1; i < n; i++) {
+        int used = get_varint(buf + pos, len - pos, deltas[i]);
+        if (used < 0) return -1;
+        if (used == 0) return 0;
+        pos += used;
+    }
+    if (pos >= len) return -1;
+
+    uint8_t x = 0;
+    for (size_t i = 2; i < pos; i++) x ^= buf[i];
+    if (x != buf[pos]) {
+        s_bad_frames++;
+        return 0;
+    }
+
+    // Unwrap the 31-bit frame timestamp against the previous frame
+    uint32_t t0 = le32(buf + 4) & CAPTURE_TIME_MASK;
+    if (s_have_time) {
+        s_epoch += (t0 - s_last_t0) & CAPTURE_TIME_MASK;
+    } else {
+        s_epoch = t0;
+        s_have_time = true;
+    }
+    s_last_t0 = t0;
+
+    if (flags & CAPTURE_FLAG_OVERFLOW) {
+        s_overflows++;
+        printf("%12.6f  !! capture overflow — edges lost before this point\n", s_epoch / 1e6);
+        s_edges.clear();   // the decoder can't bridge the gap
+    }
+
+    bool level = flags & CAPTURE_FLAG_LEVEL;
+    uint64_t t = s_epoch;
+    if (s_vcd && !s_vcd_level_known) vcd_header();
+    add_edge(t, level);
+    for (uint8_t i = 1; i < n; i++) {
+        t += deltas[i];
+        level = !level;
+        add_edge(t, level);
+    }
+
+    s_frames++;
+    return (long)(pos + 1);
+}
+
+// ─── Transaction decoder ────────────────────────────────────────────────────
+
+/// One low pulse and the high that follows it.
+struct Cell {
+    uint64_t t;      // falling edge
+    uint32_t low;
+    uint32_t high;   // UINT32_MAX if the next falling edge hasn't arrived
+};
+
+static const uint32_t HIGH_OPEN     = 0xFFFFFFFF;
+static const uint32_t CELL_GAP_US   = 2 * ADB_BIT_CELL_US;       // high that ends a bit run
+static const uint32_t SRQ_MIN_US    = (ADB_STOP_LOW_US + ADB_SRQ_LOW_US) / 2;
+
+// Device type at each bus address — follows address moves (Listen R3)
+enum Device : uint8_t { DEV_NONE, DEV_KBD, DEV_MOUSE };
+static Device s_dev_at[16];
+
+static const char* const s_cmd_names[] = {"Reset", "Flush", "Listen", "Talk"};
+
+/// Bits from a run of cells: short low = 1.
+static uint64_t cells_to_bits(const Cell* c, int count) {
+    uint64_t v = 0;
+    for (int i = 0; i < count; i++) {
+        v = (v << 1) | (c[i].low < ADB_BIT_THRESHOLD_US ? 1 : 0);
+    }
+    return v;
+}
+
+static void print_key(uint8_t b) {
+    if (b == 0xFF) return;
+    const char* name = keycode_map::adb_key_name(b & 0x7F);
+    if (name) {
+        printf(" %s%s", name, (b & 0x80) ? "↑" : "↓");
+    } else {
+        printf(" key%02X%s", b & 0x7F, (b & 0x80) ? "↑" : "↓");
+    }
+}
+
+static int seven_bit(uint8_t v) {
+    return (v & 0x40) ? (int)(v & 0x7F) - 128 : (int)(v & 0x7F);
+}
+
+/// Annotate a register value with what it means for the addressed device.
+static void annotate(uint8_t addr, uint8_t cmd, uint8_t reg, const uint8_t* data, int nbytes) {
+    if (reg == 3 && nbytes == 2) {
+        uint8_t new_addr = data[0] & 0x0F;
+        uint8_t handler  = data[1];
+        printf("  [addr=%u handler=0x%02X%s%s]", new_addr, handler,
+               (data[0] & 0x20) ? " srq-en" : "", (data[0] & 0x40) ? " exc" : "");
+        if (cmd == ADB_CMD_LISTEN && (handler == 0xFE || handler == 0x00) && new_addr != addr) {
+            s_dev_at[new_addr] = s_dev_at[addr];
+            s_dev_at[addr] = DEV_NONE;
+        }
+        return;
+    }
+    if (reg != 0 || cmd != ADB_CMD_TALK || nbytes != 2) return;
+
+    if (s_dev_at[addr] == DEV_KBD) {
+        printf("  [");
+        if (data[0] == 0x7F && data[1] == 0x7F) {
+            printf(" Power↓");
+        } else if (data[0] == 0xFF && data[1] == 0xFF) {
+            printf(" Power↑");
+        } else {
+            print_key(data[0]);
+            print_key(data[1]);
+        }
+        printf(" ]");
+    } else if (s_dev_at[addr] == DEV_MOUSE) {
+        printf("  [btn=%s dx=%d dy=%d]", (data[0] & 0x80) ? "up" : "down",
+               seven_bit(data[1]), seven_bit(data[0]));
+    }
+}
+
+/// Decode one transaction starting with an attention pulse at cells[0].
+/// Returns the number of cells consumed, or 0 if more edges are needed.
+static size_t decode_transaction(const Cell* c, size_t count) {
+    // attention + 8 command bits + stop bit
+    if (count < 10) return 0;
+
+    uint32_t attn = c[0].low;
+    uint32_t sync = c[0].high;
+    uint8_t cmd_byte = (uint8_t)cells_to_bits(c + 1, 8);
+    uint8_t addr = cmd_byte >> 4;
+    uint8_t cmd  = (cmd_byte >> 2) & 0x03;
+    uint8_t reg  = cmd_byte & 0x03;
+
+    const Cell& stop = c[9];
+    bool srq = stop.low >= SRQ_MIN_US;
+    uint32_t tlt = stop.high;
+    if (tlt == HIGH_OPEN) return 0;   // can't tell yet whether data follows
+
+    size_t used = 10;
+    bool data_follows = (cmd == ADB_CMD_TALK || cmd == ADB_CMD_LISTEN) &&
+                        tlt <= ADB_TLT_MAX_US + 100;
+
+    // Data run: start bit, 8·n data bits, stop bit — ends at a long high
+    size_t end = used;
+    if (data_follows) {
+        while (end < count && c[end].high < CELL_GAP_US) end++;
+        if (end >= count || c[end].high == HIGH_OPEN) return 0;   // run still open
+        end++;                                                    // include the stop bit
+    }
+
+    printf("%12.6f  attn=%lu sync=%lu cmd=0x%02X %-6s a%u r%u%s",
+           c[0].t / 1e6, (unsigned long)attn, (unsigned long)sync, cmd_byte,
+           s_cmd_names[cmd], addr, reg, srq ? " SRQ" : "");
+
+    if (!data_follows) {
+        if (cmd == ADB_CMD_TALK) printf("  (no reply)");
+        printf("\n");
+        return used;
+    }
+
+    int bits = (int)(end - used);
+    int data_bits = bits - 2;
+    printf("  tlt=%lu %s", (unsigned long)tlt, cmd == ADB_CMD_TALK ? "→" : "←");
+
+    if (data_bits < 8 || data_bits % 8 != 0 || cells_to_bits(c + used, 1) != 1) {
+        printf(" malformed data (%d cells)\n", bits);
+        return end;
+    }
+
+    uint8_t data[8];
+    int nbytes = data_bits / 8;
+    if (nbytes > 8) nbytes = 8;
+    for (int i = 0; i < nbytes; i++) {
+        data[i] = (uint8_t)cells_to_bits(c + used + 1 + 8 * i, 8);
+        printf(" %02X", data[i]);
+    }
+    annotate(addr, cmd, reg, data, nbytes);
+    printf("\n");
+    return end;
+}
+
+/// Decode as many complete transactions as the buffered edges allow.
+static void decode_edges(bool final) {
+    std::vector<Cell> cells;
+    size_t i = 0;
+    while (i < s_edges.size() && s_edges[i].level) i++;   // first falling edge
+
+    for (; i < s_edges.size(); i++) {
+        if (s_edges[i].level) continue;
+        if (i + 1 >= s_edges.size()) break;              // low still in progress
+        Cell cell;
+        cell.t    = s_edges[i].t_us;
+        cell.low  = (uint32_t)(s_edges[i + 1].t_us - s_edges[i].t_us);
+        cell.high = (i + 2 < s_edges.size())
+            ? (uint32_t)(s_edges[i + 2].t_us - s_edges[i + 1].t_us) : HIGH_OPEN;
+        if (final && cell.high == HIGH_OPEN) cell.high = CELL_GAP_US * 10;
+        cells.push_back(cell);
+    }
+
+    size_t pos = 0;
+    while (pos < cells.size()) {
+        const Cell& c = cells[pos];
+        if (c.low >= ADB_RESET_MIN_US) {
+            printf("%12.6f  GLOBAL RESET low=%luµs\n", c.t / 1e6, (unsigned long)c.low);
+            for (int a = 0; a < 16; a++) s_dev_at[a] = DEV_NONE;
+            s_dev_at[ADB_ADDR_KEYBOARD] = DEV_KBD;
+            s_dev_at[ADB_ADDR_MOUSE]    = DEV_MOUSE;
+            pos++;
+        } else if (c.low >= ADB_ATTN_MIN_US && c.low <= ADB_ATTN_MAX_US) {
+            size_t used = decode_transaction(&cells[pos], cells.size() - pos);
+            if (used == 0 && !final) break;
+            pos += used ? used : 1;
+        } else {
+            printf("%12.6f  stray low pulse %luµs\n", c.t / 1e6, (unsigned long)c.low);
+            pos++;
+        }
+    }
+
+    // Drop consumed edges — keep everything from the first undecoded cell on
+    if (final) {
+        s_edges.clear();
+    } else if (pos < cells.size()) {
+        uint64_t keep_from = cells[pos].t;
+        size_t k = 0;
+        while (k < s_edges.size() && s_edges[k].t_us < keep_from) k++;
+        s_edges.erase(s_edges.begin(), s_edges.begin() + k);
+    } else if (!cells.empty()) {
+        // Keep the edge that closes the last cell's high, if present
+        uint64_t last = cells.back().t;
+        size_t k = 0;
+        while (k < s_edges.size() && s_edges[k].t_us <= last) k++;
+        if (k < s_edges.size()) k++;                       // its rising edge
+        s_edges.erase(s_edges.begin(), s_edges.begin() + k);
+    }
+}
+
+// ─── Main ───────────────────────────────────────────────────────────────────
+
+int main(int argc, char** argv) {
+    FILE* in = stdin;
+    const char* vcd_path = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--vcd") == 0 && i + 1 < argc) {
+            vcd_path = argv[++i];
+        } else {
+            in = fopen(argv[i], "rb");
+            if (!in) {
+                perror(argv[i]);
+                return 1;
+            }
+        }
+    }
+    if (vcd_path) {
+        s_vcd = fopen(vcd_path, "w");
+        if (!s_vcd) {
+            perror(vcd_path);
+            return 1;
+        }
+    }
+
+    s_dev_at[ADB_ADDR_KEYBOARD] = DEV_KBD;
+    s_dev_at[ADB_ADDR_MOUSE]    = DEV_MOUSE;
+
+    std::vector<uint8_t> buf;
+    uint8_t chunk[4096];
+    size_t n;
+    bool eof = false;
+    bool frames_pending = false;
+
+    while (!eof) {
+        n = fread(chunk, 1, sizeof(chunk), in);
+        if (n == 0) eof = true;
+        buf.insert(buf.end(), chunk, chunk + n);
+
+        size_t pos = 0;
+        while (pos < buf.size()) {
+            long used = decode_frame(&buf[pos], buf.size() - pos);
+            if (used > 0) {
+                pos += used;
+                frames_pending = true;
+            } else if (used < 0 && !eof) {
+                break;  // partial frame — wait for more input
+            } else {
+                if (frames_pending) {
+                    decode_edges(false);   // keep transactions in order with text
+                    frames_pending = false;
+                }
+                putchar(buf[pos]);  // plain text byte
+                pos++;
+            }
+        }
+        buf.erase(buf.begin(), buf.begin() + pos);
+        decode_edges(eof);
+        fflush(stdout);
+    }
+
+    fprintf(stderr, "frames=%lu bad=%lu overflows=%lu\n",
+            (unsigned long)s_frames, (unsigned long)s_bad_frames, (unsigned long)s_overflows);
+
+    if (s_vcd) fclose(s_vcd);
+    if (in != stdin) fclose(in);
+    return 0;
+}
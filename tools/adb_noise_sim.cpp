@@ -0,0 +1,253 @@
+// Host-side simulation of ADB command reception on a noisy line.
+//
+// Builds the waveform of an attention + sync + command byte + stop bit as a
+// host sends it, overlays a noise profile (random spikes, ringing after
+// every edge, or both), and decodes it twice through a model of the bus
+// loop and receive_bit(): once with the plain line waits, and once with
+// the firmware's GlitchFilter (include/glitch_filter.h) — the exact code
+// ADB_GLITCH_FILTER=1 builds run. Prints the decode success rate of both
+// and the glitches the filter absorbed, per profile.
+//
+// The simulated line is sampled like the firmware samples it: each read
+// and each clock read advances simulated time by a fixed cost, and the
+// clock returns whole microseconds. The costs are model parameters, not
+// measurements of a particular build.
+//
+// Build:  g++ -std=c++11 -O2 -Iinclude -o adb_noise_sim tools/adb_noise_sim.cpp
+// Usage:  ./adb_noise_sim [commands-per-profile] [seed]
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
+
+#include "config.h"
+#include "glitch_filter.h"
+
+// ─── Model parameters ───────────────────────────────────────────────────────
+
+static const double READ_COST_US = 0.12;    // one pin read
+static const double NOW_COST_US  = 1.0;     // one micros_now()
+static const double JITTER_US    = 3.0;     // host timing, uniform ±
+
+// ─── Noise profiles ─────────────────────────────────────────────────────────
+
+struct NoiseProfile {
+    const char* name;
+    double spikes_per_ms;   // random level inversions
+    double spike_min_us;    // their width range
+    double spike_max_us;
+    int    ring_bounces;    // inversions after every real edge
+};
+
+static const NoiseProfile s_profiles[] = {
+    { "clean",         0, 0.0, 0.0, 0 },
+    { "spikes",        2, 0.2, 1.5, 0 },
+    { "dense-spikes", 10, 0.2, 1.5, 0 },
+    { "wide-spikes",   2, 2.0, 2.8, 0 },
+    { "ringing",       0, 0.0, 0.0, 3 },
+    { "ring+spikes",   5, 0.2, 2.0, 3 },
+};
+
+// ─── Deterministic PRNG (xorshift32) ────────────────────────────────────────
+
+static uint32_t s_rng = 1;
+
+static uint32_t rng() {
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+/// Uniform in [0, 1).
+static double rng_frac() {
+    return (double)(rng() % 1000000) / 1000000.0;
+}
+
+// ─── Simulated line ─────────────────────────────────────────────────────────
+
+struct Interval {
+    double start;
+    double end;
+};
+
+static std::vector<double>   s_edges;   // host's own transitions, from high
+static std::vector<Interval> s_noise;   // inverted spans, sorted, disjoint
+static double   s_t = 0;                // simulated time, µs
+static size_t   s_edge_pos  = 0;        // cursors (time only moves forward)
+static size_t   s_noise_pos = 0;
+static uint32_t s_glitches  = 0;
+
+static bool level_at(double t) {
+    while (s_edge_pos < s_edges.size() && s_edges[s_edge_pos] <= t) s_edge_pos++;
+    bool level = (s_edge_pos & 1) == 0;     // starts high, each edge flips
+    while (s_noise_pos < s_noise.size() && s_noise[s_noise_pos].end <= t) s_noise_pos++;
+    if (s_noise_pos < s_noise.size() && s_noise[s_noise_pos].start <= t) level = !level;
+    return level;
+}
+
+/// The Io policy GlitchFilter (and the plain waits below) sample through.
+struct SimIo {
+    static bool read() {
+        bool level = level_at(s_t);
+        s_t += READ_COST_US;
+        return level;
+    }
+    static uint32_t now() {
+        s_t += NOW_COST_US;
+        return (uint32_t)s_t;
+    }
+    static void glitch() { s_glitches++; }
+};
+
+static void add_noise(double start, double width) {
+    if (!s_noise.empty() && start < s_noise.back().end + 0.1) return;   // keep disjoint
+    s_noise.push_back(Interval{ start, start + width });
+}
+
+/// Lay out one command's waveform, then its noise.
+static void build_command(uint8_t cmd, const NoiseProfile& p) {
+    s_edges.clear();
+    s_noise.clear();
+    s_t = 0;
+    s_edge_pos = s_noise_pos = 0;
+
+    double t = 50;
+    auto jit = []() { return JITTER_US * (2 * rng_frac() - 1); };
+    auto low_high = [&](double low, double high) {
+        s_edges.push_back(t);
+        t += low + jit();
+        s_edges.push_back(t);
+        t += high + jit();
+    };
+
+    low_high(ADB_ATTN_NOMINAL_US, ADB_SYNC_NOMINAL_US);
+    for (int b = 7; b >= 0; b--) {
+        if ((cmd >> b) & 1) low_high(ADB_BIT_1_LOW_US, ADB_BIT_1_HIGH_US);
+        else                low_high(ADB_BIT_0_LOW_US, ADB_BIT_0_HIGH_US);
+    }
+    low_high(ADB_STOP_LOW_US, 200);
+    double end = t;
+
+    // Ringing after every edge and random spikes, merged in time order
+    std::vector<Interval> raw;
+    for (double e : s_edges) {
+        double at = e + 0.3;
+        for (int i = 0; i < p.ring_bounces; i++) {
+            double w = 0.35 - 0.08 * i;
+            raw.push_back(Interval{ at, at + w });
+            at += w + 0.3;
+        }
+    }
+    double expected = p.spikes_per_ms * end / 1000.0;
+    for (int i = 0; i < (int)(expected * 2 * rng_frac() + 0.5); i++) {
+        double at = end * rng_frac();
+        double w  = p.spike_min_us + (p.spike_max_us - p.spike_min_us) * rng_frac();
+        raw.push_back(Interval{ at, at + w });
+    }
+    std::sort(raw.begin(), raw.end(),
+              [](const Interval& a, const Interval& b) { return a.start < b.start; });
+    for (const Interval& i : raw) add_noise(i.start, i.end - i.start);
+}
+
+// ─── Line waits: plain (as adb_platform without the filter) and filtered ────
+
+struct PlainLines {
+    static uint32_t wait_for_state(bool state, uint32_t timeout_us) {
+        uint32_t start = SimIo::now();
+        while (SimIo::read() != state) {
+            if (SimIo::now() - start >= timeout_us) return 0;
+        }
+        return SimIo::now() - start;
+    }
+    static uint32_t measure_pulse(bool state, uint32_t timeout_us) {
+        if (SimIo::read() != state) return 0;
+        uint32_t start = SimIo::now();
+        while (SimIo::read() == state) {
+            uint32_t elapsed = SimIo::now() - start;
+            if (elapsed >= timeout_us) return elapsed;
+        }
+        return SimIo::now() - start;
+    }
+};
+
+static GlitchFilter<SimIo> s_filter;
+
+struct FilteredLines {
+    static uint32_t wait_for_state(bool state, uint32_t timeout_us) {
+        return s_filter.wait_for_state(state, timeout_us);
+    }
+    static uint32_t measure_pulse(bool state, uint32_t timeout_us) {
+        return s_filter.measure_pulse(state, timeout_us);
+    }
+};
+
+// ─── Receiver model (bus_loop attention/sync + receive_bit) ─────────────────
+
+template <typename L>
+static int receive_bit() {
+    if (L::wait_for_state(false, ADB_BIT_CELL_US * 2) == 0) return -1;
+    uint32_t low = L::measure_pulse(false, ADB_BIT_CELL_US + ADB_TIMING_TOLERANCE_US);
+    if (low == 0) return -1;
+    L::wait_for_state(true, ADB_BIT_CELL_US);
+    return low < ADB_BIT_THRESHOLD_US ? 1 : 0;
+}
+
+/// Decoded command byte, or -1.
+template <typename L>
+static int receive_command() {
+    if (L::wait_for_state(false, 10000) == 0) return -1;
+    uint32_t low_start = SimIo::now();
+    L::wait_for_state(true, ADB_RESET_MIN_US + 500);
+    uint32_t attn = SimIo::now() - low_start;
+    if (attn < ADB_ATTN_MIN_US || attn > ADB_ATTN_MAX_US) return -1;
+    if (L::wait_for_state(false, ADB_SYNC_NOMINAL_US + 30) == 0) return -1;
+
+    int byte = 0;
+    for (int b = 7; b >= 0; b--) {
+        int bit = receive_bit<L>();
+        if (bit < 0) return -1;
+        byte |= bit << b;
+    }
+    return byte;
+}
+
+// ─── Run ────────────────────────────────────────────────────────────────────
+
+int main(int argc, char** argv) {
+    uint32_t n = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 0) : 20000;
+    uint32_t seed = argc > 2 ? (uint32_t)strtoul(argv[2], nullptr, 0) : 1;
+
+    printf("glitch filter: width %luus, %lu samples; read %.2fus, clock %.2fus\n\n",
+           (unsigned long)ADB_GLITCH_US, (unsigned long)ADB_GLITCH_CONFIRM_SAMPLES,
+           READ_COST_US, NOW_COST_US);
+    printf("%-13s %8s %8s %9s | %9s\n", "profile", "noise/cmd", "plain", "filtered", "glitch/cmd");
+
+    for (const NoiseProfile& p : s_profiles) {
+        s_rng = seed ? seed : 1;
+        uint32_t ok_plain = 0, ok_filtered = 0;
+        uint64_t noise_spans = 0;
+        s_glitches = 0;
+
+        for (uint32_t i = 0; i < n; i++) {
+            uint8_t cmd = (uint8_t)rng();
+            uint32_t state = s_rng;
+
+            build_command(cmd, p);
+            noise_spans += s_noise.size();
+            if (receive_command<PlainLines>() == cmd) ok_plain++;
+
+            s_rng = state;                  // same waveform for the filter
+            build_command(cmd, p);
+            if (receive_command<FilteredLines>() == cmd) ok_filtered++;
+        }
+
+        printf("%-13s %8.1f %7.2f%% %8.2f%% | %9.2f\n",
+               p.name, (double)noise_spans / n,
+               100.0 * ok_plain / n, 100.0 * ok_filtered / n,
+               (double)s_glitches / n);
+    }
+    return 0;
+}
@@ -0,0 +1,190 @@
+// Host-side simulation of the poll predictor against jittered host cadences.
+//
+// Generates attention edges as a Mac polling in bursts would — one Talk,
+// or the keyboard then the mouse back-to-back — with a jittered period,
+// bursts the bus loop never decoded, and a host that changes its period
+// halfway. Feeds them to the firmware's PollCadence (include/poll_cadence.h)
+// exactly as the bus loop does: on_attention() at each attention edge,
+// on_transaction_end() after the reply, then the idle jobs (the keyboard
+// and mouse staging jobs at their declared costs) run one after another
+// while each still fits idle_budget_us(), as poll_predictor's job runner
+// does. Fails if a job is still running when the next attention falls, if
+// a budget is given between the two commands of a burst, or if the
+// estimate ends unlocked or off the host's period.
+//
+// Build:  g++ -std=c++11 -O2 -Iinclude -o adb_pred_sim tools/adb_pred_sim.cpp
+// Usage:  ./adb_pred_sim [bursts-per-profile] [seed]
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "config.h"
+#include "poll_cadence.h"
+
+// ─── Host profiles ──────────────────────────────────────────────────────────
+
+struct HostProfile {
+    const char* name;
+    uint32_t period_us;     // burst-start interval
+    uint32_t jitter_us;     // uniform ± on the interval
+    uint32_t burst;         // commands per burst
+    uint32_t missed_pct;    // bursts the bus loop never decoded
+    uint32_t period2_us;    // period from halfway on (0 = unchanged)
+};
+
+static const HostProfile s_profiles[] = {
+    { "pairs-11ms",    11000,  500, 2,  0,     0 },
+    { "single-11ms",   11000,  500, 1,  0,     0 },
+    { "slow-16.7ms",   16700, 1500, 2,  0,     0 },
+    { "missed-10%",    11000,  500, 2, 10,     0 },
+    { "period-change", 11000,  500, 2,  0, 16700 },
+};
+
+// One Talk transaction from the attention edge: attention, command, stop,
+// Tlt and the 16-bit reply or the Tlt timeout; then the host turnaround
+// before a back-to-back poll
+static constexpr uint32_t TALK_DATA_US    = 3700;
+static constexpr uint32_t TALK_NO_DATA_US = 2000;
+static constexpr uint32_t POLL_GAP_US     = 300;
+
+struct Job {
+    const char* name;
+    uint32_t    cost_us;    // declared worst case; a run takes 50–100% of it
+};
+
+static const Job s_jobs[] = {
+    { "kbd_stage",   ADB_JOB_STAGE_KBD_US },
+    { "mouse_stage", ADB_JOB_STAGE_MOUSE_US },
+};
+static constexpr uint32_t NUM_JOBS = sizeof(s_jobs) / sizeof(s_jobs[0]);
+
+// ─── Deterministic PRNG (xorshift32) ────────────────────────────────────────
+
+static uint32_t s_rng = 1;
+
+static uint32_t rng() {
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+static uint32_t jitter(uint32_t nominal, uint32_t j) {
+    if (!j) return nominal;
+    return nominal - j + rng() % (2 * j + 1);
+}
+
+// ─── Run ────────────────────────────────────────────────────────────────────
+
+struct Result {
+    uint32_t bursts_seen;
+    uint32_t lock_burst;        // burst that locked the estimate (0 = never)
+    bool     locked_at_end;
+    uint32_t period_us;         // final estimate
+    uint32_t err_max_us;        // worst |prediction error| once locked
+    uint32_t early;             // bursts more than the guard ahead of prediction
+    uint32_t gaps, job_runs;
+    uint32_t mid_burst_budget;  // budget given with the burst's next command still to come
+    uint32_t collisions;        // job still running at the next attention edge
+};
+
+static Result run(const HostProfile& p, uint32_t bursts) {
+    PollCadence cadence;
+    Result r = {};
+
+    uint32_t burst_start = 1000;
+    uint32_t job_busy_until = 0;    // end of the last job run
+    bool     job_pending = false;   // ran after the previous transaction
+
+    for (uint32_t b = 0; b < bursts; b++) {
+        uint32_t period = (p.period2_us && b >= bursts / 2) ? p.period2_us : p.period_us;
+        if (b) burst_start += jitter(period, p.jitter_us);
+        bool missed = p.missed_pct && rng() % 100 < p.missed_pct;
+
+        uint32_t t = burst_start;
+        for (uint32_t cmd = 0; cmd < p.burst; cmd++) {
+            // The host doesn't wait for our jobs: its edge is when it is
+            if (job_pending && (int32_t)(job_busy_until - t) > 0) r.collisions++;
+            job_pending = false;
+
+            uint32_t talk = (rng() & 1) ? TALK_DATA_US : TALK_NO_DATA_US;
+            uint32_t end = t + talk;
+            if (!missed) {
+                PollCadence::Attention a = cadence.on_attention(t);
+                if (a.new_burst) {
+                    r.bursts_seen++;
+                    if (!r.lock_burst && cadence.locked()) r.lock_burst = r.bursts_seen;
+                    if (a.scored) {
+                        uint32_t err = a.err_us < 0 ? -a.err_us : a.err_us;
+                        if (err > r.err_max_us) r.err_max_us = err;
+                        if (a.err_us < -(int32_t)ADB_JOB_GUARD_US) r.early++;
+                    }
+                }
+                cadence.on_transaction_end(end);
+            }
+
+            // Bus loop after the transaction: poll_predictor::run_idle_jobs()
+            uint32_t now = end;
+            uint32_t budget = cadence.idle_budget_us(now);
+            bool more_in_burst = cmd + 1 < p.burst;
+            if (budget && more_in_burst) r.mid_burst_budget++;
+            if (cadence.locked() && !more_in_burst && !missed) r.gaps++;
+            if (budget) {
+                uint32_t deadline = now + budget;
+                uint32_t ran = 0;
+                for (uint32_t j = 0; j < NUM_JOBS; j++) {
+                    if ((int32_t)(deadline - now) < (int32_t)s_jobs[j].cost_us) continue;
+                    uint32_t cost = s_jobs[j].cost_us;
+                    now += cost / 2 + rng() % (cost / 2 + 1);
+                    ran++;
+                }
+                if (ran) {
+                    r.job_runs += ran;
+                    job_busy_until = now;
+                    job_pending = true;
+                }
+            }
+
+            t = end + jitter(POLL_GAP_US, 100);
+        }
+    }
+
+    r.locked_at_end = cadence.locked();
+    r.period_us = cadence.period_us();
+    return r;
+}
+
+int main(int argc, char** argv) {
+    uint32_t bursts = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 0) : 2000;
+    uint32_t seed   = argc > 2 ? (uint32_t)strtoul(argv[2], nullptr, 0) : 1;
+    s_rng = seed ? seed : 1;
+    if (bursts < 2) bursts = 2;
+
+    printf("%lu bursts per profile, burst gap %luus, guard %luus, lock after %lu\n\n",
+           (unsigned long)bursts, (unsigned long)ADB_BURST_GAP_US,
+           (unsigned long)ADB_JOB_GUARD_US, (unsigned long)ADB_PRED_LOCK_SAMPLES);
+    printf("%-14s %6s %5s %8s %8s %6s %5s %6s %8s %5s %7s\n",
+           "profile", "bursts", "lock", "period", "host", "errmax", "early",
+           "gaps", "jobs/gap", "mid", "collide");
+
+    bool all_ok = true;
+    for (const HostProfile& p : s_profiles) {
+        Result r = run(p, bursts);
+        uint32_t host = p.period2_us ? p.period2_us : p.period_us;
+        uint32_t off = r.period_us > host ? r.period_us - host : host - r.period_us;
+        bool ok = r.locked_at_end && !r.collisions && !r.mid_burst_budget &&
+                  (uint64_t)off * 100 <= (uint64_t)host * ADB_PRED_TOLERANCE_PCT;
+        all_ok = all_ok && ok;
+        printf("%-14s %6lu %5lu %8lu %8lu %6lu %5lu %6lu %8.2f %5lu %7lu %s\n",
+               p.name, (unsigned long)r.bursts_seen, (unsigned long)r.lock_burst,
+               (unsigned long)r.period_us, (unsigned long)host,
+               (unsigned long)r.err_max_us, (unsigned long)r.early,
+               (unsigned long)r.gaps, r.gaps ? (double)r.job_runs / r.gaps : 0.0,
+               (unsigned long)r.mid_burst_budget, (unsigned long)r.collisions,
+               ok ? "ok" : "FAIL");
+    }
+    printf("\n%s\n", all_ok ? "PASS: locked on every cadence, no job in the way of a poll"
+                            : "FAIL: unlocked, off period, mid-burst budget or collision");
+    return all_ok ? 0 : 1;
+}
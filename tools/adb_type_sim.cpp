@@ -0,0 +1,367 @@
+// Host-side simulation of text injection from the console to the Mac.
+//
+// Runs text through the firmware's TextEncoder (include/text_encoder.h)
+// and models the rest of the path the way the firmware runs it: a 'paste'
+// arriving at SERIAL_BAUD into a CONSOLE_RX_BUFFER UART buffer, the
+// console draining it every CONSOLE_PASTE_POLL_MS into the TYPE_BUF_SIZE
+// text ring and pacing the sender with the firmware's XonXoff
+// (include/flow_control.h, the sender reacting SENDER_XOFF_LAG bytes
+// late), the type task waking every TYPE_POLL_MS (late by a random
+// scheduling delay) to
+// keep TYPE_QUEUE_DEPTH events in flight (queued or buffered), the keyboard
+// moving queued events into its ADB_KEY_BUF_SIZE buffer only while there
+// is room, and the host polling — each Talk R0 reply carrying up to two
+// events, back-to-back polls while the keyboard has data, and SRQ pulling
+// the keyboard in when the host is polling the mouse. The host side turns
+// the received events back into characters, tracking Shift, and checks
+// them against the text: anything lost, added or reordered fails the run.
+// Prints the achieved rate per host profile.
+//
+// Build:  g++ -std=c++11 -O2 -Iinclude -o adb_type_sim tools/adb_type_sim.cpp
+// Usage:  ./adb_type_sim [text-file] [seed]
+//         (no file: a generated mix of config lines, BASIC and stray UTF-8,
+//         several times TYPE_BUF_SIZE so flow control has to hold it back)
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <string>
+
+#include "config.h"
+#include "flow_control.h"
+#include "text_encoder.h"
+
+// ─── Host profiles ──────────────────────────────────────────────────────────
+
+struct HostProfile {
+    const char* name;
+    uint32_t frame_us;      // host poll cycle (VBL-driven)
+    uint32_t jitter_us;     // uniform ± on the cycle
+    bool     mouse_active;  // host polls the mouse each cycle; keyboard only via SRQ
+    bool     back_to_back;  // host polls a device again at once while it has data
+    uint32_t task_late_us;  // type task wakes up to this late (Core 0 load)
+    uint32_t pace_ms;       // console 'pace'
+    uint32_t uptime_ms;     // millis() when the paste starts
+};
+
+static const HostProfile s_profiles[] = {
+    { "kbd-active",    11000,  500, false, true,     300,  0, 0 },
+    { "mouse-srq",     11000,  500, true,  true,     300,  0, 0 },
+    { "once-a-frame",  11000,  500, false, false,    300,  0, 0 },
+    { "slow-host",     16700, 1500, false, false,    300,  0, 0 },
+    { "busy-core0",    11000,  500, false, true,    8000,  0, 0 },
+    { "paced-30ms",    11000,  500, false, true,     300, 30, 0 },
+    // millis() crosses 2^31 (24.8 days of uptime) a second into the paste
+    { "uptime-2^31",   11000,  500, false, true,     300,  0, 0x7FFFFC00 },
+    { "paced-2^31",    11000,  500, false, true,     300, 30, 0x7FFFFC00 },
+};
+
+// A run still going after this much simulated time has stalled
+static constexpr uint32_t RUN_LIMIT_US = 3000u * 1000000u;
+
+// ADB transaction lengths (µs): attention, command, stop, then Tlt and the
+// 16-bit reply — or the Tlt timeout when the device has nothing to say
+static constexpr uint32_t TALK_DATA_US    = 3700;
+static constexpr uint32_t TALK_NO_DATA_US = 2000;
+static constexpr uint32_t POLL_GAP_US     = 300;    // host turnaround between polls
+
+// Serial link: one byte per 10 bit times, and bytes the sender (USB-serial
+// bridge FIFO, driver) still sends after XOFF arrives
+static constexpr uint32_t BYTE_NS          = 10u * 1000000000u / SERIAL_BAUD;
+static constexpr uint32_t SENDER_XOFF_LAG  = 256;
+
+// ─── Deterministic PRNG (xorshift32) ────────────────────────────────────────
+
+static uint32_t s_rng = 1;
+
+static uint32_t rng() {
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+static uint32_t jitter(uint32_t nominal, uint32_t j) {
+    if (!j) return nominal;
+    return nominal - j + rng() % (2 * j + 1);
+}
+
+// ─── Test text ──────────────────────────────────────────────────────────────
+
+static std::string generated_text() {
+    static const char* const LINES[] = {
+        "10 PRINT \"HELLO, WORLD!\"\r\n",
+        "20 FOR I=1 TO 100: X(I)=I*I: NEXT I\r\n",
+        "30 IF A$<>\"Y\" THEN GOTO 10 ELSE END\r\n",
+        "[Network]\nAddress = 192.168.1.20/24\nGateway=192.168.1.1\n",
+        "path: ~/Documents/{notes,todo}_v2.txt  # comment\n",
+        "\tindent with tab; a|b & c^d `cmd` @user 50% off!\n",
+        "caf\xC3\xA9 na\xC3\xAFve \xE2\x82\xAC" "5 \xF0\x9F\x98\x80 (unmapped)\n",
+        "AAAA bbbb CcCc DDdd eeEE -- __ ++ == :: ;; ?? //\n",
+    };
+    std::string text;
+    for (int i = 0; i < 160; i++) text += LINES[rng() % (sizeof(LINES) / sizeof(LINES[0]))];
+    return text;
+}
+
+/// What the Mac should end up with: every character the layout can type,
+/// line endings as '\n'.
+static std::string expected_text(const std::string& text) {
+    TextEncoder enc;
+    std::string out;
+    uint8_t ev[TextEncoder::MAX_EVENTS];
+    for (unsigned char c : text) {
+        // Reuse the encoder for UTF-8 and CRLF handling: a character was
+        // typed iff chars() moved
+        uint32_t before = enc.chars();
+        enc.feed(c, ev);
+        if (enc.chars() != before) out += (c == '\r') ? '\n' : (char)c;
+    }
+    return out;
+}
+
+// ─── Host-side decode ───────────────────────────────────────────────────────
+
+struct MacKeyboard {
+    char   chars[128][2];   // [keycode][shift] → character typed
+    bool   shift = false;
+    int    down  = -1;       // key currently held
+    std::string typed;
+    uint32_t protocol_errors = 0;   // release without press, two keys down
+
+    MacKeyboard() {
+        for (int k = 0; k < 128; k++) chars[k][0] = chars[k][1] = 0;
+        for (uint32_t cp = 0x08; cp < 0x7F; cp++) {
+            uint8_t keycode;
+            bool sh;
+            if (cp == '\r') continue;
+            if (TextEncoder::lookup(cp, keycode, sh)) chars[keycode][sh] = (char)cp;
+        }
+    }
+
+    void event(uint8_t e) {
+        uint8_t keycode = e & 0x7F;
+        bool released = (e & TextEncoder::RELEASE) != 0;
+        if (keycode == TextEncoder::KEY_SHIFT) {
+            if (shift == !released) protocol_errors++;
+            shift = !released;
+            return;
+        }
+        if (released) {
+            if (down != keycode) protocol_errors++;
+            down = -1;
+            return;
+        }
+        if (down >= 0) protocol_errors++;
+        down = keycode;
+        char c = chars[keycode][shift];
+        if (!c) protocol_errors++;
+        typed += c ? c : '?';
+    }
+};
+
+// ─── Run ────────────────────────────────────────────────────────────────────
+
+struct Result {
+    uint32_t chars;
+    uint32_t elapsed_us;
+    uint32_t replies, replies_full;
+    uint32_t queue_hwm, buf_hwm;
+    uint32_t ring_hwm, xoffs;
+    uint32_t lost, extra;
+    uint32_t rx_overflow, ring_dropped;
+    bool     in_order;
+    bool     shift_left_down;
+    uint32_t protocol_errors;
+};
+
+static Result run(const HostProfile& p, const std::string& text) {
+    std::deque<uint8_t> queue, buf;
+    TextEncoder enc;
+    MacKeyboard mac;
+    Result r = {};
+
+    // Serial path: sender → UART RX buffer → console → text ring
+    std::string sent_text = text + (char)TYPE_END;
+    size_t   pos = 0;               // next byte the sender puts on the wire
+    uint64_t next_byte_ns = 0;
+    bool     paused = false;        // sender saw XOFF
+    size_t   send_until = 0;        // after XOFF: bytes already in flight
+    std::deque<uint8_t> rx, ring;
+    XonXoff  flow(TYPE_XOFF_FREE, TYPE_XON_FREE);
+    uint32_t next_console = 0;
+    auto ring_space = [&]() { return (uint32_t)(TYPE_BUF_SIZE - ring.size()); };
+    auto flow_update = [&]() {
+        uint8_t ctl = flow.update(ring_space());
+        if (ctl == XonXoff::XOFF) {
+            r.xoffs++;
+            paused = true;
+            send_until = pos + SENDER_XOFF_LAG;
+        } else if (ctl == XonXoff::XON) {
+            paused = false;
+        }
+    };
+
+    uint8_t  staged[TextEncoder::MAX_EVENTS];
+    int      staged_count = 0, staged_next = 0;
+    bool     ended = false;
+    uint32_t resume_ms = p.uptime_ms;   // set when the run starts, as the task does
+
+    uint32_t now = 0;
+    uint32_t next_task = 0;
+    uint32_t next_frame = jitter(p.frame_us, p.jitter_us);
+    uint32_t next_poll = 0;
+    bool     in_burst = false;
+    uint32_t last_reply = 0;
+
+    auto has_data = [&]() { return !buf.empty() || !queue.empty(); };
+
+    while (true) {
+        // Sender: the wire runs at SERIAL_BAUD until XOFF takes effect
+        if ((uint64_t)now * 1000 > next_byte_ns + BYTE_NS) next_byte_ns = (uint64_t)now * 1000 - BYTE_NS;
+        while (pos < sent_text.size() && next_byte_ns + BYTE_NS <= (uint64_t)now * 1000 &&
+               (!paused || pos < send_until)) {
+            if (rx.size() < CONSOLE_RX_BUFFER) rx.push_back((uint8_t)sent_text[pos]);
+            else r.rx_overflow++;
+            pos++;
+            next_byte_ns += BYTE_NS;
+        }
+
+        // Console: serial_console::poll() in paste mode
+        if (now >= next_console) {
+            while (ring_space() > 1 && !rx.empty()) {
+                uint8_t byte = rx.front();
+                rx.pop_front();
+                // text_inject::write(): the last free byte only takes TYPE_END
+                if (byte != TYPE_END && ring_space() <= 1) r.ring_dropped++;
+                else ring.push_back(byte);
+                flow_update();
+            }
+            if (flow.stopped()) flow_update();
+            if (ring.size() > r.ring_hwm) r.ring_hwm = ring.size();
+            next_console = now + CONSOLE_PASTE_POLL_MS * 1000 + rng() % (p.task_late_us + 1);
+        }
+
+        // Type task: top the queue up, exactly as text_inject::task_loop
+        if (now >= next_task) {
+            uint32_t ms = p.uptime_ms + now / 1000;     // the task's millis()
+            while (queue.size() + buf.size() < TYPE_QUEUE_DEPTH) {
+                if (staged_next < staged_count) {
+                    if (queue.size() >= (size_t)KBD_QUEUE_SIZE) break;
+                    queue.push_back(staged[staged_next++]);
+                    continue;
+                }
+                if (ended || (int32_t)(ms - resume_ms) < 0) break;
+                if (ring.empty()) break;
+                uint8_t byte = ring.front();
+                ring.pop_front();
+                staged_next = 0;
+                if (byte == TYPE_END) {
+                    staged_count = enc.finish(staged);
+                    ended = true;
+                } else {
+                    staged_count = enc.feed(byte, staged);
+                    if (staged_count && p.pace_ms) resume_ms = ms + p.pace_ms;
+                }
+            }
+            if (queue.size() > r.queue_hwm) r.queue_hwm = queue.size();
+            next_task = now + TYPE_POLL_MS * 1000 + rng() % (p.task_late_us + 1);
+        }
+
+        // Host: one poll cycle per frame; keep polling while the keyboard
+        // has data. With the mouse active, the keyboard gets in via SRQ.
+        if (!in_burst && now >= next_frame) {
+            next_frame += jitter(p.frame_us, p.jitter_us);
+            in_burst = true;
+            next_poll = now;
+            if (p.mouse_active) next_poll += TALK_NO_DATA_US + POLL_GAP_US;   // mouse, SRQ seen
+        }
+        if (in_burst && now >= next_poll) {
+            // Talk R0 to the keyboard: process_queue() then up to two events
+            while (buf.size() < (size_t)ADB_KEY_BUF_SIZE && !queue.empty()) {
+                buf.push_back(queue.front());
+                queue.pop_front();
+            }
+            if (buf.size() > r.buf_hwm) r.buf_hwm = buf.size();
+            if (buf.empty()) {
+                in_burst = false;
+            } else {
+                int n = 0;
+                while (n < 2 && !buf.empty()) {
+                    mac.event(buf.front());
+                    buf.pop_front();
+                    n++;
+                }
+                r.replies++;
+                if (n == 2) r.replies_full++;
+                last_reply = now + TALK_DATA_US;
+                next_poll = now + TALK_DATA_US + POLL_GAP_US;
+                if (!p.back_to_back) in_burst = false;
+            }
+        }
+
+        bool drained = staged_next >= staged_count && !has_data();
+        if (ended && drained) break;
+        // TYPE_END lost on the way in: nothing left that could end the run
+        if (!ended && drained && pos == sent_text.size() && rx.empty() && ring.empty()) break;
+        if (now >= RUN_LIMIT_US) break;
+        now += 50;
+    }
+
+    std::string want = expected_text(text);
+    r.chars = enc.chars();
+    r.elapsed_us = last_reply;
+    r.in_order = (mac.typed == want);
+    r.lost  = want.size() > mac.typed.size() ? want.size() - mac.typed.size() : 0;
+    r.extra = mac.typed.size() > want.size() ? mac.typed.size() - want.size() : 0;
+    r.shift_left_down = mac.shift;
+    r.protocol_errors = mac.protocol_errors;
+    return r;
+}
+
+int main(int argc, char** argv) {
+    std::string text;
+    if (argc > 1 && argv[1][0] && argv[1][0] != '-') {
+        FILE* f = fopen(argv[1], "rb");
+        if (!f) {
+            fprintf(stderr, "cannot open %s\n", argv[1]);
+            return 2;
+        }
+        int c;
+        while ((c = fgetc(f)) != EOF) text += (char)c;
+        fclose(f);
+    }
+    uint32_t seed = argc > 2 ? (uint32_t)strtoul(argv[2], nullptr, 0) : 1;
+    s_rng = seed ? seed : 1;
+    if (text.empty()) text = generated_text();
+
+    printf("%zu bytes of text at %d baud, ring %lu, UART buffer %lu, "
+           "queue depth %lu, key buffer %d\n\n",
+           text.size(), SERIAL_BAUD, (unsigned long)TYPE_BUF_SIZE,
+           (unsigned long)CONSOLE_RX_BUFFER, (unsigned long)TYPE_QUEUE_DEPTH,
+           ADB_KEY_BUF_SIZE);
+    printf("%-12s %6s %8s %6s %6s %5s %4s %5s %4s %4s %4s %4s %5s %5s\n",
+           "profile", "chars", "time_s", "cps", "2/rep", "q_hwm", "buf",
+           "ring", "xoff", "ovf", "lost", "xtra", "order", "proto");
+
+    bool all_ok = true;
+    for (const HostProfile& p : s_profiles) {
+        Result r = run(p, text);
+        bool ok = r.in_order && !r.shift_left_down && !r.protocol_errors &&
+                  !r.rx_overflow && !r.ring_dropped;
+        all_ok = all_ok && ok;
+        printf("%-12s %6lu %8.2f %6.1f %5.1f%% %5lu %4lu %5lu %4lu %4lu %4lu %4lu %5s %5lu\n",
+               p.name, (unsigned long)r.chars, r.elapsed_us / 1e6,
+               r.elapsed_us ? r.chars * 1e6 / r.elapsed_us : 0.0,
+               r.replies ? 100.0 * r.replies_full / r.replies : 0.0,
+               (unsigned long)r.queue_hwm, (unsigned long)r.buf_hwm,
+               (unsigned long)r.ring_hwm, (unsigned long)r.xoffs,
+               (unsigned long)(r.rx_overflow + r.ring_dropped),
+               (unsigned long)r.lost, (unsigned long)r.extra,
+               r.in_order ? "ok" : "FAIL", (unsigned long)r.protocol_errors);
+    }
+    printf("\n%s\n", all_ok ? "PASS: every character arrived once, in order"
+                            : "FAIL: characters lost, added or reordered");
+    return all_ok ? 0 : 1;
+}
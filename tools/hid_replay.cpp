@@ -0,0 +1,351 @@
+// Linux-side sender for serial HID injection (firmware built with
+// ADB_HID_INJECT=1).
+//
+// Replays a recorded trace of HID reports to the bridge, framed as in
+// include/hid_inject.h, either at the trace's own timing (scaled by
+// --speed) or at a fixed frame rate (--rate). Without a trace it
+// generates a load: key taps cycling through a–z, or a mouse drawing a
+// circle, at the rate given. Everything the bridge prints (status lines,
+// [INJECT] counters, latency histograms) is passed through to stdout, so
+// a run and its measurement read as one log.
+//
+// Trace format, one report per line ('#' starts a comment):
+//   <t_us> K <hex bytes>     keyboard report (8-byte boot report)
+//   <t_us> M <hex bytes>     mouse report (3-byte boot or 5–7-byte report)
+//   <t_us> k                 release all keys
+//   <t_us> m                 release all mouse buttons
+// t_us is microseconds from the start of the trace, e.g.
+//   0      K 02 00 04 00 00 00 00 00
+//   80000  K 00 00 00 00 00 00 00 00
+//   100000 M 00 05 FB
+//
+// Build:  g++ -std=c++11 -O2 -Iinclude -o hid_replay tools/hid_replay.cpp
+// Usage:  ./hid_replay <tty> [options] [trace-file]
+//           --baud N      serial baud (default HID_INJECT_BAUD)
+//           --speed X     play the trace X times as fast (default 1)
+//           --rate N      ignore trace timing: N frames per second
+//           --loop N      play the trace N times (0 = forever)
+//           --keys N      no trace: N key taps per second
+//           --mouse N     no trace: N mouse reports per second
+//           --count N     generated reports to send (default 1000)
+//           --tail S      keep printing bridge output S seconds after (default 6)
+
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "hid_inject.h"
+
+// ─── Reports ────────────────────────────────────────────────────────────────
+
+struct Report {
+    uint64_t t_us;
+    uint8_t  kind;
+    std::vector<uint8_t> data;
+};
+
+static bool load_trace(const char* path, std::vector<Report>& out) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "cannot open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    char line[512];
+    int lineno = 0;
+    while (fgets(line, sizeof(line), f)) {
+        lineno++;
+        char* hash = strchr(line, '#');
+        if (hash) *hash = 0;
+
+        char* p = line;
+        char* end;
+        unsigned long long t = strtoull(p, &end, 10);
+        if (end == p) continue;     // blank or comment line
+        p = end;
+        while (*p == ' ' || *p == '\t') p++;
+
+        Report r;
+        r.t_us = t;
+        switch (*p) {
+            case 'K': r.kind = HID_FRAME_KEYBOARD;    break;
+            case 'M': r.kind = HID_FRAME_MOUSE;       break;
+            case 'k': r.kind = HID_FRAME_RESET_KBD;   break;
+            case 'm': r.kind = HID_FRAME_RESET_MOUSE; break;
+            default:
+                fprintf(stderr, "%s:%d: expected K, M, k or m\n", path, lineno);
+                fclose(f);
+                return false;
+        }
+        p++;
+        while (true) {
+            unsigned long b = strtoul(p, &end, 16);
+            if (end == p) break;
+            r.data.push_back((uint8_t)b);
+            p = end;
+        }
+        if (r.data.size() > HID_FRAME_MAX_PAYLOAD) {
+            fprintf(stderr, "%s:%d: report longer than %zu bytes\n",
+                    path, lineno, HID_FRAME_MAX_PAYLOAD);
+            fclose(f);
+            return false;
+        }
+        out.push_back(r);
+    }
+    fclose(f);
+    return true;
+}
+
+/// Key taps through a–z (HID usages 0x04–0x1D): press, then release
+/// half a period later.
+static void gen_keys(uint32_t rate, uint32_t count, std::vector<Report>& out) {
+    uint64_t period = 1000000 / rate;
+    for (uint32_t i = 0; i < count; i++) {
+        Report press = { i * period, HID_FRAME_KEYBOARD, std::vector<uint8_t>(8, 0) };
+        press.data[2] = 0x04 + i % 26;
+        Report release = { i * period + period / 2, HID_FRAME_KEYBOARD, std::vector<uint8_t>(8, 0) };
+        out.push_back(press);
+        out.push_back(release);
+    }
+}
+
+/// A circle of boot-protocol mouse reports, one turn per second, so the
+/// pointer ends where it started.
+static void gen_mouse(uint32_t rate, uint32_t count, std::vector<Report>& out) {
+    uint64_t period = 1000000 / rate;
+    double radius = 200.0;
+    int x = (int)radius, y = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        double a = 2 * M_PI * (double)((i + 1) % rate) / rate;
+        int nx = (int)lround(radius * cos(a));
+        int ny = (int)lround(radius * sin(a));
+        int dx = nx - x, dy = ny - y;
+        // Split moves the report can't hold
+        while (dx || dy) {
+            int sx = dx > 127 ? 127 : dx < -127 ? -127 : dx;
+            int sy = dy > 127 ? 127 : dy < -127 ? -127 : dy;
+            Report r = { i * period, HID_FRAME_MOUSE, { 0, (uint8_t)(int8_t)sx, (uint8_t)(int8_t)sy } };
+            out.push_back(r);
+            dx -= sx;
+            dy -= sy;
+        }
+        x = nx;
+        y = ny;
+    }
+}
+
+// ─── Serial port ────────────────────────────────────────────────────────────
+
+static speed_t baud_constant(long baud) {
+    switch (baud) {
+        case 115200:  return B115200;
+        case 230400:  return B230400;
+        case 460800:  return B460800;
+        case 921600:  return B921600;
+        case 1000000: return B1000000;
+        case 2000000: return B2000000;
+        default:      return 0;
+    }
+}
+
+static int open_port(const char* path, long baud) {
+    speed_t speed = baud_constant(baud);
+    if (!speed) {
+        fprintf(stderr, "unsupported baud %ld\n", baud);
+        return -1;
+    }
+    int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0) {
+        fprintf(stderr, "cannot open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    termios tio;
+    if (tcgetattr(fd, &tio) != 0) {
+        fprintf(stderr, "%s is not a tty\n", path);
+        close(fd);
+        return -1;
+    }
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~CRTSCTS;
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    tcsetattr(fd, TCSANOW, &tio);
+    tcflush(fd, TCIOFLUSH);
+    return fd;
+}
+
+/// Copy whatever the bridge has printed to stdout.
+static void pass_through(int fd) {
+    char buf[512];
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof(buf))) > 0) fwrite(buf, 1, n, stdout);
+    fflush(stdout);
+}
+
+static bool write_all(int fd, const uint8_t* data, size_t length) {
+    while (length) {
+        ssize_t n = write(fd, data, length);
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EINTR) return false;
+            pass_through(fd);
+            usleep(100);
+            continue;
+        }
+        data += n;
+        length -= n;
+    }
+    return true;
+}
+
+// ─── Timing ─────────────────────────────────────────────────────────────────
+
+static uint64_t now_us() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/// Sleep until `t_us`, printing bridge output meanwhile. The last stretch
+/// is spun so frames leave on time rather than a scheduler tick late.
+static void wait_until(int fd, uint64_t t_us) {
+    while (true) {
+        uint64_t now = now_us();
+        if (now >= t_us) return;
+        uint64_t left = t_us - now;
+        if (left > 2000) {
+            pass_through(fd);
+            uint64_t nap = left - 1000;
+            if (nap > 20000) nap = 20000;
+            timespec ts = { 0, (long)(nap * 1000) };
+            nanosleep(&ts, nullptr);
+        }
+    }
+}
+
+// ─── Main ───────────────────────────────────────────────────────────────────
+
+static void usage() {
+    fprintf(stderr,
+            "usage: hid_replay <tty> [--baud N] [--speed X] [--rate N] [--loop N]\n"
+            "                  [--keys N | --mouse N] [--count N] [--tail S] [trace-file]\n");
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        usage();
+        return 2;
+    }
+    const char* tty   = argv[1];
+    const char* trace = nullptr;
+    long     baud  = HID_INJECT_BAUD;
+    double   speed = 1.0;
+    uint32_t rate  = 0, loops = 1, keys = 0, mouse = 0, count = 1000, tail_s = 6;
+
+    for (int i = 2; i < argc; i++) {
+        std::string a = argv[i];
+        bool has_value = i + 1 < argc;
+        if      (a == "--baud"  && has_value) baud   = strtol(argv[++i], nullptr, 0);
+        else if (a == "--speed" && has_value) speed  = strtod(argv[++i], nullptr);
+        else if (a == "--rate"  && has_value) rate   = strtoul(argv[++i], nullptr, 0);
+        else if (a == "--loop"  && has_value) loops  = strtoul(argv[++i], nullptr, 0);
+        else if (a == "--keys"  && has_value) keys   = strtoul(argv[++i], nullptr, 0);
+        else if (a == "--mouse" && has_value) mouse  = strtoul(argv[++i], nullptr, 0);
+        else if (a == "--count" && has_value) count  = strtoul(argv[++i], nullptr, 0);
+        else if (a == "--tail"  && has_value) tail_s = strtoul(argv[++i], nullptr, 0);
+        else if (a[0] != '-' && !trace)       trace  = argv[i];
+        else {
+            usage();
+            return 2;
+        }
+    }
+    if (speed <= 0 || (!trace && !keys && !mouse) || (trace && (keys || mouse))) {
+        usage();
+        return 2;
+    }
+
+    std::vector<Report> reports;
+    if (trace) {
+        if (!load_trace(trace, reports)) return 2;
+    } else if (keys) {
+        gen_keys(keys, count, reports);
+    } else {
+        gen_mouse(mouse, count, reports);
+    }
+    if (reports.empty()) {
+        fprintf(stderr, "nothing to send\n");
+        return 2;
+    }
+
+    int fd = open_port(tty, baud);
+    if (fd < 0) return 1;
+
+    // What the link can carry: 10 bits per byte on the wire
+    size_t bytes = 0;
+    for (const Report& r : reports) bytes += HID_FRAME_OVERHEAD + r.data.size();
+    double link_fps = baud / 10.0 / ((double)bytes / reports.size());
+    if (rate > link_fps) {
+        fprintf(stderr, "warning: %lu frames/s exceeds the link's ~%.0f frames/s at %ld baud\n",
+                (unsigned long)rate, link_fps, baud);
+    }
+
+    printf("[REPLAY] %zu reports, %s, %ld baud\n", reports.size(),
+           rate ? "fixed rate" : "trace timing", baud);
+    fflush(stdout);
+
+    uint8_t  frame[HID_FRAME_OVERHEAD + HID_FRAME_MAX_PAYLOAD];
+    uint8_t  seq = 0;
+    uint64_t sent = 0;
+    uint64_t max_late_us = 0;
+    uint64_t start = now_us();
+    uint64_t pass_start = start;
+
+    for (uint32_t pass = 0; loops == 0 || pass < loops; pass++) {
+        for (size_t i = 0; i < reports.size(); i++) {
+            const Report& r = reports[i];
+            uint64_t due = rate ? start + sent * 1000000 / rate
+                                : pass_start + (uint64_t)(r.t_us / speed);
+            wait_until(fd, due);
+            uint64_t late = now_us() - due;
+            if (late > max_late_us) max_late_us = late;
+
+            size_t n = hid_frame_encode(seq++, r.kind, r.data.data(), r.data.size(), frame);
+            if (!write_all(fd, frame, n)) {
+                fprintf(stderr, "write failed: %s\n", strerror(errno));
+                close(fd);
+                return 1;
+            }
+            sent++;
+        }
+        // The next pass starts one trace-length later
+        uint64_t length = (uint64_t)(reports.back().t_us / speed);
+        pass_start += length ? length : 1;
+        pass_through(fd);
+    }
+
+    // Wait for the port to drain so the rate counts the wire
+    tcdrain(fd);
+    double elapsed = (now_us() - start) / 1e6;
+    printf("[REPLAY] %llu frames in %.3fs — %.1f frames/s (max late %llu µs)\n",
+           (unsigned long long)sent, elapsed, elapsed > 0 ? sent / elapsed : 0.0,
+           (unsigned long long)max_late_us);
+    fflush(stdout);
+
+    // Catch the next status report, which carries the bridge's count
+    uint64_t tail_end = now_us() + (uint64_t)tail_s * 1000000;
+    while (now_us() < tail_end) {
+        pass_through(fd);
+        usleep(20000);
+    }
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,101 @@
+// Host-side decoder for the bridge's binary deferred log (ADB_LOG_BINARY=1).
+//
+// Reads a raw serial capture from a file or stdin, expands each binary
+// frame back into text using the firmware's own token table, and passes
+// any bytes outside frames (plain Serial output) through unchanged.
+//
+// Build:  g++ -std=c++11 -O2 -Iinclude -o log_decode tools/log_decode.cpp
+// Usage:  ./log_decode capture.bin
+//         cat /dev/ttyUSB0 | ./log_decode
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "log_tokens.h"
+
+static const char* const s_formats[] = {
+#define LOG_TOKEN_FORMAT(id, fmt) fmt,
+    LOG_TOKEN_LIST(LOG_TOKEN_FORMAT)
+#undef LOG_TOKEN_FORMAT
+};
+static const size_t TOKEN_COUNT = sizeof(s_formats) / sizeof(s_formats[0]);
+static const size_t MAX_ARGS = 4;
+
+static uint32_t le32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/// Try to decode a frame at buf[0]. Returns bytes consumed, 0 if the bytes
+/// are not a valid frame, or -1 if more input is needed.
+static long decode_frame(const uint8_t* buf, size_t len) {
+    if (len < 2) return -1;
+    if (buf[0] != LOG_FRAME_SYNC0 || buf[1] != LOG_FRAME_SYNC1) return 0;
+    if (len < 10) return -1;
+
+    uint16_t token = buf[2] | (buf[3] << 8);
+    uint8_t core   = buf[4];
+    uint8_t nargs  = buf[5];
+    if (nargs > MAX_ARGS || core > 1) return 0;
+
+    size_t frame_len = 10 + 4 * nargs + 1;
+    if (len < frame_len) return -1;
+
+    uint8_t x = 0;
+    for (size_t i = 2; i < frame_len - 1; i++) x ^= buf[i];
+    if (x != buf[frame_len - 1]) return 0;
+
+    uint32_t ts = le32(buf + 6);
+    unsigned long a[MAX_ARGS] = {0, 0, 0, 0};
+    for (uint8_t i = 0; i < nargs; i++) a[i] = le32(buf + 10 + 4 * i);
+
+    printf("%10.6f c%u ", ts / 1e6, core);
+    if (token < TOKEN_COUNT) {
+        printf(s_formats[token], a[0], a[1], a[2], a[3]);
+    } else {
+        printf("[LOG] unknown token %u", token);
+    }
+    printf("\n");
+    return (long)frame_len;
+}
+
+int main(int argc, char** argv) {
+    FILE* in = stdin;
+    if (argc > 1) {
+        in = fopen(argv[1], "rb");
+        if (!in) {
+            perror(argv[1]);
+            return 1;
+        }
+    }
+
+    std::vector<uint8_t> buf;
+    uint8_t chunk[4096];
+    size_t n;
+    bool eof = false;
+
+    while (!eof) {
+        n = fread(chunk, 1, sizeof(chunk), in);
+        if (n == 0) eof = true;
+        buf.insert(buf.end(), chunk, chunk + n);
+
+        size_t pos = 0;
+        while (pos < buf.size()) {
+            long used = decode_frame(&buf[pos], buf.size() - pos);
+            if (used > 0) {
+                pos += used;
+            } else if (used < 0 && !eof) {
+                break;  // partial frame — wait for more input
+            } else {
+                putchar(buf[pos]);  // plain text byte
+                pos++;
+            }
+        }
+        buf.erase(buf.begin(), buf.begin() + pos);
+        fflush(stdout);
+    }
+
+    if (in != stdin) fclose(in);
+    return 0;
+}